@@ -22,3 +22,38 @@ find_program(
 )
 
 message(STATUS "Found glslc: '${GLSLC_EXECUTABLE}'")
+
+######################################################################
+#                Find Runtime Shader Compiler Library                #
+######################################################################
+
+option(IVULK_RUNTIME_SHADERS "Enable runtime shader variant compilation with shaderc." ON)
+
+if(IVULK_RUNTIME_SHADERS)
+    find_library(
+        SHADERC_LIBRARY
+        NAMES shaderc_combined
+        PATHS ${Vulkan_ROOT_DIR}
+        PATH_SUFFIXES lib Lib
+    )
+    find_path(
+        SHADERC_INCLUDE_DIR
+        NAMES shaderc/shaderc.hpp
+        PATHS ${Vulkan_ROOT_DIR}
+        PATH_SUFFIXES include Include
+    )
+
+    if(SHADERC_LIBRARY AND SHADERC_INCLUDE_DIR)
+        message(STATUS "Found shaderc: '${SHADERC_LIBRARY}'")
+    else()
+        message(WARNING "shaderc not found, runtime shader compilation is disabled.")
+        set(IVULK_RUNTIME_SHADERS OFF)
+    endif()
+endif()
+
+# The SDK ships the shader compilers, so its version goes into the shader variant cache key
+if(Vulkan_VERSION)
+    set(IVULK_SHADER_COMPILER_VERSION "${Vulkan_VERSION}")
+else()
+    get_filename_component(IVULK_SHADER_COMPILER_VERSION ${Vulkan_ROOT_DIR} NAME)
+endif()
@@ -5,6 +5,7 @@
 #include <ivulk/core/graphics_pipeline.hpp>
 #include <ivulk/core/image.hpp>
 #include <ivulk/core/sampler.hpp>
+#include <ivulk/core/sampler_cache.hpp>
 #include <ivulk/core/texture.hpp>
 #include <ivulk/core/uniform_buffer.hpp>
 #include <ivulk/core/vertex.hpp>
@@ -144,7 +145,6 @@ protected:
     {
         if (!swapchainOnly)
         {
-            sampler           = Sampler::create(state.vk.device, {});
             crateBaseColorTex = Image::create(state.vk.device,
                                               {
                                                   .load {
@@ -152,6 +152,7 @@ protected:
                                                       .path    = "textures/Crate/Crate_basecolor.png",
                                                   },
                                               });
+            sampler           = SamplerCache::get({}, crateBaseColorTex);
         }
         ubo = UniformBufferObject::create(state.vk.device, {.size = sizeof(UboData)});
 
@@ -1,13 +1,19 @@
 #include <ivulk/glm.hpp>
 
 #include <ivulk/core/app.hpp>
+#include <ivulk/core/bindless.hpp>
 #include <ivulk/core/buffer.hpp>
+#include <ivulk/core/descriptor_set.hpp>
 #include <ivulk/core/graphics_pipeline.hpp>
 #include <ivulk/core/image.hpp>
 #include <ivulk/core/sampler.hpp>
+#include <ivulk/core/sampler_cache.hpp>
+#include <ivulk/core/shader_variant_compiler.hpp>
 #include <ivulk/core/texture.hpp>
 #include <ivulk/core/uniform_buffer.hpp>
 #include <ivulk/core/vertex.hpp>
+#include <ivulk/render/ibl.hpp>
+#include <ivulk/render/gpu_culler.hpp>
 #include <ivulk/render/renderer.hpp>
 #include <ivulk/render/transform.hpp>
 
@@ -15,12 +21,15 @@
 #include <ivulk/render/renderable_instance.hpp>
 #include <ivulk/render/scene.hpp>
 #include <ivulk/render/standard_shader.hpp>
+#include <ivulk/utils/commands.hpp>
 
+#include <array>
 #include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 
 using namespace ivulk;
@@ -39,47 +48,31 @@ public:
 protected:
     void loadTextures()
     {
-        dirtyMetal.albedo    = Image::create(state.vk.device,
-                                          {
-
-                                              .load = {
-                                                  .bEnable = true,
-                                                  .path    = "textures/DirtyMetal/albedo.png",
-                                                  .bSrgb   = true,
-                                              }});
-        dirtyMetal.metallic  = Image::create(state.vk.device,
-                                            {
-
-                                                .load = {
+        // Mips for all material maps are generated in a single batch
+        auto textures = Image::createBatch(state.vk.device,
+                                           {
+                                               {.load = {
                                                     .bEnable = true,
-                                                    .path    = "textures/DirtyMetal/half/metallic.png",
+                                                    .path    = "textures/DirtyMetal/albedo.png",
+                                                    .bSrgb   = true,
+                                                }},
+                                               {.load = {
+                                                    .bEnable = true,
+                                                    .path    = "textures/DirtyMetal/normal.png",
                                                     .bSrgb   = false,
-                                                }});
-        dirtyMetal.roughness = Image::create(state.vk.device,
-                                             {
-
-                                                 .load = {
-                                                     .bEnable = true,
-                                                     .path    = "textures/DirtyMetal/half/roughness.png",
-                                                     .bSrgb   = false,
-                                                 }});
-        dirtyMetal.normal    = Image::create(state.vk.device,
-                                          {
-
-                                              .load = {
-                                                  .bEnable = true,
-                                                  .path    = "textures/DirtyMetal/normal.png",
-                                                  .bSrgb   = false,
-                                              }});
-        hdri                 = Image::create(state.vk.device,
-                             {
-
-                                 .load = {
-                                     .bEnable  = true,
-                                     .path     = "textures/gamrig_2k.hdr",
-                                     .bGenMips = true,
-                                     .bHDR     = true,
-                                 }});
+                                                }},
+                                               {.pack = {
+                                                    .bEnable = true,
+                                                    .r       = {.path = "textures/DirtyMetal/half/ambientocclusion.png"},
+                                                    .g       = {.path = "textures/DirtyMetal/half/roughness.png"},
+                                                    .b       = {.path = "textures/DirtyMetal/half/metallic.png"},
+                                                    .a       = {.path = "textures/DirtyMetal/half/height.png"},
+                                                }},
+                                           });
+        dirtyMetal.albedo    = textures[0];
+        dirtyMetal.normal    = textures[1];
+        dirtyMetal.orm       = textures[2];
+        environment          = IBLEnvironment::create(state.vk.device, {.hdriPath = "textures/gamrig_2k.hdr"});
     }
 
     void createOffscreen()
@@ -94,7 +87,7 @@ protected:
             },
         });
         offscreen.depth = Image::create(state.vk.device, {
-            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             .format = VK_FORMAT_D32_SFLOAT,
             .extent = {
                 .width = state.vk.swapChain.extent.width,
@@ -104,7 +97,7 @@ protected:
             .aspect = VK_IMAGE_ASPECT_DEPTH_BIT,
         });
     }
-    void createHDRIPipeline()
+    GraphicsPipelineInfo getHDRIPipelineInfo()
     {
         GraphicsPipelineInfo createInfo {
 			.vertex = StaticMeshVertex::getPipelineInfo(),
@@ -112,7 +105,7 @@ protected:
             .bCullFront = true,
 			.shaderPath = {
 				.vert = "shaders/hdriSkybox.vert.spv",
-				.frag = "shaders/hdriSkybox.frag.spv",
+				.frag = "shaders/cubeSkybox.frag.spv",
 			},
 			.descriptor = {
 				.uboBindings = {
@@ -123,25 +116,17 @@ protected:
 				},
                 .textureBindings = {
                     {
-                        .image = hdri,
-                        .sampler = sampler,
+                        .image = environment->getEnvironment(),
+                        .sampler = iblSampler,
                         .binding = 4u,
                     },
                 },
 			},
 		};
-        auto& pipeline = hdriPipeline;
-        if (pipeline)
-        {
-            pipeline->recreate(createInfo);
-        }
-        else
-        {
-            pipeline = GraphicsPipeline::create(state.vk.device, createInfo);
-        }
+        return createInfo;
     }
 
-    void createBlitPipeline()
+    GraphicsPipelineInfo getBlitPipelineInfo()
     {
         GraphicsPipelineInfo createInfo {
             .bDepthEnable = false,
@@ -160,17 +145,84 @@ protected:
                 },
 			},
 		};
-        auto& pipeline = blitPipeline;
-        if (pipeline)
+        return createInfo;
+    }
+    void createFrameSet()
+    {
+        if (frameSet)
         {
-            pipeline->recreate(createInfo);
+            // Only the UBOs are recreated along with the swapchain
+            frameSet->update({
+                {.ubo = uboMatrices, .binding = 0u},
+                {.ubo = uboScene, .binding = 1u},
+            });
+            return;
         }
-        else
+        frameSet = DescriptorSet::create(state.vk.device, {
+			.frequency = E_DescriptorFrequency::Frame,
+			.uboBindings = {
+				{
+					.ubo     = uboMatrices,
+					.binding = 0u,
+				},
+				{
+					.ubo     = uboScene,
+					.binding = 1u,
+				},
+			},
+			.textureBindings = {
+				{
+					.image = environment->getIrradiance(),
+					.sampler = iblSampler,
+					.binding = 7u,
+				},
+				{
+					.image = environment->getPrefiltered(),
+					.sampler = iblSampler,
+					.binding = 8u,
+				},
+				{
+					.image = environment->getBrdfLut(),
+					.sampler = iblSampler,
+					.binding = 9u,
+				},
+			},
+		});
+    }
+    void createDirtyMetalMaterial()
+    {
+        if (auto table = BindlessTextureTable::current())
         {
-            pipeline = GraphicsPipeline::create(state.vk.device, createInfo);
+            dirtyMetal.material = BindlessMaterial {
+                .albedo  = table->addTexture(dirtyMetal.albedo),
+                .normal  = table->addTexture(dirtyMetal.normal),
+                .packed  = table->addTexture(dirtyMetal.orm),
+                .sampler = table->addSampler(sampler),
+            };
+            return;
         }
+        dirtyMetal.materialSet = DescriptorSet::create(state.vk.device, {
+			.frequency = E_DescriptorFrequency::Material,
+			.textureBindings = {
+				{
+					.image = dirtyMetal.albedo,
+					.sampler = sampler,
+					.binding = 0u,
+				},
+				{
+					.image = dirtyMetal.normal,
+					.sampler = sampler,
+					.binding = 1u,
+				},
+				{
+					.image = dirtyMetal.orm,
+					.sampler = sampler,
+					.binding = 2u,
+				},
+			},
+		});
     }
-    void createDirtyMetalPipeline()
+    GraphicsPipelineInfo getDirtyMetalPipelineInfo()
     {
         GraphicsPipelineInfo createInfo {
 			.vertex = StaticMeshVertex::getPipelineInfo(),
@@ -178,66 +230,79 @@ protected:
 				.vert = "shaders/sphere.vert.spv",
 				.frag = "shaders/sphere.frag.spv",
 			},
-			.descriptor = {
-				.uboBindings = {
-					{
-						.ubo     = uboMatrices,
-						.binding = 0u,
-					},
-					{
-						.ubo     = uboScene,
-						.binding = 1u,
-					},
-				},
-                .textureBindings = {
-                    {
-                        .image = dirtyMetal.albedo,
-                        .sampler = sampler,
-                        .binding = 4,
-                    },
-                    {
-                        .image = dirtyMetal.normal,
-                        .sampler = sampler,
-                        .binding = 5u,
-                    },
-                    {
-                        .image = dirtyMetal.metallic,
-                        .sampler = sampler,
-                        .binding = 6u,
-                    },
-                    {
-                        .image = dirtyMetal.roughness,
-                        .sampler = sampler,
-                        .binding = 7u,
-                    },
-                },
+			.sets = {
+				.frame    = frameSet,
+				.material = dirtyMetal.materialSet,
+			},
+			// Matches the lights set up in update()
+			.specialization = {
+				{E_SpecConstant::PointLightCount, 2u},
+				{E_SpecConstant::DirLightCount, 1u},
 			},
 		};
-        auto& pipeline = dirtyMetal.pipeline;
-        if (pipeline)
+        if (dirtyMetal.material.has_value())
         {
-            pipeline->recreate(createInfo);
+            // Material textures come from the bindless table instead
+            createInfo.bBindless       = true;
+            createInfo.shaderPath.frag = "shaders/sphere_bindless.frag.spv";
         }
-        else
+        return createInfo;
+    }
+    void createPipelines()
+    {
+        // The generic variant evaluates every light and material feature, so it can stand in for the
+        // specialized pipeline while that one compiles
+        auto genericInfo = getDirtyMetalPipelineInfo();
+        genericInfo.specialization.clear();
+
+        std::vector<GraphicsPipelineInfo> infos = {
+            getHDRIPipelineInfo(),
+            genericInfo,
+            getBlitPipelineInfo(),
+        };
+        std::array<GraphicsPipeline::Ptr*, 3> pipelines = {
+            &hdriPipeline, &dirtyMetal.genericPipeline, &blitPipeline};
+        if (hdriPipeline)
         {
-            pipeline = GraphicsPipeline::create(state.vk.device, createInfo);
+            for (std::size_t i = 0; i < infos.size(); ++i)
+                (*pipelines[i])->recreate(infos[i]);
+            dirtyMetal.pipeline->recreate(getDirtyMetalPipelineInfo());
+            return;
         }
+
+        // The pipelines don't depend on each other, so compile them in parallel
+        auto futures = GraphicsPipeline::createBatch(state.vk.device, infos);
+        for (std::size_t i = 0; i < futures.size(); ++i)
+            *pipelines[i] = futures[i].get();
+
+        dirtyMetal.pipeline = GraphicsPipeline::createAsync(
+            state.vk.device, getDirtyMetalPipelineInfo(), dirtyMetal.genericPipeline);
     }
     void initialize(bool swapchainOnly) override
     {
         if (!swapchainOnly)
         {
+            ShaderVariantCompiler::addSourceDir(EX_MODEL_LIT_ASSETS_SOURCE_DIR);
             loadTextures();
-            sampler  = Sampler::create(state.vk.device, {});
+            sampler    = SamplerCache::get({}, dirtyMetal.albedo);
+            iblSampler = SamplerCache::get({
+                .addressMode = {
+                    .u = E_SamplerAddressMode::ClampEdge,
+                    .v = E_SamplerAddressMode::ClampEdge,
+                    .w = E_SamplerAddressMode::ClampEdge,
+                },
+                .mips = {.maxLod = E_SamplerLod::Unclamped},
+            });
+            createDirtyMetalMaterial();
             renderer = Renderer::create<Renderer>(this);
+            culler   = GpuCuller::create(state.vk.device, {});
         }
         uboMatrices = UniformBufferObject::create(state.vk.device, {.size = sizeof(MatricesUBO)});
         uboScene    = UniformBufferObject::create(state.vk.device, {.size = sizeof(SceneUBOData)});
 
         createOffscreen();
-        createHDRIPipeline();
-        createDirtyMetalPipeline();
-        createBlitPipeline();
+        createFrameSet();
+        createPipelines();
 
         state.vk.pipelines.mainGfx = blitPipeline;
         // Skip anything that doesn't depend on the swapchain, if requested
@@ -256,7 +321,10 @@ protected:
         hdriCube                                           = scene->addRenderable(RenderableInstance::create(
             cubeModel, _priority = E_RenderPriority::Background, _pipelines = hdriPipelines));
         sphere1                                            = scene->addRenderable(RenderableInstance::create(
-            sphereModel, _priority = E_RenderPriority::Normal, _pipelines = spherePipelines));
+            sphereModel,
+            _priority  = E_RenderPriority::Normal,
+            _pipelines = spherePipelines,
+            _material  = dirtyMetal.material));
     }
 
     void escapeKeyQuit(Event evt)
@@ -270,16 +338,24 @@ protected:
     }
     void cleanupHDRI()
     {
-        hdri.reset();
+        environment.reset();
         hdriPipeline.reset();
     }
     void cleanupDirtyMetal()
     {
+        if (auto table = BindlessTextureTable::current(); table && dirtyMetal.material.has_value())
+        {
+            table->removeTexture(dirtyMetal.material->albedo);
+            table->removeTexture(dirtyMetal.material->normal);
+            table->removeTexture(dirtyMetal.material->packed);
+        }
+        dirtyMetal.material.reset();
+        dirtyMetal.materialSet.reset();
         dirtyMetal.albedo.reset();
-        dirtyMetal.metallic.reset();
         dirtyMetal.normal.reset();
-        dirtyMetal.roughness.reset();
+        dirtyMetal.orm.reset();
         dirtyMetal.pipeline.reset();
+        dirtyMetal.genericPipeline.reset();
     }
     void cleanupOffscreen()
     {
@@ -299,7 +375,10 @@ protected:
         cubeModel.reset();
         uboMatrices.reset();
         uboScene.reset();
+        frameSet.reset();
         sampler.reset();
+        iblSampler.reset();
+        culler.reset();
         renderer.reset();
 
         cleanupDirtyMetal();
@@ -310,6 +389,11 @@ protected:
 
     void preRender() override
     {
+        // Culling runs outside the offscreen pass, against the depth of the last frame
+        VkCommandBuffer cullCb = utils::beginOneTimeCommands();
+        scene->cull(cullCb, *culler);
+        utils::endOneTimeCommands(cullCb);
+
         renderer->beginOffscreenPass({
             .renderContext = hdriPipeline,
             .attachments   = {offscreen.color, offscreen.depth},
@@ -323,6 +407,7 @@ protected:
             scene->render(cb);
         }
         renderer->endOffscreenPass();
+        culler->setDepth(offscreen.depth, matrices.proj * matrices.view);
 
         offscreen.color->changeLayout(vk::PipelineStageFlagBits::eColorAttachmentOutput,
                                       vk::PipelineStageFlagBits::eFragmentShader,
@@ -362,6 +447,7 @@ protected:
 
         auto deltaEuler = glm::vec3(0, 0, deltaSeconds);
         _sphere1->transform.rotation *= glm::quat(deltaEuler);
+        scene->updateRenderable(_sphere1);
 
         // ================= Matrices ================== //
 
@@ -377,6 +463,7 @@ protected:
         matrices.proj[1][1] *= -1.0f;
 
         uboMatrices->setUniforms(matrices);
+        scene->setViewProjection(matrices.proj * matrices.view);
 
         // ================== Lights =================== //
 
@@ -392,6 +479,7 @@ protected:
         sceneData.pointLightCount            = 2;
 
         sceneData.viewPosition = viewPos.toVec();
+        scene->setViewPosition(sceneData.viewPosition);
 
         uboScene->setUniforms(sceneData);
     }
@@ -401,13 +489,15 @@ protected:
         return {
 			.appName = "Lit Sphere Demo",
 			.bDebugPrint = true,
+			.bShaderHotReload = true,
 			.window = {
 				.width = 800,
 				.height = 600,
 				.bResizable = true,
 			},
 			.vk = {
-				.bEnableValidation = true
+				.bEnableValidation = true,
+				.bBindless = true,
 			}
 		};
     }
@@ -437,10 +527,12 @@ protected:
     struct
     {
         Image::Ptr albedo;
-        Image::Ptr metallic;
         Image::Ptr normal;
-        Image::Ptr roughness;
+        Image::Ptr orm; ///< Packed occlusion, roughness, metallic and height
         GraphicsPipeline::Ptr pipeline;
+        GraphicsPipeline::Ptr genericPipeline;    ///< Unspecialized fallback for `pipeline`
+        std::optional<BindlessMaterial> material; ///< Set when bindless textures are enabled
+        DescriptorSet::Ptr materialSet;           ///< Set when bindless textures are disabled
     } dirtyMetal;
 
     struct
@@ -449,7 +541,9 @@ protected:
         Image::Ptr depth;
     } offscreen;
 
-    Image::Ptr hdri;
+    DescriptorSet::Ptr frameSet;
+
+    IBLEnvironment::Ptr environment;
     GraphicsPipeline::Ptr hdriPipeline;
 
     GraphicsPipeline::Ptr blitPipeline;
@@ -458,6 +552,7 @@ protected:
     StaticModel::Ptr cubeModel;
 
     Sampler::Ptr sampler;
+    Sampler::Ptr iblSampler;
 
     Scene::Ptr scene;
     RenderableInstance::Ref sphere1;
@@ -470,6 +565,7 @@ protected:
     SceneUBOData sceneData;
 
     Renderer::Ptr renderer;
+    GpuCuller::Ptr culler;
 
     glm::vec4 clearColor;
 
@@ -3,6 +3,7 @@
 #include <ivulk/core/graphics_pipeline.hpp>
 #include <ivulk/core/image.hpp>
 #include <ivulk/core/sampler.hpp>
+#include <ivulk/core/sampler_cache.hpp>
 #include <ivulk/core/texture.hpp>
 #include <ivulk/core/vertex.hpp>
 
@@ -93,7 +94,7 @@ protected:
         {
             tex = Image::create(state.vk.device, {.load = {.bEnable = true, .path = "textures/forest.png"}});
 
-            sampler = Sampler::create(state.vk.device, {});
+            sampler = SamplerCache::get({}, tex);
         }
 
         pipeline = GraphicsPipeline::create(state.vk.device, {
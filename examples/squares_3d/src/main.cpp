@@ -1,6 +1,7 @@
 #include <ivulk/core/app.hpp>
 #include <ivulk/core/buffer.hpp>
 #include <ivulk/core/graphics_pipeline.hpp>
+#include <ivulk/core/sampler_cache.hpp>
 #include <ivulk/core/texture.hpp>
 #include <ivulk/core/uniform_buffer.hpp>
 #include <ivulk/core/vertex.hpp>
@@ -115,7 +116,7 @@ protected:
         if (!swapchainOnly)
         {
             tex = Image::create(state.vk.device, {.load = {.bEnable = true, .path = "textures/forest.png"}});
-            sampler = Sampler::create(state.vk.device, {});
+            sampler = SamplerCache::get({}, tex);
         }
         ubo = UniformBufferObject::create(state.vk.device, {.size = sizeof(UboData)});
 
@@ -60,8 +60,11 @@ namespace ivulk {
 
         /**
          * @brief Get the current app state.
+         *
+         * The main thread writes the state every frame, so worker threads must only read the fields they
+         * need, never copy the whole state.
          */
-        [[nodiscard]] AppState getState() const;
+        [[nodiscard]] const AppState& getState() const;
 
         /**
          * @brief Helper method to check if debug printing was enabled in the init args.
@@ -75,6 +78,13 @@ namespace ivulk {
          */
         virtual boost::filesystem::path getAssetsDir() = 0;
 
+        /**
+         * @brief Get the path to the directory used to cache generated data between runs.
+         *
+         * Virtual. Defaults to a `cache` directory next to the assets directory.
+         */
+        virtual boost::filesystem::path getCacheDir();
+
         /**
 		 * @brief Schedule the app to quit at the end of this frame
 		 */
@@ -89,6 +99,9 @@ namespace ivulk {
             std::string appName           = "";
             utils::VersionData appVersion = {0, 1, 0};
             bool bDebugPrint              = false;
+            std::size_t workerThreads     = 0u; ///< Worker thread count, or 0 to pick from the hardware threads
+            /// Rebuild pipelines when shader sources change (see `ShaderHotReload`)
+            bool bShaderHotReload = false;
             struct
             {
                 int width        = -1;
@@ -101,6 +114,10 @@ namespace ivulk {
             {
                 bool bEnableValidation        = false;
                 std::size_t maxFramesInFlight = 2;
+                bool bBindless                = false; ///< Create a global bindless texture table if supported
+                uint32_t maxBindlessTextures  = 4096u; ///< Texture capacity of the bindless texture table
+                uint32_t maxBindlessSamplers  = 32u;   ///< Sampler capacity of the bindless texture table
+                std::string pipelineCachePath = "";    ///< File to load and save the pipeline cache, if not empty
             } vk;
         };
 
@@ -206,6 +223,7 @@ namespace ivulk {
         std::vector<const char*> getRequiredVkLayers();
 
         bool checkDeviceExtensions(vk::PhysicalDevice device);
+        bool checkBindlessSupport(vk::PhysicalDevice device);
 
         void pickVkPhysicalDevice();
         bool isDeviceSuitable(vk::PhysicalDevice device);
@@ -222,7 +240,10 @@ namespace ivulk {
 
         void createVkImageViews();
 
-        void createVkDescriptorPool();
+        void createVkPipelineCache();
+        void destroyVkPipelineCache();
+        void createDescriptorAllocator();
+        void createBindlessTable();
 
         VkDebugUtilsMessengerCreateInfoEXT makeVkDebugMessengerCreateInfo(bool includeVerbose = false);
         void createVkDebugMessenger();
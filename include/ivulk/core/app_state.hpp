@@ -9,15 +9,19 @@
 
 #include <ivulk/config.hpp>
 
+#include <ivulk/core/bindless.hpp>
 #include <ivulk/core/command_buffer.hpp>
+#include <ivulk/core/descriptor_allocator.hpp>
 #include <ivulk/core/framebuffer.hpp>
 #include <ivulk/core/graphics_pipeline.hpp>
 #include <ivulk/core/queue_families.hpp>
 #include <ivulk/core/vma.hpp>
+#include <ivulk/utils/thread_pool.hpp>
 
 #include <SDL2/SDL.h>
 #include <ivulk/vk.hpp>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -42,6 +46,14 @@ namespace ivulk {
             bool shouldQuit = false;
         } evt;
 
+        /**
+		 * @brief Background worker state
+		 */
+        struct
+        {
+            std::shared_ptr<utils::ThreadPool> pool; ///< Worker threads for pipeline compilation and other tasks
+        } workers;
+
         /**
 		 * @brief Vulkan application state
 		 */
@@ -76,6 +88,7 @@ namespace ivulk {
             {
                 std::weak_ptr<GraphicsPipeline>
                     mainGfx; ///< GraphicsPipeline that is used for rendering the final image to the swapchain
+                VkPipelineCache cache = VK_NULL_HANDLE; ///< Vulkan pipeline cache shared by all pipelines
             } pipelines;
 
             /**
@@ -83,9 +96,27 @@ namespace ivulk {
              */
             struct
             {
-                VkDescriptorPool pool; ///< Primary Vulkan descriptor pool
+                DescriptorAllocator::Ptr allocator; ///< Primary descriptor set allocator
             } descriptor;
 
+            /**
+             * @brief State for bindless texture access
+             */
+            struct
+            {
+                bool bEnabled = false; ///< Whether the device was created with descriptor indexing enabled
+                BindlessTextureTable::Ptr table; ///< The global bindless texture table, if enabled
+            } bindless;
+
+            /**
+             * @brief Optional device features, enabled if supported
+             */
+            struct
+            {
+                bool bMultiDrawIndirect         = false; ///< Indirect draws can issue several draws at once
+                bool bDrawIndirectFirstInstance = false; ///< Indirect draws can start past instance 0
+            } features;
+
             /**
              * @brief Handles and state for Vulkan queues
              */
@@ -116,6 +147,7 @@ namespace ivulk {
             struct
             {
                 VkCommandPool gfxPool;                   ///< Vulkan command pool for graphics operations
+                uint32_t gfxFamily = 0u;                 ///< Queue family of `gfxPool`, for more pools
                 std::vector<VkCommandBuffer> gfxBuffers; ///< Vulkan command buffers for graphics operations
                 std::shared_ptr<CommandBuffers> renderCmdBufs; /// < Vulkan command buffers for rendering
             } cmd;
@@ -0,0 +1,132 @@
+/**
+ * @file bindless.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `BindlessTextureTable` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/descriptor_set.hpp>
+#include <ivulk/core/image.hpp>
+#include <ivulk/core/sampler.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Information for initializing a BindlessTextureTable resource
+     */
+    struct BindlessTableInfo final
+    {
+        uint32_t maxTextures = 4096u; ///< Capacity of the sampled image array
+        uint32_t maxSamplers = 32u;   ///< Capacity of the sampler array
+    };
+
+    /**
+     * @brief A global, update-after-bind table of sampled images and samplers.
+     *
+     * The table owns a single descriptor set with a sampled image array at `TextureBinding` and a sampler
+     * array at `SamplerBinding`. Pipelines created with `GraphicsPipelineInfo::bBindless` bind it as set
+     * `SetIndex`, after the frame, pass and material sets, and materials reference its entries by index (see
+     * `BindlessMaterial`), so materials no longer need their own pipelines or descriptor sets.
+     *
+     * Entries can be added while command buffers that use the table are pending, but an entry must not be
+     * removed while a pending command buffer may still access it. The table holds a strong reference to each
+     * image and sampler it contains.
+     *
+     * Requires `VK_EXT_descriptor_indexing`. Enable with `App::InitArgs::vk.bBindless`, and use the
+     * `lib/bindless.glsl.jinja` shader library to access the table from shaders.
+     */
+    class BindlessTextureTable : public VulkanResource<BindlessTextureTable,
+                                                       BindlessTableInfo,
+                                                       VkDescriptorPool,
+                                                       VkDescriptorSetLayout,
+                                                       VkDescriptorSet>
+    {
+    public:
+        static constexpr uint32_t SetIndex       = E_DescriptorFrequency::Bindless; ///< Set index of the table
+        static constexpr uint32_t TextureBinding = 0u; ///< Binding of the sampled image array
+        static constexpr uint32_t SamplerBinding = 1u; ///< Binding of the sampler array
+
+        /**
+         * @brief Get the table for the current app, or an empty pointer if bindless textures aren't enabled.
+         */
+        static Ptr current();
+
+        /**
+         * @brief Get the Vulkan descriptor pool handle
+         */
+        VkDescriptorPool getDescriptorPool() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Get the Vulkan descriptor set layout handle
+         */
+        VkDescriptorSetLayout getDescriptorSetLayout() { return getHandleAt<1>(); }
+
+        /**
+         * @brief Get the Vulkan descriptor set handle
+         */
+        VkDescriptorSet getDescriptorSet() { return getHandleAt<2>(); }
+
+        /**
+         * @brief Add an image to the table, or find it if it was already added.
+         *
+         * The image is accessed through its default view in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL`.
+         *
+         * @return The index of the image in the sampled image array.
+         */
+        uint32_t addTexture(const Image::Ptr& image);
+
+        /**
+         * @brief Remove an image from the table, allowing its slot to be reused.
+         */
+        void removeTexture(uint32_t index);
+
+        /**
+         * @brief Add a sampler to the table, or find it if it was already added.
+         *
+         * @return The index of the sampler in the sampler array.
+         */
+        uint32_t addSampler(const Sampler::Ptr& sampler);
+
+        /**
+         * @brief Get the number of images currently in the table.
+         */
+        uint32_t getTextureCount() const { return m_textureCount; }
+
+        /**
+         * @brief Get the number of samplers currently in the table.
+         */
+        uint32_t getSamplerCount() const { return static_cast<uint32_t>(m_samplers.size()); }
+
+    private:
+        friend base_t;
+
+        BindlessTextureTable(VkDevice device,
+                             VkDescriptorPool pool,
+                             VkDescriptorSetLayout layout,
+                             VkDescriptorSet set,
+                             BindlessTableInfo info);
+
+        static BindlessTextureTable* createImpl(VkDevice device, BindlessTableInfo info);
+
+        void destroyImpl();
+
+        BindlessTableInfo m_info;
+
+        std::vector<Image::Ptr> m_textures;
+        std::vector<uint32_t> m_freeTextures;
+        std::unordered_map<VkImageView, uint32_t> m_textureIndices;
+        uint32_t m_textureCount = 0u;
+
+        std::vector<Sampler::Ptr> m_samplers;
+        std::unordered_map<VkSampler, uint32_t> m_samplerIndices;
+    };
+} // namespace ivulk
@@ -88,6 +88,15 @@ namespace ivulk {
          */
         void fillBuffer(const void* data, VkDeviceSize sz, std::optional<uint32_t> newCount = {});
 
+        /**
+         * @brief Read the contents of the buffer back to host memory.
+         *
+         * The buffer must have been created with a host-visible memory mode (e.g. `E_MemoryMode::GpuToCpu`).
+         * @param data Destination to copy the buffer contents into.
+         * @param sz The number of bytes to copy. Must be less than or equal to the size of the buffer.
+         */
+        void readBuffer(void* data, VkDeviceSize sz);
+
         /**
          * @brief Copy the contents of another buffer into this buffer.
          *
@@ -98,6 +107,19 @@ namespace ivulk {
          */
         void copyFromBuffer(Buffer::Ref srcBuf, VkDeviceSize size, bool copyCount = true);
 
+        /**
+         * @brief Copy a region of another buffer into this buffer. The count value is unchanged.
+         *
+         * @param srcBuf The buffer to copy from
+         * @param srcOffset The offset in `srcBuf` to start copying from, in bytes
+         * @param dstOffset The offset in this buffer to copy to, in bytes
+         * @param size The number of bytes to copy
+         */
+        void copyRegionFromBuffer(Buffer::Ref srcBuf,
+                                  VkDeviceSize srcOffset,
+                                  VkDeviceSize dstOffset,
+                                  VkDeviceSize size);
+
     private:
         friend base_t;
 
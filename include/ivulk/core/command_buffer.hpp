@@ -11,12 +11,15 @@
 
 #include <ivulk/core/vulkan_resource.hpp>
 
+#include <ivulk/core/descriptor_set.hpp>
 #include <ivulk/core/shader_stage.hpp>
 #include <ivulk/utils/keywords.hpp>
 #include <ivulk/utils/messages.hpp>
 
 #include <glm/glm.hpp>
 #include <ivulk/vk.hpp>
+#include <array>
+#include <bitset>
 #include <optional>
 #include <stdexcept>
 #include <vector>
@@ -35,8 +38,34 @@ namespace ivulk {
         uint32_t count = 1;      ///< The number of command buffers to allocate
     };
 
+    /**
+     * @brief Counters for the commands recorded by a `CommandBuffers` group, and the ones it skipped.
+     *
+     * A command is skipped when it would set state that is already bound in the command buffer.
+     */
+    struct CommandBufferStats final
+    {
+        uint64_t draws                     = 0u; ///< Direct draw commands recorded
+        uint64_t indirectDraws             = 0u; ///< Indirect draw commands recorded
+        uint64_t indirectDrawRecords       = 0u; ///< Draws issued by indirect draw commands
+        uint64_t pipelineBinds             = 0u; ///< Pipeline binds recorded
+        uint64_t pipelineBindsSkipped      = 0u; ///< Pipeline binds skipped
+        uint64_t descriptorSetBinds        = 0u; ///< Descriptor set binds recorded
+        uint64_t descriptorSetBindsSkipped = 0u; ///< Descriptor set binds skipped
+        uint64_t vertexBufferBinds         = 0u; ///< Vertex and instance buffer binds recorded
+        uint64_t vertexBufferBindsSkipped  = 0u; ///< Vertex and instance buffer binds skipped
+        uint64_t indexBufferBinds          = 0u; ///< Index buffer binds recorded
+        uint64_t indexBufferBindsSkipped   = 0u; ///< Index buffer binds skipped
+        uint64_t pushConstants             = 0u; ///< Push constant updates recorded
+        uint64_t pushConstantsSkipped      = 0u; ///< Push constant updates skipped
+    };
+
     /**
      * @brief A memory-managed resource for a group of Vulkan command buffers
+     *
+     * Tracks the state bound in the command buffer being recorded (pipeline, descriptor sets, vertex and
+     * index buffers, and push constant contents), and skips commands that wouldn't change it. The
+     * tracking is reset by `start`.
      */
     class CommandBuffers : public VulkanResource<CommandBuffers,
                                                  CommandBuffersCreateInfo,
@@ -73,19 +102,34 @@ namespace ivulk {
             std::size_t index; ///< The index of the command buffer to start recording to.
             vk::CommandBufferUsageFlags flags = vk::CommandBufferUsageFlagBits::
                 eSimultaneousUse; ///< The Vulkan command buffer usage flags.
+
+            /// For secondary command buffers, the render pass they are executed in. If set, the buffer
+            /// continues the render pass, otherwise it must be executed outside render passes.
+            vk::RenderPass renderPass   = {};
+            uint32_t subpass            = 0u; ///< The subpass of `renderPass` the buffer is executed in
+            vk::Framebuffer framebuffer = {}; ///< The framebuffer `renderPass` renders to, if known
         };
         /** 
          * @brief Set the current command buffer by index and start recording to it.
          *
          * @param callInfo The optional arguments structure.
          */
-        void start(const StartCallInfo&& callInfo) { startImpl(callInfo.index, callInfo.flags); }
+        void start(const StartCallInfo&& callInfo) { startImpl(callInfo); }
 
         /**
          * @brief Finish recording to the current command buffer
          */
         void finish();
 
+        /**
+         * @brief Execute secondary command buffers from the current command buffer, in order.
+         *
+         * The state they leave bound is unknown, so the next binds and push constants are never skipped.
+         *
+         * @param cmdBufs The secondary command buffers, finished recording
+         */
+        void executeCommands(const std::vector<vk::CommandBuffer>& cmdBufs);
+
         /**
          * @brief Optional arguments for the `draw` method.
          */
@@ -97,6 +141,14 @@ namespace ivulk {
             uint32_t instances     = 1u;        ///< The number of instances for instanced rendering
             uint32_t firstVertex   = 0u;        ///< The index of the first vertex to draw
             uint32_t firstInstance = 0u;        ///< The index of the first instance to draw
+            uint32_t indices       = 0u;        ///< Override the number of indices to draw
+            uint32_t firstIndex    = 0u;        ///< The index of the first index to draw
+            int32_t vertexOffset   = 0;         ///< The value added to each index
+
+            /// Per-instance vertex buffer, bound at `instanceBinding`. Instances are read starting at
+            /// `firstInstance`, so draws can share one buffer.
+            std::weak_ptr<Buffer> instanceBuffer = {};
+            uint32_t instanceBinding             = 1u; ///< The vertex binding of `instanceBuffer`
         };
 
         /** 
@@ -104,14 +156,35 @@ namespace ivulk {
          *
          * @param callInfo The optional arguments structure.
          */
-        void draw(const DrawCallInfo&& callInfo)
+        void draw(const DrawCallInfo&& callInfo) { drawImpl(callInfo); }
+
+        /**
+         * @brief Optional arguments for the `drawIndexedIndirect` method.
+         */
+        struct DrawIndexedIndirectCallInfo
+        {
+            std::weak_ptr<Buffer> vertexBuffer;   ///< The vertex buffer to use for drawing
+            std::weak_ptr<Buffer> indexBuffer;    ///< The index buffer to use for drawing
+            std::weak_ptr<Buffer> indirectBuffer; ///< Buffer of `VkDrawIndexedIndirectCommand` records
+            VkDeviceSize offset = 0u;             ///< Offset of the first record in `indirectBuffer`
+            uint32_t drawCount  = 1u;             ///< The number of records to draw
+
+            /// Per-instance vertex buffer, bound at `instanceBinding`
+            std::weak_ptr<Buffer> instanceBuffer = {};
+            uint32_t instanceBinding             = 1u; ///< The vertex binding of `instanceBuffer`
+        };
+
+        /**
+         * @brief Bind vertex/index buffers and draw from them with parameters read from a buffer.
+         *
+         * Without the `multiDrawIndirect` device feature (see `AppState`), the records are drawn with one
+         * command each.
+         *
+         * @param callInfo The optional arguments structure.
+         */
+        void drawIndexedIndirect(const DrawIndexedIndirectCallInfo&& callInfo)
         {
-            drawImpl(callInfo.vertexBuffer,
-                     callInfo.indexBuffer,
-                     callInfo.vertices,
-                     callInfo.instances,
-                     callInfo.firstVertex,
-                     callInfo.firstInstance);
+            drawIndexedIndirectImpl(callInfo);
         }
 
         /**
@@ -142,6 +215,26 @@ namespace ivulk {
          */
         void bindPipeline(std::weak_ptr<GraphicsPipeline> pipeline) { bindPipelineImpl(pipeline); }
 
+        /**
+         * @brief Bind a shared descriptor set in place of the pipelines' default set for its slot.
+         *
+         * Applies to the bound pipeline and any pipeline bound afterwards whose layout for the slot matches
+         * the set's layout, until `clearDescriptorOverride` is called. Used to switch materials without
+         * switching pipelines.
+         *
+         * @param set The set to bind. Its frequency determines the slot.
+         */
+        void overrideDescriptorSet(std::shared_ptr<DescriptorSet> set);
+
+        /**
+         * @brief Stop overriding a descriptor set slot.
+         *
+         * The pipelines' default set for the slot is bound again the next time a pipeline is bound.
+         *
+         * @param slot The set index (see `E_DescriptorFrequency`)
+         */
+        void clearDescriptorOverride(uint32_t slot);
+
         /**
          * @brief Optional arguments structure for `pushConstants` method.
          */
@@ -168,6 +261,16 @@ namespace ivulk {
             pushConstantsImpl(data, layout, callInfo.stageFlags, callInfo.offset, size);
         }
 
+        /**
+         * @brief Get the counters for commands recorded and skipped since creation or `resetStats`.
+         */
+        CommandBufferStats getStats() const { return m_stats; }
+
+        /**
+         * @brief Reset the command counters.
+         */
+        void resetStats() { m_stats = {}; }
+
     private:
         friend base_t;
 
@@ -186,21 +289,24 @@ namespace ivulk {
                     utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan command buffer(s)"));
             }
 
-            return new CommandBuffers(
+            auto* cmdBufs = new CommandBuffers(
                 device,
                 createInfo.cmdPool,
                 std::vector<vk::CommandBuffer>(commandBuffers.begin(), commandBuffers.end()));
+            cmdBufs->m_level = createInfo.level;
+            return cmdBufs;
         }
 
         void destroyImpl() { }
 
-        void startImpl(std::size_t index, vk::CommandBufferUsageFlags flags);
-        void drawImpl(std::weak_ptr<Buffer> vertexBuffer,
-                      std::weak_ptr<Buffer> indexBuffer,
-                      uint32_t vertices,
-                      uint32_t instances,
-                      uint32_t firstVertex,
-                      uint32_t firstInstance);
+        void startImpl(const StartCallInfo& callInfo);
+        void drawImpl(const DrawCallInfo& callInfo);
+        void drawIndexedIndirectImpl(const DrawIndexedIndirectCallInfo& callInfo);
+        void bindVertexBuffers(vk::CommandBuffer cmdBuf,
+                               const std::shared_ptr<Buffer>& vertexBuffer,
+                               const std::shared_ptr<Buffer>& indexBuffer,
+                               const std::shared_ptr<Buffer>& instanceBuffer,
+                               uint32_t instanceBinding);
         void clearAttachmentsImpl(std::weak_ptr<GraphicsPipeline> pipeline, glm::vec4 color);
 
         void bindPipelineImpl(std::weak_ptr<GraphicsPipeline> pipeline);
@@ -211,6 +317,38 @@ namespace ivulk {
                                VkDeviceSize offset,
                                VkDeviceSize size);
 
+        /// Size of the push constant contents tracked to skip redundant updates, in bytes
+        static constexpr std::size_t TrackedPushConstantSize = 256u;
+
+        /**
+         * @brief State bound in the current command buffer, used to skip redundant commands
+         */
+        struct BoundState
+        {
+            VkPipeline pipeline             = VK_NULL_HANDLE; ///< Bound pipeline
+            VkPipelineLayout pipelineLayout = VK_NULL_HANDLE; ///< Layout of the bound pipeline
+            VkBuffer vertexBuffer           = VK_NULL_HANDLE; ///< Vertex buffer bound to binding 0
+            VkBuffer indexBuffer            = VK_NULL_HANDLE; ///< Bound index buffer
+            VkBuffer instanceBuffer         = VK_NULL_HANDLE; ///< Bound instance buffer
+            uint32_t instanceBinding        = 0u;             ///< Binding of `instanceBuffer`
+
+            std::array<VkDescriptorSetLayout, E_DescriptorFrequency::Count> layouts = {}; ///< Layout of each slot
+            std::array<VkDescriptorSet, E_DescriptorFrequency::Count> sets          = {}; ///< Set in each slot
+            uint32_t pushConstantSize                                               = 0u;
+
+            VkShaderStageFlags pushStages                         = 0u; ///< Stages of the last update
+            std::array<uint8_t, TrackedPushConstantSize> pushData = {}; ///< Last pushed contents
+            std::bitset<TrackedPushConstantSize> pushValid        = {}; ///< Bytes of `pushData` set
+        };
+
+        void bindDescriptorSetsFor(const std::shared_ptr<GraphicsPipeline>& pipeline);
+
         std::optional<std::size_t> m_currentIdx = {};
+        vk::CommandBufferLevel m_level          = vk::CommandBufferLevel::ePrimary;
+
+        BoundState m_bound                         = {};
+        CommandBufferStats m_stats                 = {};
+        std::weak_ptr<GraphicsPipeline> m_pipeline = {};
+        std::array<std::shared_ptr<DescriptorSet>, E_DescriptorFrequency::Bindless> m_overrides = {};
     };
 } // namespace ivulk
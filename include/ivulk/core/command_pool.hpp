@@ -0,0 +1,54 @@
+/**
+ * @file command_pool.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `CommandPool` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/vulkan_resource.hpp>
+#include <ivulk/vk.hpp>
+
+#include <cstdint>
+
+namespace ivulk {
+    /**
+     * @brief Information for initializing a CommandPool resource
+     */
+    struct CommandPoolCreateInfo
+    {
+        uint32_t queueFamily             = 0u; ///< Queue family the command buffers are submitted to
+        vk::CommandPoolCreateFlags flags = {}; ///< Vulkan command pool creation flags
+    };
+
+    /**
+     * @brief A memory-managed resource for a Vulkan command pool
+     *
+     * Command pools and the command buffers allocated from them must only be used by one thread at a
+     * time, so threads recording in parallel each need their own pool.
+     */
+    class CommandPool : public VulkanResource<CommandPool, CommandPoolCreateInfo, vk::CommandPool>
+    {
+    public:
+        /**
+         * @brief Get the Vulkan command pool handle.
+         */
+        vk::CommandPool getCmdPool() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Reset every command buffer allocated from the pool, to record them again.
+         */
+        void reset();
+
+    private:
+        friend base_t;
+
+        CommandPool(VkDevice device, vk::CommandPool pool);
+
+        static CommandPool* createImpl(VkDevice device, CommandPoolCreateInfo createInfo);
+        void destroyImpl();
+    };
+} // namespace ivulk
@@ -0,0 +1,100 @@
+/**
+ * @file compute_pipeline.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `ComputePipeline` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/specialization.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief A single descriptor binding used by a compute pipeline.
+     */
+    struct ComputeDescriptorBinding final
+    {
+        uint32_t binding      = 0u;                              ///< The binding index in the shader
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; ///< The Vulkan descriptor type
+        uint32_t count        = 1u;                              ///< The number of descriptors in the binding
+    };
+
+    /**
+     * @brief Information for initializing a ComputePipeline resource
+     */
+    struct ComputePipelineInfo final
+    {
+        boost::filesystem::path shaderPath; ///< The path to load the SPIR-V compute shader from
+
+        /**
+         * @brief Pipeline descriptor bindings
+         */
+        struct descriptor
+        {
+            std::vector<ComputeDescriptorBinding> bindings = {}; ///< Descriptor bindings for the pipeline
+        } descriptor;
+
+        uint32_t pushConstantSize = 0u; ///< The size of the push constant block in bytes, or 0 for none
+
+        std::vector<SpecializationConstant> specialization = {}; ///< Specialization constants for the shader
+    };
+
+    /**
+     * @brief A memory-managed resource for a Vulkan compute pipeline
+     *
+     * Unlike GraphicsPipeline, descriptor sets are not owned by the pipeline, since compute work typically
+     * binds different resources per dispatch.
+     */
+    class ComputePipeline : public VulkanResource<ComputePipeline,
+                                                  ComputePipelineInfo,
+                                                  vk::Pipeline,
+                                                  vk::PipelineLayout,
+                                                  vk::DescriptorSetLayout>
+    {
+    public:
+        /**
+         * @brief Get the Vulkan pipeline handle
+         */
+        vk::Pipeline getPipeline() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Get the Vulkan pipeline layout handle
+         */
+        vk::PipelineLayout getPipelineLayout() { return getHandleAt<1>(); }
+
+        /**
+         * @brief Get the Vulkan descriptor set layout handle
+         */
+        vk::DescriptorSetLayout getDescriptorSetLayout() { return getHandleAt<2>(); }
+
+        /**
+         * @brief Get the number of workgroups required to cover `size` invocations.
+         *
+         * @param size The number of invocations along one dimension
+         * @param groupSize The local workgroup size along the same dimension
+         */
+        static uint32_t groupCount(uint32_t size, uint32_t groupSize) { return (size + groupSize - 1u) / groupSize; }
+
+    private:
+        friend base_t;
+
+        ComputePipeline(vk::Device device,
+                        vk::Pipeline pipeline,
+                        vk::PipelineLayout pipelineLayout,
+                        vk::DescriptorSetLayout descrSetLayout);
+
+        static ComputePipeline* createImpl(VkDevice device, ComputePipelineInfo info);
+
+        void destroyImpl();
+    };
+} // namespace ivulk
@@ -0,0 +1,187 @@
+/**
+ * @file descriptor_allocator.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `DescriptorAllocator` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Number of descriptors of a type to reserve per descriptor set in a pool.
+     */
+    struct DescriptorPoolRatio final
+    {
+        VkDescriptorType type; ///< The descriptor type
+        float ratio;           ///< Descriptors of `type` reserved per set
+    };
+
+    /**
+     * @brief Information for initializing a DescriptorAllocator resource
+     */
+    struct DescriptorAllocatorInfo final
+    {
+        uint32_t initialSets    = 64u;   ///< Set capacity of the first pool in each chain
+        uint32_t maxSetsPerPool = 4096u; ///< Pools double in size until they reach this many sets
+        uint32_t framesInFlight = 2u;    ///< Number of per-frame pool chains for transient sets
+
+        /**
+         * @brief Descriptors reserved per set in each pool
+         */
+        std::vector<DescriptorPoolRatio> ratios = {
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+        };
+    };
+
+    /**
+     * @brief Usage counters for a `DescriptorAllocator`.
+     */
+    struct DescriptorAllocatorStats final
+    {
+        uint32_t pools         = 0u; ///< Number of pools backing persistent sets
+        uint32_t framePools    = 0u; ///< Number of pools backing per-frame sets, across all frames
+        uint32_t poolCapacity  = 0u; ///< Total set capacity of the persistent pools
+        uint64_t setsAllocated = 0u; ///< Persistent sets allocated from pools
+        uint64_t setsRecycled  = 0u; ///< Persistent set requests served from the free lists
+        uint64_t setsFree      = 0u; ///< Persistent sets currently waiting in the free lists
+        uint64_t setsRetired   = 0u; ///< Persistent sets currently waiting for their frame slot to finish
+        uint64_t frameSets     = 0u; ///< Per-frame sets allocated since the allocator was created
+    };
+
+    /**
+     * @brief Growable descriptor set allocator.
+     *
+     * Sets are allocated from a chain of pools; when a pool runs out of space, a new pool twice the size
+     * of the last one is added to the chain, so the number of sets isn't capped by a constant. Pools are
+     * never rebuilt, including when the swapchain is recreated.
+     *
+     * Persistent sets are returned with `free()` and kept in a free list keyed by the layout's bindings
+     * (see `hashBindings()`). Sets can be reused with any layout that has identical bindings, so a pipeline
+     * that is recreated picks up the sets released by its previous version.
+     *
+     * Per-frame sets come from a separate chain of pools for each frame in flight, which is reset as a
+     * whole by `beginFrame()`. Use them for descriptors that are rewritten every frame.
+     *
+     * Layouts using immutable samplers or update-after-bind bindings aren't supported. All methods are
+     * thread-safe.
+     */
+    class DescriptorAllocator : public VulkanResource<DescriptorAllocator, DescriptorAllocatorInfo>
+    {
+    public:
+        /**
+         * @brief Get the allocator for the current app.
+         */
+        static Ptr current();
+
+        /**
+         * @brief Compute the free-list key for a set of layout bindings.
+         *
+         * Layouts with the same key are identically defined, so their sets are interchangeable.
+         */
+        static uint64_t hashBindings(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+        /**
+         * @brief Allocate persistent descriptor sets.
+         *
+         * @param layout The layout to allocate sets with
+         * @param key The free-list key of `layout`, from `hashBindings()`
+         * @param count The number of sets to allocate
+         */
+        std::vector<VkDescriptorSet> allocate(VkDescriptorSetLayout layout, uint64_t key, uint32_t count = 1u);
+
+        /**
+         * @brief Return persistent descriptor sets to the free list.
+         *
+         * The sets must no longer be in use by any pending command buffer.
+         *
+         * @param key The free-list key of the layout the sets were allocated with
+         * @param sets The sets to return
+         */
+        void free(uint64_t key, const std::vector<VkDescriptorSet>& sets);
+
+        /**
+         * @brief Return persistent descriptor sets to the free list once the current frame slot comes around
+         *        again.
+         *
+         * Use this instead of `free()` for sets that pending command buffers may still access, such as sets
+         * replaced by a descriptor update.
+         *
+         * @param key The free-list key of the layout the sets were allocated with
+         * @param sets The sets to return
+         */
+        void retire(uint64_t key, const std::vector<VkDescriptorSet>& sets);
+
+        /**
+         * @brief Allocate a descriptor set that is valid until the current frame slot comes around again.
+         */
+        VkDescriptorSet allocateFrame(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Reset the per-frame pools of a frame slot, and release the sets retired during its last use.
+         *
+         * Called by `App` once the frame's previous submission has finished executing.
+         */
+        void beginFrame(std::size_t frameIndex);
+
+        /**
+         * @brief Get usage counters for the allocator.
+         */
+        DescriptorAllocatorStats getStats()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_stats;
+        }
+
+    private:
+        friend base_t;
+
+        /**
+         * @brief A growable chain of descriptor pools
+         */
+        struct PoolChain
+        {
+            std::vector<VkDescriptorPool> pools; ///< Pools in the order they were created
+            std::size_t current = 0u;            ///< Index of the first pool that may have space left
+            uint32_t nextSets   = 0u;            ///< Set capacity of the next pool to create
+
+            std::vector<std::pair<uint64_t, VkDescriptorSet>> retired; ///< Sets waiting for the frame to finish
+        };
+
+        DescriptorAllocator(VkDevice device, DescriptorAllocatorInfo info);
+
+        static DescriptorAllocator* createImpl(VkDevice device, DescriptorAllocatorInfo info);
+
+        void destroyImpl();
+
+        VkDescriptorPool createPool(uint32_t sets);
+        VkDescriptorSet allocateFromChain(PoolChain& chain, VkDescriptorSetLayout layout, bool bPersistent);
+
+        DescriptorAllocatorInfo m_info;
+        DescriptorAllocatorStats m_stats;
+
+        PoolChain m_persistent;
+        std::vector<PoolChain> m_frames;
+        std::size_t m_currentFrame = 0u;
+
+        std::unordered_map<uint64_t, std::vector<VkDescriptorSet>> m_freeSets;
+
+        std::mutex m_mutex;
+    };
+} // namespace ivulk
@@ -0,0 +1,98 @@
+/**
+ * @file descriptor_layout_cache.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `DescriptorLayoutCache` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Usage counters for the `DescriptorLayoutCache`.
+     */
+    struct DescriptorLayoutCacheStats final
+    {
+        uint32_t requests  = 0u; ///< Total number of layouts requested
+        uint32_t hits      = 0u; ///< Requests served by an existing layout
+        uint32_t layouts   = 0u; ///< Number of unique layouts currently cached
+        uint32_t templates = 0u; ///< Number of descriptor update templates currently cached
+    };
+
+    /**
+     * @brief One descriptor's worth of data in the buffer read by a descriptor update template.
+     */
+    union DescriptorTemplateData
+    {
+        VkDescriptorImageInfo image;   ///< For sampler and image descriptors
+        VkDescriptorBufferInfo buffer; ///< For buffer descriptors
+        VkBufferView texelBuffer;      ///< For texel buffer descriptors
+    };
+
+    /**
+     * @brief A cached descriptor update template, and where it reads each binding from.
+     */
+    struct DescriptorUpdateTemplate final
+    {
+        VkDescriptorUpdateTemplate handle                  = VK_NULL_HANDLE; ///< The Vulkan template handle
+        std::unordered_map<uint32_t, uint32_t> dataIndices = {}; ///< Binding to index of its first data element
+        std::unordered_map<uint32_t, uint32_t> dataCounts  = {}; ///< Binding to its number of data elements
+        uint32_t dataCount                                 = 0u; ///< Number of data elements read by the template
+    };
+
+    /**
+     * @brief Static class that shares descriptor set layouts between identical sets of bindings.
+     *
+     * Pipelines and descriptor sets created from the same bindings get the same layout handle, so pipeline
+     * layouts built from them are compatible and sets stay bound when switching between pipelines. Layouts
+     * live until `clear()` is called, which `App` does during cleanup, so they must not be destroyed by
+     * their users.
+     *
+     * All methods are thread-safe.
+     */
+    class DescriptorLayoutCache final
+    {
+    public:
+        /**
+         * @brief Get a descriptor set layout for a set of bindings, creating it if needed.
+         *
+         * Binding order doesn't matter. Immutable samplers aren't supported.
+         */
+        static VkDescriptorSetLayout get(const std::vector<VkDescriptorSetLayoutBinding>& bindings);
+
+        /**
+         * @brief Get the update template for a cached layout, creating it if needed.
+         *
+         * The template writes every binding of the layout in one `vkUpdateDescriptorSetWithTemplate` call,
+         * reading `dataCount` tightly packed `DescriptorTemplateData` elements. Array bindings occupy one
+         * element per array element, starting at their entry in `dataIndices`, `dataCounts` long.
+         *
+         * @param layout A layout returned by `get()`
+         */
+        static const DescriptorUpdateTemplate& getUpdateTemplate(VkDescriptorSetLayout layout);
+
+        /**
+         * @brief Get usage counters for the cache.
+         */
+        static DescriptorLayoutCacheStats getStats();
+
+        /**
+         * @brief Destroy every cached layout and update template, and reset the counters.
+         */
+        static void clear();
+
+    private:
+        // Disable construction
+        DescriptorLayoutCache()                              = delete;
+        DescriptorLayoutCache(const DescriptorLayoutCache&)  = delete;
+        DescriptorLayoutCache(const DescriptorLayoutCache&&) = delete;
+        ~DescriptorLayoutCache()                             = delete;
+    };
+} // namespace ivulk
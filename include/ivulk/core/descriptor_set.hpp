@@ -0,0 +1,119 @@
+/**
+ * @file descriptor_set.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `DescriptorSet` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/descriptor_layout_cache.hpp>
+#include <ivulk/core/texture.hpp>
+#include <ivulk/core/uniform_buffer.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Descriptor set indices of the standard pipeline layout, ordered by update frequency.
+     */
+    namespace E_DescriptorFrequency {
+        constexpr uint32_t Frame    = 0u; ///< Per-frame globals, such as camera matrices and scene lighting
+        constexpr uint32_t Pass     = 1u; ///< Per-pass resources, such as the inputs of a post-process pass
+        constexpr uint32_t Material = 2u; ///< Per-material textures and parameters
+        constexpr uint32_t Bindless = 3u; ///< The global bindless texture table
+        constexpr uint32_t Count    = 4u; ///< Number of descriptor set slots
+    } // namespace E_DescriptorFrequency
+
+    /**
+     * @brief Information for initializing a DescriptorSet resource
+     */
+    struct DescriptorSetInfo final
+    {
+        uint32_t frequency = E_DescriptorFrequency::Material; ///< The slot the set is bound to
+
+        std::vector<PipelineUniformBufferBinding> uboBindings = {}; ///< Descriptor bindings for uniform buffers
+        std::vector<PipelineTextureBinding> textureBindings   = {}; ///< Descriptor bindings for textures
+    };
+
+    /**
+     * @brief A memory-managed descriptor set that can be shared between pipelines.
+     *
+     * The layout comes from the `DescriptorLayoutCache`, so every set created from the same bindings has the
+     * same layout, and pipelines using it have compatible pipeline layouts. Pass sets to
+     * `GraphicsPipelineInfo::sets` to build a pipeline with the standard multi-set layout, or to
+     * `RenderableInstance::create` to render an instance with a different material.
+     *
+     * Descriptors are written with the layout's cached update template. `update()` rebinds textures or
+     * uniform buffers in place, so swapping a material's texture doesn't require rebuilding any pipeline.
+     */
+    class DescriptorSet
+        : public VulkanResource<DescriptorSet, DescriptorSetInfo, VkDescriptorSetLayout, VkDescriptorSet>
+    {
+    public:
+        /**
+         * @brief Get the Vulkan descriptor set layout handle. Owned by the `DescriptorLayoutCache`.
+         */
+        VkDescriptorSetLayout getLayout() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Get the Vulkan descriptor set handle
+         */
+        VkDescriptorSet getDescriptorSet() { return getHandleAt<1>(); }
+
+        /**
+         * @brief Get the slot the set is bound to (see `E_DescriptorFrequency`)
+         */
+        uint32_t getFrequency() const { return m_frequency; }
+
+        /**
+         * @brief Rebind some of the set's uniform buffers or textures.
+         *
+         * Bindings that aren't listed keep their current resources. The descriptors are written to a
+         * freshly allocated set with a single template update, and the previous set is retired until
+         * pending command buffers are done with it, so this can be called at any point outside of command
+         * buffer recording. Command buffers pick up the new set the next time it is bound.
+         *
+         * @param ubos New resources for uniform buffer bindings of the set
+         * @param textures New resources for texture bindings of the set
+         */
+        void update(const std::vector<PipelineUniformBufferBinding>& ubos,
+                    const std::vector<PipelineTextureBinding>& textures = {});
+
+        /**
+         * @brief Write uniform buffer and texture bindings into a template data buffer.
+         *
+         * @param updateTemplate The update template the data is for
+         * @param data The data buffer, at least `updateTemplate.dataCount` elements long
+         * @param ubos Uniform buffer bindings to write
+         * @param textures Texture bindings to write
+         */
+        static void fillTemplateData(const DescriptorUpdateTemplate& updateTemplate,
+                                     std::vector<DescriptorTemplateData>& data,
+                                     const std::vector<PipelineUniformBufferBinding>& ubos,
+                                     const std::vector<PipelineTextureBinding>& textures);
+
+    private:
+        friend base_t;
+
+        DescriptorSet(VkDevice device,
+                      VkDescriptorSetLayout layout,
+                      VkDescriptorSet set,
+                      uint32_t frequency,
+                      uint64_t key,
+                      std::vector<DescriptorTemplateData> data);
+
+        static DescriptorSet* createImpl(VkDevice device, DescriptorSetInfo info);
+
+        void destroyImpl();
+
+        uint32_t m_frequency;
+        uint64_t m_key;
+        std::vector<DescriptorTemplateData> m_data;
+    };
+} // namespace ivulk
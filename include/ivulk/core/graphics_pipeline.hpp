@@ -11,18 +11,27 @@
 
 #include <ivulk/core/vulkan_resource.hpp>
 
+#include <ivulk/core/descriptor_set.hpp>
+#include <ivulk/core/specialization.hpp>
 #include <ivulk/core/texture.hpp>
 #include <ivulk/core/uniform_buffer.hpp>
 #include <ivulk/core/vertex.hpp>
 
+#include <array>
+#include <future>
 #include <optional>
+#include <set>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include <ivulk/vk.hpp>
 
 #include <boost/filesystem.hpp>
 
 namespace ivulk {
+    class BindlessTextureTable;
+    class DescriptorAllocator;
+
     /**
      * @brief Information for initializing a GraphicsPipeline resource
      */
@@ -30,11 +39,28 @@ namespace ivulk {
     {
         PipelineVertexInfo vertex; ///< The vertex format for the graphics pipeline
 
+        /**
+         * @brief Per-instance vertex format, if the pipeline is drawn instanced.
+         *
+         * Its binding should use `vk::VertexInputRate::eInstance` and a different binding number than
+         * `vertex`, e.g. `InstanceVertex::getPipelineInfo(InstanceBinding, vk::VertexInputRate::eInstance)`.
+         * `RenderQueue` batches draws of the same mesh with such pipelines into one instanced draw.
+         */
+        std::optional<PipelineVertexInfo> instance = {};
+
         bool bDepthEnable = true; ///< Enable depth testing (defalt true)
 
         bool bCullFront = false; ///< Display back faces instead of front faces
         bool bNoVertex = false;
 
+        /**
+         * @brief Bind the global bindless texture table as descriptor set `E_DescriptorFrequency::Bindless`,
+         *        and extend the push constant range with a `BindlessMaterial`.
+         *
+         * Requires `App::InitArgs::vk.bBindless` and device support for descriptor indexing.
+         */
+        bool bBindless = false;
+
         /**
          * @brief The paths to load SPIR-V shaders from
          */
@@ -57,6 +83,31 @@ namespace ivulk {
             std::vector<PipelineUniformBufferBinding> uboBindings = {}; ///< Descriptor bindings for uniform buffers
             std::vector<PipelineTextureBinding> textureBindings   = {}; ///< Descriptor bindings for textures
         } descriptor;
+
+        /**
+         * @brief Shared descriptor sets for the standard multi-set layout
+         *
+         * If any set is given, the pipeline layout has a set for each `E_DescriptorFrequency` slot, using the
+         * layouts of the given sets, and `descriptor` must be empty. The given sets are bound along with the
+         * pipeline, unless the command buffer already has them bound or overrides them (see
+         * `CommandBuffers::overrideDescriptorSet`). Pipelines built from sets with the same bindings share
+         * compatible layouts, so switching between them leaves lower-frequency sets bound.
+         */
+        struct sets
+        {
+            DescriptorSet::Ref frame    = {}; ///< Set 0: per-frame globals
+            DescriptorSet::Ref pass     = {}; ///< Set 1: per-pass resources
+            DescriptorSet::Ref material = {}; ///< Set 2: per-material resources
+        } sets;
+
+        /**
+         * @brief Specialization constants applied to every shader stage
+         *
+         * Stages ignore constants they don't declare. Use these instead of separate SPIR-V files for values
+         * that are fixed per pipeline, such as light counts or material features (see `E_SpecConstant`), so
+         * the driver can unroll loops and strip unused branches.
+         */
+        std::vector<SpecializationConstant> specialization = {};
     };
 
     /**
@@ -74,27 +125,29 @@ namespace ivulk {
         /**
          * @brief Get the Vulkan pipeline handle
          */
-        vk::Pipeline getPipeline() { return getHandleAt<0>(); }
+        vk::Pipeline getPipeline() { return active().getHandleAt<0>(); }
         
         /**
          * @brief Get the Vulkan render pass handle
          */
-        vk::RenderPass getRenderPass() { return getHandleAt<1>(); }
+        vk::RenderPass getRenderPass() { return active().getHandleAt<1>(); }
         
         /**
          * @brief Get the Vulkan pipeline layout handle
          */
-        vk::PipelineLayout getPipelineLayout() { return getHandleAt<2>(); }
+        vk::PipelineLayout getPipelineLayout() { return active().getHandleAt<2>(); }
         
         /**
-         * @brief Get the Vulkan descriptor set layout handle
+         * @brief Get the Vulkan descriptor set layout handle of the pipeline's own descriptor set.
+         *
+         * Owned by the `DescriptorLayoutCache`.
          */
-        vk::DescriptorSetLayout getDescriptorSetLayout() { return getHandleAt<3>(); }
+        vk::DescriptorSetLayout getDescriptorSetLayout() { return active().getHandleAt<3>(); }
         
         /**
          * @brief Get the STL vector of Vulkan descriptor set handles
          */
-        std::vector<vk::DescriptorSet> getDescriptorSets() { return getHandleAt<4>(); }
+        std::vector<vk::DescriptorSet> getDescriptorSets() { return active().getHandleAt<4>(); }
 
         /**
          * @brief Get a Vulkan descriptor set by index
@@ -106,7 +159,145 @@ namespace ivulk {
         /**
          * @brief Get an STL vector of color attachment indices
          */
-        std::vector<uint32_t> getColorAttIndices() { return m_colorAttIndices; }
+        std::vector<uint32_t> getColorAttIndices() { return active().m_colorAttIndices; }
+
+        /**
+         * @brief Check whether the pipeline uses the bindless texture table
+         */
+        bool isBindless() const { return active().m_bBindless; }
+
+        /**
+         * @brief Check whether the pipeline uses shared descriptor sets (see `GraphicsPipelineInfo::sets`)
+         */
+        bool usesSharedSets() const { return active().m_bSharedSets; }
+
+        /**
+         * @brief Check whether the pipeline has a per-instance vertex binding (see
+         *        `GraphicsPipelineInfo::instance`)
+         */
+        bool isInstanced() const { return active().m_bInstanced; }
+
+        /**
+         * @brief Check whether the pipeline is still being created by `createAsync`, and draws with its
+         *        fallback in the meantime.
+         */
+        bool isPending() const { return static_cast<bool>(m_fallback); }
+
+        /**
+         * @brief Get the descriptor set layout in a slot of the pipeline layout, or `VK_NULL_HANDLE` if the
+         *        pipeline layout doesn't have that many sets.
+         *
+         * @param slot The set index (see `E_DescriptorFrequency`)
+         */
+        VkDescriptorSetLayout getSetLayoutAt(uint32_t slot) const { return active().m_setLayouts.at(slot); }
+
+        /**
+         * @brief Get the descriptor set bound to a slot along with the pipeline, if any.
+         *
+         * @param slot The set index (see `E_DescriptorFrequency`)
+         * @param imageIndex The swapchain image being recorded, for the pipeline's own descriptor sets
+         */
+        VkDescriptorSet getDefaultSetAt(uint32_t slot, std::size_t imageIndex);
+
+        /**
+         * @brief Get the size of the pipeline's push constant range
+         */
+        uint32_t getPushConstantSize() const { return active().m_pushConstantSize; }
+
+        /**
+         * @brief Create a new pipeline using initialization information
+         *
+         * Pipelines created through `create`, `createBatch` or `createAsync` are rebuilt by `recreateAsync`
+         * when their shaders change.
+         *
+         * @param device The device to create the pipeline on
+         * @param info The parameters to use to create the pipeline
+         */
+        static Ptr create(VkDevice device, const GraphicsPipelineInfo& info);
+
+        /**
+         * @brief Create several pipelines concurrently on the app's worker threads.
+         *
+         * Every pipeline is compiled through the app's shared pipeline cache. The app state must not change
+         * until all the futures are ready, e.g. by recreating the swapchain or destroying resources the
+         * pipelines use.
+         *
+         * @param device The device to create the pipelines on
+         * @param infos The parameters for each pipeline
+         *
+         * @return A future for each pipeline, in the order of `infos`. Creation errors are rethrown by `get()`.
+         */
+        static std::vector<std::future<Ptr>> createBatch(VkDevice device,
+                                                         const std::vector<GraphicsPipelineInfo>& infos);
+
+        /**
+         * @brief Create a pipeline on the app's worker threads without waiting for it.
+         *
+         * The returned pipeline can be bound and drawn with right away. Until it is ready, every getter
+         * returns the handles of `fallback`, so draws use the fallback's shaders, layout and descriptor sets.
+         * `updateAsync()` switches it over at the start of the first frame after compilation finishes.
+         *
+         * The fallback should be created up front and shared by many pipelines, e.g. the same shaders
+         * without `GraphicsPipelineInfo::specialization`, and must accept the same push constants and
+         * descriptor sets as the pipelines falling back to it. Descriptor updates made while the pipeline is
+         * pending are applied once it's ready. `recreate` waits for the pending pipeline, discards it, and
+         * creates the new one synchronously.
+         *
+         * @param device The device to create the pipeline on
+         * @param info The parameters to use to create the pipeline
+         * @param fallback The pipeline to draw with until the new one is ready. If empty, the pipeline is
+         *                 created synchronously.
+         */
+        static Ptr createAsync(VkDevice device, GraphicsPipelineInfo info, Ptr fallback);
+
+        /**
+         * @brief Switch pipelines created with `createAsync` or rebuilt by `recreateAsync` whose creation has
+         *        finished to their new handles.
+         *
+         * Called by `App` at the start of each frame, before command buffers are recorded. If a pipeline
+         * failed to be created, it keeps drawing with its fallback or previous handles, and its creation
+         * error is rethrown.
+         */
+        static void updateAsync();
+
+        /**
+         * @brief Get the shader modules used by every live pipeline.
+         */
+        static std::set<boost::filesystem::path> getShaderPaths();
+
+        /**
+         * @brief Rebuild every live pipeline that uses any of some shader modules, on the app's worker
+         *        threads.
+         *
+         * Each pipeline keeps drawing with its current handles until its replacement is ready, then
+         * `updateAsync()` destroys the old handles and switches over. Descriptor updates made in the
+         * meantime are applied to both. Pipelines created with `createAsync` that are still pending start
+         * over with the new shaders.
+         *
+         * @param shaderPaths The changed shader modules, as given in `GraphicsPipelineInfo::shaderPath`
+         * @param ready Futures to wait for before building, e.g. the shader compilation. If any of them
+         *              returns false, the pipelines are left as they are.
+         *
+         * @return The number of pipelines being rebuilt
+         */
+        static std::size_t recreateAsync(const std::set<boost::filesystem::path>& shaderPaths,
+                                         const std::vector<std::shared_future<bool>>& ready);
+
+        /**
+         * @brief Rebind some of the uniform buffers or textures of the pipeline's own descriptor sets.
+         *
+         * Bindings that aren't listed keep their current resources. Each set is replaced with a freshly
+         * allocated one, written with a single template update, so unlike `recreate` this doesn't rebuild
+         * the pipeline. The previous sets are retired until pending command buffers are done with them.
+         * Must not be called while a command buffer using the pipeline is being recorded.
+         *
+         * Pipelines using `GraphicsPipelineInfo::sets` are updated with `DescriptorSet::update` instead.
+         *
+         * @param ubos New resources for uniform buffer bindings
+         * @param textures New resources for texture bindings
+         */
+        void updateDescriptors(const std::vector<PipelineUniformBufferBinding>& ubos,
+                               const std::vector<PipelineTextureBinding>& textures = {});
 
         /**
          * @brief Create a new graphics pipeline, and store it in this resource.
@@ -128,16 +319,66 @@ namespace ivulk {
                          vk::DescriptorSetLayout descrSetLayout,
                          std::vector<vk::DescriptorSet> descrSets);
 
+        /**
+         * @brief Get the pipeline whose handles are in use: the fallback while creation is pending
+         */
+        GraphicsPipeline& active() { return m_fallback ? m_fallback->active() : *this; }
+        const GraphicsPipeline& active() const { return m_fallback ? m_fallback->active() : *this; }
+
+        /**
+         * @brief Take over the handles and state of another pipeline, leaving it destroyed
+         */
+        void adopt(GraphicsPipeline& other);
+
+        /**
+         * @brief Add a pipeline to the list searched by `recreateAsync`
+         */
+        static void track(const Ptr& pipeline);
+
         std::vector<uint32_t> m_colorAttIndices;
+        bool m_bBindless = false;
+        bool m_bSharedSets = false;
+        bool m_bInstanced = false;
+        uint64_t m_descrSetKey = 0u;
+        std::vector<DescriptorTemplateData> m_descrData;
+        uint32_t m_pushConstantSize = 0u;
+        std::array<VkDescriptorSetLayout, E_DescriptorFrequency::Count> m_setLayouts = {};
+        std::array<DescriptorSet::Ptr, E_DescriptorFrequency::Bindless> m_sharedSets = {};
+
+        GraphicsPipelineInfo m_info = {}; ///< The parameters the current pipeline was created with
+
+        Ptr m_fallback = {};
+        std::future<Ptr> m_pending = {};
+        std::vector<std::pair<std::vector<PipelineUniformBufferBinding>, std::vector<PipelineTextureBinding>>>
+            m_deferredUpdates = {};
+
+        /**
+         * @brief The parts of the app state that pipeline creation reads.
+         *
+         * Copied on the thread that requests a pipeline, so workers never read `AppState` while the main
+         * thread writes it.
+         */
+        struct CreateContext
+        {
+            std::shared_ptr<BindlessTextureTable> bindlessTable      = {};
+            std::shared_ptr<DescriptorAllocator> descriptorAllocator = {};
+            uint32_t imageCount                                      = 0u;
+            VkExtent2D extent                                        = {};
+            VkFormat colorFormat                                     = VK_FORMAT_UNDEFINED;
+            VkFormat depthFormat                                     = VK_FORMAT_UNDEFINED;
+            VkPipelineCache cache                                    = VK_NULL_HANDLE;
+        };
+
+        /**
+         * @brief Copy the app state pipeline creation needs. Must run on the main thread.
+         */
+        static CreateContext captureContext();
 
         static GraphicsPipeline* createImpl(VkDevice device, GraphicsPipelineInfo info);
+        static GraphicsPipeline*
+        createWithContext(VkDevice device, GraphicsPipelineInfo info, const CreateContext& context);
 
         void destroyImpl();
-
-        static std::vector<char> readSPIRVFile(const boost::filesystem::path& fpath);
-        static vk::ShaderModule createShaderModule(VkDevice device,
-                                                 const std::vector<char>& shaderCode,
-                                                 const boost::filesystem::path& assetPath);
     };
 
 } // namespace ivulk
@@ -17,8 +17,21 @@
 #include <boost/filesystem.hpp>
 
 #include <optional>
+#include <vector>
 
 namespace ivulk {
+    /**
+     * @brief Standard channel assignments for packed material textures.
+     *
+     * Packed material maps follow the common ORM layout, with an optional height channel in alpha.
+     */
+    namespace E_PackedChannel {
+        constexpr uint32_t Occlusion = 0u; ///< Ambient occlusion (red)
+        constexpr uint32_t Roughness = 1u; ///< Roughness (green)
+        constexpr uint32_t Metallic  = 2u; ///< Metallic (blue)
+        constexpr uint32_t Height    = 3u; ///< Height / displacement (alpha)
+    } // namespace E_PackedChannel
+
     /**
      * @brief Information for initializing an Image resource
      */
@@ -38,12 +51,45 @@ namespace ivulk {
             bool bHDR = false; ///< If true, load the image as an HDR map. Default is false.
         } load;
 
+        /**
+         * @brief Settings for packing several scalar maps from the filesystem into one RGBA8 image.
+         *
+         * Each destination channel reads a single channel from its own source file. Channels without a
+         * source path are filled with their fallback value. All source files must share the same
+         * dimensions. See `E_PackedChannel` for the standard channel layout.
+         */
+        struct pack
+        {
+            /**
+             * @brief Source for a single destination channel.
+             */
+            struct channel
+            {
+                boost::filesystem::path path; ///< The file path to read from. If empty, `fallback` is used.
+                uint32_t sourceChannel = 0u;  ///< The channel of the source file to read.
+                uint8_t fallback       = 255; ///< The value used when no source path is given.
+            };
+
+            bool bEnable = false; ///< Set this to true to pack the image from several files
+            channel r;            ///< Red channel source (ambient occlusion in the ORM layout)
+            channel g;            ///< Green channel source (roughness in the ORM layout)
+            channel b;            ///< Blue channel source (metallic in the ORM layout)
+            channel a;            ///< Alpha channel source (height in the ORM layout)
+            bool bGenMips
+                = true; ///< If true (default), generate mipmaps for the packed image. Otherwise, no mipmaps are generated.
+        } pack;
+
         VkImageTiling tiling      = VK_IMAGE_TILING_OPTIMAL;    ///< Vulkan image tiling setting
         VkImageUsageFlags usage   = VK_IMAGE_USAGE_SAMPLED_BIT; ///< Vulkan image usage flags
         VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE;  ///< Vulkan image sharing mode
         VmaMemoryUsage memoryMode = E_MemoryMode::GpuOnly;      ///< Memory usage mode
         VkFormat format = VK_FORMAT_R8G8B8A8_SRGB; ///< Vulkan image format, if not loading from filesystem.
         VkExtent3D extent {};                      ///< The image extent
+        uint32_t mipLevels   = 1u; ///< The number of mip levels, if not loading from filesystem.
+        uint32_t arrayLayers = 1u; ///< The number of array layers. Must be 6 for cube maps.
+        bool bCube           = false; ///< If true, create a cube-compatible image with a cube image view.
+        bool bDeferMips
+            = false; ///< If true, loaded/packed images leave mip generation to a later `Image::generateMipMaps` batch.
         VkImageLayout layout      = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; ///< Vulkan image layout
         VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;                ///< Vulkan image aspect flags
     };
@@ -79,6 +125,47 @@ namespace ivulk {
          */
         VkExtent3D getExtent() { return m_extent; }
 
+        /**
+         * @brief Get the number of mip levels in the image.
+         */
+        uint32_t getMipLevels() { return m_mipLevels; }
+
+        /**
+         * @brief Get the number of array layers in the image.
+         */
+        uint32_t getArrayLayers() { return m_arrayLayers; }
+
+        /**
+         * @brief Check whether mip generation was deferred with `ImageInfo::bDeferMips` and hasn't run yet.
+         */
+        bool hasPendingMips() { return m_bMipsPending; }
+
+        /**
+         * @brief Get the number of mip levels in a full mip chain for an extent.
+         */
+        static uint32_t calcMipLevels(const VkExtent3D extent);
+
+        /**
+         * @brief Create several images, generating mips for all of them in a single batch.
+         *
+         * Equivalent to creating each image with `ImageInfo::bDeferMips` and then calling `generateMipMaps`.
+         */
+        static std::vector<Ptr> createBatch(VkDevice device, const std::vector<ImageInfo>& createInfos);
+
+        /**
+         * @brief Generate mips for a batch of images from their first mip level.
+         *
+         * Images with pending (deferred) mips are completed. Other images have their mip chain regenerated
+         * from their current first level, e.g. after rendering to it, and must be in the layout they were
+         * created with. Formats supported by `MipGenerator` are downsampled by compute in one submission;
+         * pending images in other formats fall back to blits.
+         *
+         * @throws std::invalid_argument if a non-pending image has a format `MipGenerator` doesn't support.
+         * @throws std::runtime_error if a pending image's format falls back to blits, but the device doesn't
+         *         support linear-filter blits for it.
+         */
+        static void generateMipMaps(const std::vector<Ptr>& images);
+
         void changeLayout(vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage, vk::ImageLayout oldLayout,  vk::ImageLayout newLayout);
 
     private:
@@ -86,13 +173,14 @@ namespace ivulk {
         VkFormat m_format;
         VkExtent3D m_extent;
         uint32_t m_mipLevels;
+        uint32_t m_arrayLayers;
+        VkImageLayout m_layout;
+        bool m_bMipsPending = false;
 
         Image(VkDevice device, VkImage image, VmaAllocation allocation, VkImageView view);
 
         static Image* createImpl(VkDevice device, ImageInfo createInfo);
 
         void destroyImpl();
-
-        static uint32_t calcMipLevels(const VkExtent3D extent);
     };
 } // namespace ivulk
@@ -0,0 +1,147 @@
+/**
+ * @file mip_generator.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `MipGenerator` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/compute_pipeline.hpp>
+#include <ivulk/core/sampler.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief An image whose mip chain should be generated from its first mip level.
+     */
+    struct MipGenTarget final
+    {
+        VkImage image        = VK_NULL_HANDLE; ///< The image to generate mips for
+        VkFormat format      = VK_FORMAT_UNDEFINED; ///< The image format
+        VkExtent3D extent    = {};             ///< The extent of the first mip level
+        uint32_t mipLevels   = 1u;             ///< The number of mip levels in the image
+        uint32_t arrayLayers = 1u;             ///< The number of array layers, each of which is downsampled
+        VkImageLayout oldLayout
+            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; ///< The current layout of every mip level of the image
+        VkImageLayout newLayout
+            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; ///< The layout to leave every mip level of the image in
+    };
+
+    /**
+     * @brief Transient views and descriptors used while recording mip generation.
+     *
+     * Must be kept alive until the command buffer it was recorded into has finished executing.
+     */
+    class MipGenBatch final
+    {
+    public:
+        explicit MipGenBatch(VkDevice device);
+        ~MipGenBatch();
+
+        MipGenBatch(const MipGenBatch&) = delete;
+        MipGenBatch& operator=(const MipGenBatch&) = delete;
+
+    private:
+        friend class MipGenerator;
+
+        VkDevice m_device;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        std::vector<VkImageView> m_views;
+    };
+
+    /**
+     * @brief Generates mip chains with a compute downsampler.
+     *
+     * Each dispatch reads one mip level and writes up to `LevelsPerDispatch` levels below it, reducing
+     * through workgroup shared memory, so a 4k texture needs three dispatches rather than a blit and two
+     * barriers per level. When several images are generated together, the dispatches for every image share
+     * the same barriers. Unlike `vkCmdBlitImage`, this doesn't require linear-filter blit support for the
+     * format.
+     *
+     * sRGB images are sampled through an sRGB view and written through a UNORM storage view with manual
+     * encoding, so they must be created with `VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT` and
+     * `VK_IMAGE_CREATE_EXTENDED_USAGE_BIT`. Images must also have `VK_IMAGE_USAGE_STORAGE_BIT` and
+     * `VK_IMAGE_USAGE_SAMPLED_BIT` usage. Images created through `Image` handle this automatically.
+     */
+    class MipGenerator : public VulkanResource<MipGenerator,
+                                               NullResourceInfo,
+                                               ComputePipeline::Ptr,
+                                               ComputePipeline::Ptr,
+                                               ComputePipeline::Ptr,
+                                               Sampler::Ptr>
+    {
+    public:
+        static constexpr uint32_t LevelsPerDispatch = 5u;  ///< Maximum mip levels written by a single dispatch
+        static constexpr uint32_t GroupSize         = 16u; ///< Workgroup size along each axis
+
+        /// SPIR-V for the rgba8, rgba16f and rgba32f downsamplers, relative to the assets directory
+        static constexpr const char* ShaderPaths[] = {
+            "shaders/mipgen/rgba8.comp.spv",
+            "shaders/mipgen/rgba16f.comp.spv",
+            "shaders/mipgen/rgba32f.comp.spv",
+        };
+
+        /**
+         * @brief Get the shared generator for the current app, creating it on first use.
+         */
+        static Ptr get();
+
+        /**
+         * @brief Release the shared generator. Called by `App` before the device is destroyed.
+         */
+        static void release();
+
+        /**
+         * @brief Check whether the compute path can generate mips for a format on the current device.
+         *
+         * Supported formats are `R8G8B8A8_UNORM`, `R8G8B8A8_SRGB`, `R16G16B16A16_SFLOAT` and
+         * `R32G32B32A32_SFLOAT`. `Image` generates mips for other formats with `vkCmdBlitImage`, and throws
+         * when the device doesn't support linear-filter blits for the format either.
+         */
+        static bool isFormatSupported(VkFormat format);
+
+        /**
+         * @brief Get the format used for storage views when generating mips for `format`.
+         */
+        static VkFormat getStorageFormat(VkFormat format);
+
+        /**
+         * @brief Record mip generation for a batch of images into a command buffer.
+         *
+         * Contents of every level except the first are overwritten. If a target's `oldLayout` is
+         * `VK_IMAGE_LAYOUT_UNDEFINED`, the first level is discarded as well.
+         *
+         * @return The transient resources used by the recorded commands. Keep them alive until the command
+         *         buffer has finished executing.
+         */
+        std::unique_ptr<MipGenBatch> record(VkCommandBuffer cb, const std::vector<MipGenTarget>& targets);
+
+        /**
+         * @brief Generate mips for a batch of images in a single submission and wait for it to complete.
+         */
+        void generate(const std::vector<MipGenTarget>& targets);
+
+    private:
+        friend base_t;
+
+        MipGenerator(VkDevice device,
+                     ComputePipeline::Ptr rgba8,
+                     ComputePipeline::Ptr rgba16f,
+                     ComputePipeline::Ptr rgba32f,
+                     Sampler::Ptr sampler);
+
+        static MipGenerator* createImpl(VkDevice device, NullResourceInfo info);
+
+        void destroyImpl();
+
+        ComputePipeline::Ptr getPipelineFor(VkFormat format);
+    };
+} // namespace ivulk
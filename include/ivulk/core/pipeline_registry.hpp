@@ -0,0 +1,80 @@
+/**
+ * @file pipeline_registry.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `PipelineRegistry` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/graphics_pipeline.hpp>
+
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Usage counters for the `PipelineRegistry`.
+     */
+    struct PipelineRegistryStats final
+    {
+        uint32_t requests  = 0u; ///< Total number of pipelines requested
+        uint32_t hits      = 0u; ///< Requests served by an existing pipeline
+        uint32_t created   = 0u; ///< Pipelines created by the registry
+        uint32_t pipelines = 0u; ///< Number of unique pipelines currently alive
+    };
+
+    /**
+     * @brief Static class that shares `GraphicsPipeline`s between identical `GraphicsPipelineInfo`s.
+     *
+     * Requests are keyed by every part of the info: shaders, vertex layout, fixed-function flags,
+     * specialization constants, and the identity of the resources and shared sets it binds. The swapchain
+     * state baked into pipelines is part of the key too, so requests made after the swapchain is recreated
+     * get new pipelines. Materials that only differ in resources bound elsewhere, e.g. bindless textures or
+     * overridden material sets, end up sharing a pipeline.
+     *
+     * The registry only holds weak references, so a pipeline is destroyed once nothing else uses it.
+     * Because pipelines are shared, they shouldn't be changed with `GraphicsPipeline::recreate` or
+     * `GraphicsPipeline::updateDescriptors`; request a pipeline for the new info instead. All methods are
+     * thread-safe.
+     */
+    class PipelineRegistry final
+    {
+    public:
+        /**
+         * @brief Get a pipeline matching `info`, creating it if needed.
+         */
+        static GraphicsPipeline::Ptr get(VkDevice device, const GraphicsPipelineInfo& info);
+
+        /**
+         * @brief Get a pipeline for each of `infos`, creating the missing ones concurrently on the app's
+         *        worker threads.
+         *
+         * Duplicates within `infos` are only created once. See `GraphicsPipeline::createBatch`.
+         *
+         * @return A pipeline for each info, in the order of `infos`
+         */
+        static std::vector<GraphicsPipeline::Ptr> getBatch(VkDevice device,
+                                                           const std::vector<GraphicsPipelineInfo>& infos);
+
+        /**
+         * @brief Get usage counters for the registry.
+         */
+        static PipelineRegistryStats getStats();
+
+        /**
+         * @brief Forget every registered pipeline and reset the counters.
+         *
+         * Pipelines still referenced elsewhere stay alive, but aren't shared anymore.
+         */
+        static void clear();
+
+    private:
+        // Disable construction
+        PipelineRegistry()                         = delete;
+        PipelineRegistry(const PipelineRegistry&)  = delete;
+        PipelineRegistry(const PipelineRegistry&&) = delete;
+        ~PipelineRegistry()                        = delete;
+    };
+} // namespace ivulk
@@ -27,6 +27,10 @@ namespace ivulk {
         constexpr VkSamplerAddressMode ClampEdge    = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
         constexpr VkSamplerAddressMode ClampBorder  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
     } // namespace E_SamplerAddressMode
+    namespace E_SamplerLod {
+        constexpr float FromImage = -1.0f; ///< Use the last mip level of the image the sampler is requested for (see `SamplerCache`)
+        constexpr float Unclamped = VK_LOD_CLAMP_NONE; ///< Don't clamp the maximum LOD
+    } // namespace E_SamplerLod
 
     struct SamplerInfo final
     {
@@ -58,7 +62,7 @@ namespace ivulk {
             VkSamplerMipmapMode mode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
             float lodBias            = 0.0f;
             float minLod             = 0.0f;
-            float maxLod             = 0.0f;
+            float maxLod             = E_SamplerLod::FromImage; ///< Without an image, `FromImage` is `Unclamped`
         } mips;
 
         uint32_t defaultBinding       = 0u;
@@ -69,6 +73,16 @@ namespace ivulk {
     {
     public:
         VkSampler getSampler() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Resolve defaults and apply device limits to sampler settings.
+         *
+         * `E_SamplerLod::FromImage` becomes `E_SamplerLod::Unclamped`, and anisotropy is disabled if the
+         * device doesn't support it or capped to `maxSamplerAnisotropy` otherwise. Samplers are always
+         * created from resolved settings.
+         */
+        static SamplerInfo resolveInfo(SamplerInfo info);
+
         VkDescriptorSetLayoutBinding getDescriptorLayoutBinding(std::optional<uint32_t> bindingIndex = {})
         {
             auto binding = getHandleAt<1>();
@@ -0,0 +1,71 @@
+/**
+ * @file sampler_cache.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `SamplerCache` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/image.hpp>
+#include <ivulk/core/sampler.hpp>
+
+namespace ivulk {
+    /**
+     * @brief Usage counters for the `SamplerCache`.
+     */
+    struct SamplerCacheStats final
+    {
+        uint32_t requests = 0u; ///< Total number of samplers requested
+        uint32_t hits     = 0u; ///< Requests served by an existing sampler
+        uint32_t samplers = 0u; ///< Number of unique samplers currently cached
+    };
+
+    /**
+     * @brief Static class that shares `Sampler`s between identical `SamplerInfo`s.
+     *
+     * Settings are resolved with `Sampler::resolveInfo` before lookup, so requests that only differ in
+     * values the device ignores (e.g. anisotropy above the device limit) share a sampler. The cache holds a
+     * strong reference to every sampler until `clear()` is called, which `App` does during cleanup.
+     *
+     * All methods are thread-safe.
+     */
+    class SamplerCache final
+    {
+    public:
+        /**
+         * @brief Get a sampler matching `info`, creating it if needed.
+         *
+         * `E_SamplerLod::FromImage` is treated as `E_SamplerLod::Unclamped`.
+         */
+        static Sampler::Ptr get(const SamplerInfo& info);
+
+        /**
+         * @brief Get a sampler matching `info` for sampling `image`, creating it if needed.
+         *
+         * If `info.mips.maxLod` is `E_SamplerLod::FromImage`, the LOD range covers the image's mip chain.
+         */
+        static Sampler::Ptr get(SamplerInfo info, const Image::Ptr& image);
+
+        /**
+         * @brief Get usage counters for the cache.
+         */
+        static SamplerCacheStats getStats();
+
+        /**
+         * @brief Release every cached sampler and reset the counters.
+         *
+         * Samplers still referenced elsewhere stay alive.
+         */
+        static void clear();
+
+    private:
+        // Disable construction
+        SamplerCache()                     = delete;
+        SamplerCache(const SamplerCache&)  = delete;
+        SamplerCache(const SamplerCache&&) = delete;
+        ~SamplerCache()                    = delete;
+    };
+} // namespace ivulk
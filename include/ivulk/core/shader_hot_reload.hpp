@@ -0,0 +1,60 @@
+/**
+ * @file shader_hot_reload.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `ShaderHotReload` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+namespace ivulk {
+    /**
+     * @brief Static class that rebuilds shaders and pipelines when shader sources are saved.
+     *
+     * Watches the `ShaderVariantCompiler` source directories, including ones added after `enable()`. When a
+     * source or template changes, every shader module used by a live `GraphicsPipeline` that depends on it is
+     * recompiled with `ShaderVariantCompiler::reload`, and the pipelines using those modules are rebuilt
+     * with `GraphicsPipeline::recreateAsync`. Both happen on the app's worker threads, and pipelines switch
+     * to their new handles at the start of a later frame.
+     *
+     * A shader that fails to compile prints its error and leaves its pipelines as they were, so the app keeps
+     * running until the source is fixed. Compute pipelines aren't rebuilt.
+     *
+     * Enabled by `App::InitArgs::bShaderHotReload`. All methods are thread-safe.
+     */
+    class ShaderHotReload final
+    {
+    public:
+        /**
+         * @brief Start watching the shader source directories.
+         */
+        static void enable();
+
+        /**
+         * @brief Stop watching for changes. Rebuilds that already started still finish.
+         */
+        static void disable();
+
+        /**
+         * @brief Check whether shader sources are being watched.
+         */
+        static bool isEnabled();
+
+        /**
+         * @brief Start rebuilding the shaders and pipelines affected by sources changed since the last call.
+         *
+         * Called by `App` at the start of each frame, before `GraphicsPipeline::updateAsync`. Has no effect
+         * if hot reloading isn't enabled.
+         */
+        static void update();
+
+    private:
+        // Disable construction
+        ShaderHotReload()                        = delete;
+        ShaderHotReload(const ShaderHotReload&)  = delete;
+        ShaderHotReload(const ShaderHotReload&&) = delete;
+        ~ShaderHotReload()                       = delete;
+    };
+} // namespace ivulk
@@ -0,0 +1,128 @@
+/**
+ * @file shader_module_cache.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `ShaderModuleCache` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Usage counters for the `ShaderModuleCache`.
+     */
+    struct ShaderModuleCacheStats final
+    {
+        uint32_t requests  = 0u; ///< Total number of modules requested by path
+        uint32_t hits      = 0u; ///< Requests served without reading a file
+        uint32_t modules   = 0u; ///< Number of unique modules currently cached
+        uint32_t paths     = 0u; ///< Number of paths currently mapped to a module
+        uint32_t filesRead = 0u; ///< Number of SPIR-V files read from disk
+        uint64_t bytesRead = 0u; ///< Total size of the SPIR-V files read from disk
+    };
+
+    /**
+     * @brief Static class that loads SPIR-V shaders once and shares their modules between pipelines.
+     *
+     * Modules are looked up by asset path. The first request for a path reads the file and hashes its
+     * contents, and later requests return the cached module without touching the file, so rebuilding a
+     * pipeline does no file I/O. Paths with identical contents share a single module.
+     *
+     * Each module is destroyed once no path refers to it anymore and no `Lease` holds it, or when `clear()`
+     * is called, which `App` does during cleanup. Pipelines don't need their modules after creation, so
+     * modules can be replaced while pipelines built from them are still in use. Pipelines being created
+     * hold their modules with `acquire()`, so a module replaced on another thread meanwhile stays valid
+     * until they're done.
+     *
+     * All methods are thread-safe.
+     */
+    class ShaderModuleCache final
+    {
+    public:
+        /**
+         * @brief Keeps a module alive while a pipeline is created from it, even if its path is remapped.
+         */
+        class Lease final
+        {
+        public:
+            Lease() = default;
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&& other) noexcept;
+            Lease(const Lease&)            = delete;
+            Lease& operator=(const Lease&) = delete;
+            ~Lease();
+
+            VkShaderModule get() const { return m_module; }
+
+        private:
+            friend class ShaderModuleCache;
+
+            Lease(uint64_t hash, VkShaderModule module);
+            void release();
+
+            uint64_t m_hash         = 0u;
+            VkShaderModule m_module = VK_NULL_HANDLE;
+        };
+
+        /**
+         * @brief Get the module for a SPIR-V file, loading it if needed.
+         *
+         * The module may be destroyed as soon as another thread replaces or invalidates the path. Use
+         * `acquire()` to create pipelines while other threads may do so.
+         *
+         * @param path The path of the SPIR-V file, relative to the assets directory
+         */
+        static VkShaderModule get(const boost::filesystem::path& path);
+
+        /**
+         * @brief Get the module for a SPIR-V file like `get()`, and keep it alive until the lease is gone.
+         *
+         * @param path The path of the SPIR-V file, relative to the assets directory
+         */
+        static Lease acquire(const boost::filesystem::path& path);
+
+        /**
+         * @brief Supply SPIR-V from memory for a path.
+         *
+         * Later requests for the path return this module instead of reading the file. Replaces the module
+         * currently mapped to the path, if any.
+         *
+         * @param path The path to register the code under, relative to the assets directory
+         * @param code The SPIR-V code
+         */
+        static VkShaderModule add(const boost::filesystem::path& path, const std::vector<uint32_t>& code);
+
+        /**
+         * @brief Forget the module mapped to a path, so the next request reads the file again.
+         *
+         * @return Whether the path was cached
+         */
+        static bool invalidate(const boost::filesystem::path& path);
+
+        /**
+         * @brief Get usage counters for the cache.
+         */
+        static ShaderModuleCacheStats getStats();
+
+        /**
+         * @brief Destroy every cached module and reset the counters.
+         */
+        static void clear();
+
+    private:
+        // Disable construction
+        ShaderModuleCache()                          = delete;
+        ShaderModuleCache(const ShaderModuleCache&)  = delete;
+        ShaderModuleCache(const ShaderModuleCache&&) = delete;
+        ~ShaderModuleCache()                         = delete;
+    };
+} // namespace ivulk
@@ -0,0 +1,140 @@
+/**
+ * @file shader_variant_compiler.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `ShaderVariantCompiler` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Parameters for a shader variant.
+     */
+    struct ShaderVariantInfo final
+    {
+        /**
+         * @brief The shader source, relative to a source directory.
+         *
+         * See `ShaderVariantCompiler::addSourceDir`. Sources ending in `.jinja` are rendered as templates
+         * first. The stage is taken from the extension before `.jinja`, e.g. `physical.frag.jinja`.
+         */
+        boost::filesystem::path source;
+
+        /**
+         * @brief Template context, also passed to the GLSL preprocessor as defines.
+         *
+         * Values that look like numbers or booleans are passed to templates as such; anything else is
+         * passed as a string.
+         */
+        std::map<std::string, std::string> context = {};
+    };
+
+    /**
+     * @brief Usage counters for the `ShaderVariantCompiler`.
+     */
+    struct ShaderVariantCompilerStats final
+    {
+        uint32_t requests   = 0u; ///< Total number of variants requested
+        uint32_t memoryHits = 0u; ///< Requests for variants already loaded in this run
+        uint32_t diskHits   = 0u; ///< Requests served from the on-disk SPIR-V cache
+        uint32_t compiled   = 0u; ///< Variants compiled from source
+    };
+
+    /**
+     * @brief Static class that compiles shader variants at runtime, and caches the SPIR-V on disk.
+     *
+     * Variants are identified by a hash of the source, every template it includes, imports or extends, the
+     * context, and the Vulkan SDK version and options they're compiled with. A variant found in the cache
+     * directory is loaded without compiling. Otherwise, `.jinja` templates are rendered with the same
+     * template tool as the content build, and the GLSL is compiled with shaderc. Compiled code is
+     * registered with the `ShaderModuleCache` under a generated path, which can be used in
+     * `GraphicsPipelineInfo::shaderPath`.
+     *
+     * Rendering templates requires Python with Jinja2, and compiling requires the library to be built with
+     * `IVULK_RUNTIME_SHADERS`. Variants already in the disk cache load without either. All methods are
+     * thread-safe.
+     */
+    class ShaderVariantCompiler final
+    {
+    public:
+        /**
+         * @brief Get a variant, compiling it if it isn't cached.
+         *
+         * Repeated requests with the same source and context return the path loaded earlier in the run,
+         * without checking the sources for changes. Call `invalidate()` to pick up changes.
+         *
+         * @return The path of the variant in the `ShaderModuleCache`
+         */
+        static boost::filesystem::path get(const ShaderVariantInfo& info);
+
+        /**
+         * @brief Forget the variants loaded in this run, so the next requests check their sources again.
+         */
+        static void invalidate();
+
+        /**
+         * @brief Get the source files a module depends on.
+         *
+         * Works for variants loaded in this run, and for content shaders built from a source with the same
+         * relative path in a source directory, e.g. `shaders/sphere.frag.spv` from
+         * `shaders/sphere.frag.jinja`.
+         *
+         * @param modulePath The path of the module in the `ShaderModuleCache`
+         *
+         * @return The absolute paths of the source and every template it pulls in, with the source first.
+         *         Empty if the module's source isn't known.
+         */
+        static std::vector<boost::filesystem::path>
+        getDependencies(const boost::filesystem::path& modulePath);
+
+        /**
+         * @brief Rebuild a module from its current source, and register the new code under the same path.
+         *
+         * Used for hot reloading. The module's source is found as in `getDependencies()`. Existing
+         * pipelines keep their old code; pipelines created afterwards use the new code.
+         *
+         * @param modulePath The path of the module in the `ShaderModuleCache`
+         */
+        static void reload(const boost::filesystem::path& modulePath);
+
+        /**
+         * @brief Get the directories searched for sources and templates, in search order.
+         */
+        static std::vector<boost::filesystem::path> getSourceDirs();
+
+        /**
+         * @brief Add a directory to search for sources and templates.
+         *
+         * The shader library is always searched, after any added directories.
+         */
+        static void addSourceDir(const boost::filesystem::path& dir);
+
+        /**
+         * @brief Set the directory compiled SPIR-V is cached in.
+         *
+         * Defaults to `shadercache` in the assets directory.
+         */
+        static void setCacheDir(const boost::filesystem::path& dir);
+
+        /**
+         * @brief Get usage counters for the compiler.
+         */
+        static ShaderVariantCompilerStats getStats();
+
+    private:
+        // Disable construction
+        ShaderVariantCompiler()                              = delete;
+        ShaderVariantCompiler(const ShaderVariantCompiler&)  = delete;
+        ShaderVariantCompiler(const ShaderVariantCompiler&&) = delete;
+        ~ShaderVariantCompiler()                             = delete;
+    };
+} // namespace ivulk
@@ -0,0 +1,66 @@
+/**
+ * @file specialization.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `SpecializationConstant` struct and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <cstring>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief The value of a shader specialization constant.
+     *
+     * Only 32-bit scalar constants are supported: `int`, `uint`, `float` and `bool` (as a `VkBool32`).
+     * Integer and boolean constants can be given directly, e.g. `{E_SpecConstant::NormalMap, VK_FALSE}`.
+     */
+    struct SpecializationConstant final
+    {
+        uint32_t id    = 0u; ///< The `constant_id` of the constant in the shader
+        uint32_t value = 0u; ///< The bits of the value
+
+        /**
+         * @brief Create a constant from a float value.
+         */
+        static SpecializationConstant fromFloat(uint32_t id, float value)
+        {
+            SpecializationConstant res {.id = id};
+            std::memcpy(&res.value, &value, sizeof(float));
+            return res;
+        }
+    };
+
+    /**
+     * @brief Specialization map entries and data for a list of constants.
+     *
+     * `info` points into this object and into the constant list it was built from, so both must outlive any
+     * pipeline create info using it.
+     */
+    struct SpecializationData final
+    {
+        std::vector<VkSpecializationMapEntry> entries = {}; ///< A map entry for each constant
+        VkSpecializationInfo info                     = {}; ///< The specialization info for shader stages
+
+        /**
+         * @brief Build the specialization info for a list of constants.
+         *
+         * @param constants The constants. Each `id` may appear at most once.
+         */
+        explicit SpecializationData(const std::vector<SpecializationConstant>& constants);
+
+        /**
+         * @brief Get a pointer to `info`, or `nullptr` if there are no constants.
+         */
+        const VkSpecializationInfo* get() const { return entries.empty() ? nullptr : &info; }
+
+        SpecializationData(const SpecializationData&) = delete;
+        SpecializationData& operator=(const SpecializationData&) = delete;
+    };
+} // namespace ivulk
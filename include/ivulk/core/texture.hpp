@@ -46,6 +46,14 @@ namespace ivulk {
             }
             return VK_NULL_HANDLE;
         }
+        VkDescriptorImageInfo getDescriptorImageInfo() const
+        {
+            return {
+                .sampler     = getSampler(),
+                .imageView   = getImageView(),
+                .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            };
+        }
     };
 
 } // namespace ivulk
@@ -122,5 +122,13 @@ namespace ivulk {
             }
             return 0u;
         }
+        VkDescriptorBufferInfo getDescriptorBufferInfo() const
+        {
+            return {
+                .buffer = getBuffer(),
+                .offset = 0u,
+                .range  = getSize(),
+            };
+        }
     };
 } // namespace ivulk
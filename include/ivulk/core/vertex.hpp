@@ -44,7 +44,7 @@
         {                                                                                                    \
             return {                                                                                         \
                 .binding    = getBindingDescription(binding, inputRate),                                     \
-                .attributes = getAttributeDescriptions(),                                                    \
+                .attributes = getAttributeDescriptions(binding),                                             \
             };                                                                                               \
         }                                                                                                    \
     }
@@ -120,6 +120,11 @@ namespace ivulk {
         }
         void setDestroyed(bool bDestroyed) { m_destroyed = bDestroyed; }
 
+        /**
+         * @brief Check whether `destroy()` has been called since the resource was created
+         */
+        bool isDestroyed() const { return m_destroyed; }
+
     protected:
         handles_t handles;
 
@@ -0,0 +1,146 @@
+/**
+ * @file bounds.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief Bounding volumes and view frustums for visibility culling.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+
+#include <array>
+#include <limits>
+
+namespace ivulk {
+    /**
+     * @brief A bounding sphere.
+     *
+     * A negative radius means the bounds are unknown; culling treats such objects as always visible.
+     */
+    struct BoundingSphere final
+    {
+        glm::vec3 center = glm::vec3(0); ///< Center of the sphere
+        float radius     = -1.0f;        ///< Radius of the sphere, or negative if unbounded
+
+        /**
+         * @brief Check whether the sphere bounds anything.
+         */
+        bool isValid() const { return radius >= 0.0f; }
+
+        /**
+         * @brief Get a sphere containing this sphere after a transform.
+         *
+         * The radius is scaled by the largest scale of the transform, so the result stays conservative
+         * under non-uniform scaling.
+         */
+        BoundingSphere transformed(const glm::mat4& transform) const;
+    };
+
+    /**
+     * @brief An axis-aligned bounding box.
+     *
+     * A default box is empty, with `min` above `max`; culling treats such objects as always visible. Grow
+     * it with `expand`.
+     */
+    struct BoundingBox final
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());    ///< Smallest corner
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest()); ///< Largest corner
+
+        /**
+         * @brief Check whether the box bounds anything.
+         */
+        bool isValid() const { return glm::all(glm::lessThanEqual(min, max)); }
+
+        glm::vec3 getCenter() const { return 0.5f * (min + max); }
+        glm::vec3 getExtent() const { return 0.5f * (max - min); } ///< Half the size along each axis
+
+        /**
+         * @brief Grow the box to contain a point.
+         */
+        void expand(glm::vec3 point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        /**
+         * @brief Grow the box to contain another box. Empty boxes are ignored.
+         */
+        void expand(const BoundingBox& box)
+        {
+            min = glm::min(min, box.min);
+            max = glm::max(max, box.max);
+        }
+
+        /**
+         * @brief Get the surface area of the box, or zero if empty.
+         */
+        float getSurfaceArea() const;
+
+        /**
+         * @brief Check whether the box overlaps another box. Empty boxes overlap nothing.
+         */
+        bool intersects(const BoundingBox& box) const;
+
+        /**
+         * @brief Check whether the box overlaps a sphere. Unbounded spheres overlap everything.
+         */
+        bool intersects(const BoundingSphere& sphere) const;
+
+        /**
+         * @brief Intersect a ray with the box.
+         *
+         * @param origin The start of the ray
+         * @param invDirection One divided by each component of the ray's direction
+         * @param maxDistance The length of the ray, in units of its direction
+         * @param[out] distance Where the ray enters the box, or 0 if it starts inside
+         * @return Whether the ray hits the box within its length
+         */
+        bool intersectRay(glm::vec3 origin, glm::vec3 invDirection, float maxDistance, float& distance) const;
+
+        /**
+         * @brief Get the axis-aligned box containing this box after a transform.
+         */
+        BoundingBox transformed(const glm::mat4& transform) const;
+
+        bool operator==(const BoundingBox& other) const { return min == other.min && max == other.max; }
+        bool operator!=(const BoundingBox& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief The six planes of a view frustum.
+     *
+     * Planes are normalized, with their normals pointing into the frustum: a point `p` is inside a plane
+     * if `dot(plane.xyz, p) + plane.w >= 0`.
+     */
+    struct Frustum final
+    {
+        std::array<glm::vec4, 6> planes = {}; ///< Left, right, bottom, top, near and far planes
+
+        /**
+         * @brief Extract the planes from a view-projection matrix.
+         *
+         * Expects the Vulkan clip space used throughout the library, with depth from 0 to 1.
+         */
+        static Frustum fromMatrix(const glm::mat4& viewProjection);
+
+        /**
+         * @brief Check whether a sphere is at least partly inside the frustum.
+         *
+         * Unbounded spheres are always inside.
+         */
+        bool intersects(const BoundingSphere& sphere) const;
+
+        /**
+         * @brief Check whether a box is at least partly inside the frustum.
+         *
+         * Conservative: boxes outside the frustum but near its corners can pass. Empty boxes are always
+         * inside.
+         */
+        bool intersects(const BoundingBox& box) const;
+    };
+} // namespace ivulk
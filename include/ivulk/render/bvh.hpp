@@ -0,0 +1,276 @@
+/**
+ * @file bvh.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `Bvh` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+#include <ivulk/render/bounds.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief A dynamic bounding volume hierarchy of axis-aligned boxes, each tagged with a value.
+     *
+     * Boxes are inserted next to the sibling that grows the tree's surface area the least, and moving a box
+     * only refits the boxes on its path to the root. As boxes move, the tree drifts from the best split;
+     * `optimize` rebuilds it from scratch with the surface area heuristic once enough has changed.
+     *
+     * Nodes are stored in a flat array, and rebuilds lay them out depth first, so traversals mostly walk
+     * forward through memory. Queries visit only the subtrees overlapping the query volume, so their cost
+     * grows with the number of results rather than the number of boxes.
+     *
+     * Boxes are referred to by proxy IDs, which stay the same across rebuilds. Queries share scratch
+     * storage, so they must not be nested or run concurrently on the same tree.
+     */
+    class Bvh final
+    {
+    public:
+        static constexpr uint32_t Null = std::numeric_limits<uint32_t>::max(); ///< No proxy or node
+
+        /**
+         * @brief Add a box.
+         *
+         * @param box The box; must not be empty
+         * @param value A value passed to query callbacks
+         * @return The proxy ID of the box
+         */
+        uint32_t insert(const BoundingBox& box, uint32_t value);
+
+        /**
+         * @brief Remove a box. Its proxy ID may be reused.
+         */
+        void remove(uint32_t proxy);
+
+        /**
+         * @brief Move a box, refitting its ancestors.
+         *
+         * Does nothing if the box didn't change.
+         */
+        void update(uint32_t proxy, const BoundingBox& box);
+
+        /**
+         * @brief Change the value of a box.
+         */
+        void setValue(uint32_t proxy, uint32_t value) { m_proxies[proxy].value = value; }
+
+        uint32_t getValue(uint32_t proxy) const { return m_proxies[proxy].value; }
+        const BoundingBox& getBox(uint32_t proxy) const { return m_proxies[proxy].box; }
+
+        /**
+         * @brief Rebuild the tree with the surface area heuristic.
+         */
+        void rebuild();
+
+        /**
+         * @brief Rebuild the tree if boxes were inserted, removed or moved since the last rebuild at least
+         *        half as many times as there are boxes.
+         */
+        void optimize();
+
+        /**
+         * @brief Remove every box.
+         */
+        void clear();
+
+        /**
+         * @brief Get the number of boxes.
+         */
+        std::size_t size() const { return m_proxies.size() - m_freeProxies.size(); }
+
+        /**
+         * @brief Get the box around every box, or an empty box if there are none.
+         */
+        BoundingBox getBounds() const { return m_root == Null ? BoundingBox {} : m_nodes[m_root].box; }
+
+        /**
+         * @brief Call `f(value, bInside)` for every box at least partly inside a frustum.
+         *
+         * `bInside` is set for boxes entirely inside, which need no finer test.
+         */
+        template <typename F>
+        void query(const Frustum& frustum, F&& f) const;
+
+        /**
+         * @brief Call `f(value)` for every box overlapping a box.
+         */
+        template <typename F>
+        void query(const BoundingBox& box, F&& f) const
+        {
+            queryIf([&box](const BoundingBox& b) { return b.intersects(box); }, std::forward<F>(f));
+        }
+
+        /**
+         * @brief Call `f(value)` for every box overlapping a sphere.
+         */
+        template <typename F>
+        void query(const BoundingSphere& sphere, F&& f) const
+        {
+            queryIf([&sphere](const BoundingBox& b) { return b.intersects(sphere); }, std::forward<F>(f));
+        }
+
+        /**
+         * @brief Call `f(value, distance)` for every box hit by a ray, in no particular order.
+         *
+         * @param origin The start of the ray
+         * @param direction The direction of the ray
+         * @param maxDistance The length of the ray, in units of `direction`
+         * @param f The callback, given where the ray enters the box
+         */
+        template <typename F>
+        void raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, F&& f) const;
+
+    private:
+        struct Node
+        {
+            BoundingBox box = {};
+            uint32_t parent = Null;
+            uint32_t left   = Null; ///< First child, or `Null` for leaves
+            uint32_t right  = Null; ///< Second child, or the proxy of a leaf
+        };
+
+        struct Proxy
+        {
+            BoundingBox box = {};
+            uint32_t value  = 0u;
+            uint32_t node   = Null; ///< Leaf node of the proxy, or `Null` if free
+        };
+
+        static bool isLeaf(const Node& node) { return node.left == Null; }
+
+        uint32_t allocateNode();
+        void freeNode(uint32_t node);
+        void insertLeaf(uint32_t leaf);
+        void removeLeaf(uint32_t leaf);
+
+        /**
+         * @brief Recompute the boxes of a node and its ancestors, stopping when a box doesn't change
+         */
+        void refit(uint32_t node);
+
+        /**
+         * @brief Build a subtree over `m_buildProxies[begin, end)`, depth first
+         */
+        uint32_t build(uint32_t begin, uint32_t end, uint32_t parent);
+
+        /**
+         * @brief Call `f(value)` for every leaf whose box and ancestors' boxes pass `test`.
+         */
+        template <typename Test, typename F>
+        void queryIf(Test&& test, F&& f) const;
+
+        /**
+         * @brief Classify a box against the planes of a frustum still in `mask`.
+         *
+         * Removes planes the box is entirely inside of from `mask`.
+         *
+         * @return False if the box is outside a plane
+         */
+        static bool testPlanes(const Frustum& frustum, const BoundingBox& box, uint32_t& mask);
+
+        std::vector<Node> m_nodes;
+        std::vector<Proxy> m_proxies;
+        std::vector<uint32_t> m_freeNodes;
+        std::vector<uint32_t> m_freeProxies;
+        std::vector<uint32_t> m_buildProxies; ///< Scratch for `rebuild`
+
+        uint32_t m_root       = Null;
+        std::size_t m_changes = 0u; ///< Inserts, removes and moves since the last rebuild
+
+        mutable std::vector<std::pair<uint32_t, uint32_t>> m_stack; ///< Traversal scratch, node and planes
+    };
+
+    template <typename Test, typename F>
+    void Bvh::queryIf(Test&& test, F&& f) const
+    {
+        if (m_root == Null)
+            return;
+
+        m_stack.clear();
+        m_stack.emplace_back(m_root, 0u);
+        while (!m_stack.empty())
+        {
+            const Node& node = m_nodes[m_stack.back().first];
+            m_stack.pop_back();
+            if (!test(node.box))
+                continue;
+
+            if (isLeaf(node))
+            {
+                f(m_proxies[node.right].value);
+                continue;
+            }
+            m_stack.emplace_back(node.right, 0u);
+            m_stack.emplace_back(node.left, 0u);
+        }
+    }
+
+    template <typename F>
+    void Bvh::query(const Frustum& frustum, F&& f) const
+    {
+        if (m_root == Null)
+            return;
+
+        // Each entry carries the planes its node still straddles; once none are left, the whole subtree is
+        // inside and reported without further tests
+        constexpr uint32_t allPlanes = (1u << 6) - 1u;
+
+        m_stack.clear();
+        m_stack.emplace_back(m_root, allPlanes);
+        while (!m_stack.empty())
+        {
+            auto [index, mask] = m_stack.back();
+            m_stack.pop_back();
+
+            const Node& node = m_nodes[index];
+            if (mask != 0u && !testPlanes(frustum, node.box, mask))
+                continue;
+
+            if (isLeaf(node))
+            {
+                f(m_proxies[node.right].value, mask == 0u);
+                continue;
+            }
+            m_stack.emplace_back(node.right, mask);
+            m_stack.emplace_back(node.left, mask);
+        }
+    }
+
+    template <typename F>
+    void Bvh::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance, F&& f) const
+    {
+        if (m_root == Null)
+            return;
+
+        const glm::vec3 invDirection = 1.0f / direction;
+
+        m_stack.clear();
+        m_stack.emplace_back(m_root, 0u);
+        while (!m_stack.empty())
+        {
+            const Node& node = m_nodes[m_stack.back().first];
+            m_stack.pop_back();
+
+            float distance = 0.0f;
+            if (!node.box.intersectRay(origin, invDirection, maxDistance, distance))
+                continue;
+
+            if (isLeaf(node))
+            {
+                f(m_proxies[node.right].value, distance);
+                continue;
+            }
+            m_stack.emplace_back(node.right, 0u);
+            m_stack.emplace_back(node.left, 0u);
+        }
+    }
+} // namespace ivulk
@@ -0,0 +1,79 @@
+/**
+ * @file frustum_culler.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `FrustumCuller` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/bounds.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief Tests many bounding volumes against a view frustum on the CPU.
+     *
+     * Each object is added with a box and a sphere in world space, and is culled if either is outside the
+     * frustum. Volumes are stored as structure-of-arrays, so `cull` tests 8 objects per instruction with
+     * AVX, or 4 with SSE, depending on what the library was compiled for, with a scalar fallback
+     * otherwise.
+     *
+     * The culler is meant to be cleared and refilled every frame; it keeps its storage between frames.
+     */
+    class FrustumCuller final
+    {
+    public:
+        /**
+         * @brief Remove every object. Storage is kept for the next frame.
+         */
+        void clear();
+
+        /**
+         * @brief Add an object to test.
+         *
+         * Objects with neither a valid box nor a valid sphere are never culled.
+         *
+         * @param box The object's box in world space
+         * @param sphere The object's sphere in world space
+         * @return The index to check the object's visibility with
+         */
+        std::size_t add(const BoundingBox& box, const BoundingSphere& sphere = {});
+
+        /**
+         * @brief Test every object against a frustum.
+         */
+        void cull(const Frustum& frustum);
+
+        /**
+         * @brief Check whether an object passed the last `cull`.
+         */
+        bool isVisible(std::size_t index) const { return m_visible[index] != 0u; }
+
+        /**
+         * @brief Get the number of objects added since the last `clear`.
+         */
+        std::size_t size() const { return m_count; }
+
+        /**
+         * @brief Get the number of objects that passed the last `cull`.
+         */
+        std::size_t getVisibleCount() const { return m_visibleCount; }
+
+    private:
+        // Objects, padded to a multiple of the widest batch
+        std::vector<float> m_centerX, m_centerY, m_centerZ; ///< Box centers
+        std::vector<float> m_extentX, m_extentY, m_extentZ; ///< Box half sizes
+        std::vector<float> m_sphereX, m_sphereY, m_sphereZ; ///< Sphere centers
+        std::vector<float> m_radius;                        ///< Sphere radii
+        std::vector<uint8_t> m_visible;                     ///< Result of the last `cull` per object
+
+        std::size_t m_count        = 0u;
+        std::size_t m_visibleCount = 0u;
+    };
+} // namespace ivulk
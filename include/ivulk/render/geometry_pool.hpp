@@ -0,0 +1,165 @@
+/**
+ * @file geometry_pool.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `GeometryPool` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/buffer.hpp>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief The location of a mesh in a `GeometryPool`.
+     *
+     * Matches the fields of `VkDrawIndexedIndirectCommand` that select the geometry to draw.
+     */
+    struct GeometryRange final
+    {
+        uint32_t indexCount  = 0u; ///< Number of indices
+        uint32_t firstIndex  = 0u; ///< Index of the first index in the pool's index buffer
+        int32_t vertexOffset = 0;  ///< Added to every index, i.e. the first vertex in the vertex buffer
+    };
+
+    /**
+     * @brief Shared vertex and index buffers for meshes with the same vertex format.
+     *
+     * Meshes in the same pool are drawn from the same buffers, so consecutive draws of different meshes
+     * don't rebind buffers, and can be merged into a single indirect draw (see `RenderQueue`).
+     *
+     * Removed meshes leave gaps that later meshes are placed in when they fit, and gaps at the end of the
+     * buffers are given back to be appended to; the buffers themselves never shrink, and are released along
+     * with the pool. When the buffers run out of space, they are replaced with buffers twice the size, and
+     * the old contents are copied over on the GPU, so fetch the buffers again after adding meshes. Adding
+     * meshes waits for the graphics queue to go idle, as loading a `StaticMesh` always did. All methods are
+     * thread-safe.
+     */
+    class GeometryPool final
+    {
+    public:
+        using Ptr = std::shared_ptr<GeometryPool>;
+        using Ref = std::weak_ptr<GeometryPool>;
+
+        /**
+         * @brief Create an empty pool.
+         *
+         * @param vertexStride The size of a vertex, in bytes
+         */
+        static Ptr create(uint32_t vertexStride);
+
+        /**
+         * @brief Get the pool shared by every mesh with the given vertex size, creating it if needed.
+         *
+         * Shared pools are released by `release()` when the app is cleaned up; meshes keep theirs alive
+         * until they're destroyed.
+         */
+        static Ptr get(uint32_t vertexStride);
+
+        /**
+         * @brief Release the shared pools.
+         */
+        static void release();
+
+        /**
+         * @brief Copy a mesh into the pool.
+         *
+         * @param vertices The vertex data, `vertexCount` vertices of the pool's vertex stride
+         * @param vertexCount The number of vertices
+         * @param indices The indices, relative to the mesh's first vertex
+         *
+         * @return Where the mesh was placed
+         */
+        GeometryRange add(const void* vertices, uint32_t vertexCount, const std::vector<uint32_t>& indices);
+
+        /**
+         * @brief Copy more indices for vertices already in the pool, e.g. a mesh's levels of detail.
+         *
+         * @param vertexOffset The `vertexOffset` of the range the vertices were added with
+         * @param indices The indices, relative to that range's first vertex
+         *
+         * @return Where the indices were placed, drawing the same vertices
+         */
+        GeometryRange addIndices(int32_t vertexOffset, const std::vector<uint32_t>& indices);
+
+        /**
+         * @brief Free a range returned by `add()`, its vertices included.
+         *
+         * Remove the ranges `addIndices()` returned for the same vertices first, as they can't be drawn
+         * afterwards.
+         */
+        void remove(const GeometryRange& range);
+
+        /**
+         * @brief Free the indices of a range returned by `addIndices()`, keeping the vertices.
+         */
+        void removeIndices(const GeometryRange& range);
+
+        /**
+         * @brief Get the vertex buffer shared by every mesh in the pool.
+         */
+        Buffer::Ptr getVertexBuffer();
+
+        /**
+         * @brief Get the index buffer shared by every mesh in the pool.
+         */
+        Buffer::Ptr getIndexBuffer();
+
+        /**
+         * @brief Get the size of a vertex, in bytes.
+         */
+        uint32_t getVertexStride() const { return m_vertexStride; }
+
+        GeometryPool(const GeometryPool&)  = delete;
+        GeometryPool(const GeometryPool&&) = delete;
+
+    private:
+        explicit GeometryPool(uint32_t vertexStride)
+            : m_vertexStride(vertexStride)
+        { }
+
+        /**
+         * @brief Make sure a buffer has room for `size` bytes, replacing it with a larger one if it doesn't.
+         *
+         * @param buffer The buffer to grow
+         * @param used The number of bytes in use, to copy to a new buffer
+         * @param size The number of bytes needed
+         * @param usage The usage of the buffer, besides transfers
+         */
+        static void
+        reserve(Buffer::Ptr& buffer, VkDeviceSize used, VkDeviceSize size, vk::BufferUsageFlags usage);
+
+        /**
+         * @brief Copy data into a device-local buffer through a staging buffer.
+         */
+        static void
+        upload(const Buffer::Ptr& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+        /**
+         * @brief Copy indices into a gap in the index buffer, or append them. The mutex must be held.
+         */
+        uint32_t appendIndices(const std::vector<uint32_t>& indices);
+
+        uint32_t m_vertexStride;
+        uint32_t m_vertexCount = 0u; ///< Vertices up to the last one in use
+        uint32_t m_indexCount  = 0u; ///< Indices up to the last one in use
+
+        std::map<uint32_t, uint32_t> m_freeVertices;              ///< Gaps below `m_vertexCount`, by offset
+        std::map<uint32_t, uint32_t> m_freeIndices;               ///< Gaps below `m_indexCount`, by offset
+        std::unordered_map<int32_t, uint32_t> m_vertexBlockSizes; ///< Vertex count of every `add()`
+
+        Buffer::Ptr m_vertexBuffer = {};
+        Buffer::Ptr m_indexBuffer  = {};
+
+        std::mutex m_mutex;
+    };
+} // namespace ivulk
@@ -0,0 +1,162 @@
+/**
+ * @file gpu_culler.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `GpuCuller` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+
+#include <ivulk/core/buffer.hpp>
+#include <ivulk/core/compute_pipeline.hpp>
+#include <ivulk/core/image.hpp>
+#include <ivulk/core/sampler.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <ivulk/vk.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief An instance tested by `GpuCuller`, matching the `shaders/cull/cull.comp` shader.
+     */
+    struct GpuCullInstance final
+    {
+        glm::mat4 modelMatrix = glm::mat4(1);           ///< Model matrix, written to the output if visible
+        glm::vec4 sphere      = glm::vec4(0, 0, 0, -1); ///< Local bounding sphere, see `BoundingSphere`
+        uint32_t command      = 0u;                     ///< Index of the indirect command drawing it
+        uint32_t padding[3]   = {};
+    };
+
+    /**
+     * @brief The buffers of a single culling dispatch.
+     */
+    struct GpuCullPass final
+    {
+        glm::mat4 viewProjection = glm::mat4(1); ///< View-projection matrix of the frame being drawn
+        Buffer::Ptr instances    = {};           ///< Array of `GpuCullInstance`, with storage usage
+        uint32_t instanceCount   = 0u;           ///< Number of instances in `instances`
+
+        /**
+         * @brief Array of `VkDrawIndexedIndirectCommand`, with storage usage.
+         *
+         * Each command's `instanceCount` must start at zero; it's incremented for every visible instance.
+         */
+        Buffer::Ptr commands = {};
+
+        /**
+         * @brief Array of model matrices, with storage usage.
+         *
+         * The matrices of each command's visible instances are written from its `firstInstance`, so every
+         * command needs room for all of its instances.
+         */
+        Buffer::Ptr output = {};
+    };
+
+    /**
+     * @brief Culls instanced indirect draws on the GPU, against the view frustum and the previous frame's
+     *        depth.
+     *
+     * A compute dispatch tests every instance's bounding sphere, and appends the model matrices of visible
+     * instances to their indirect command, so culled instances cost neither CPU time nor vertex work.
+     *
+     * After a frame is drawn, pass its depth buffer to `setDepth`. The next `record` reduces it into a
+     * depth pyramid, where each level holds the farthest depth of every 2x2 texels of the level above, and
+     * tests instances that pass the frustum test against it: an instance is hidden if its nearest point is
+     * behind everything drawn over its screen bounds last frame. Instances that were off screen or
+     * crossed the near plane last frame are never hidden. Until a depth buffer is given, only the frustum
+     * is tested.
+     *
+     * Occlusion is tested against the previous frame, so objects that are uncovered suddenly can show up a
+     * frame late.
+     */
+    class GpuCuller : public VulkanResource<GpuCuller,
+                                            NullResourceInfo,
+                                            ComputePipeline::Ptr,
+                                            ComputePipeline::Ptr,
+                                            Sampler::Ptr>
+    {
+    public:
+        static constexpr uint32_t GroupSize        = 64u; ///< Instances culled by each workgroup
+        static constexpr uint32_t PyramidGroupSize = 8u;  ///< Depth pyramid workgroup size along each axis
+        static constexpr uint32_t MaxPyramidLevels = 16u; ///< Maximum number of depth pyramid levels
+
+        /**
+         * @brief Set the depth buffer of the frame just drawn, to test occlusion against in the next
+         *        `record`.
+         *
+         * The image must have `VK_IMAGE_USAGE_SAMPLED_BIT` usage, and be in
+         * `VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL`, as render passes leave it. Building the
+         * pyramid moves it to `VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL`. The render pass must store
+         * its depth attachment.
+         *
+         * @param depth The depth buffer
+         * @param viewProjection The view-projection matrix the frame was drawn with
+         */
+        void setDepth(Image::Ref depth, const glm::mat4& viewProjection);
+
+        /**
+         * @brief Forget the depth buffer, e.g. when the view jumps, so nothing is hidden by stale depth.
+         */
+        void resetDepth();
+
+        /**
+         * @brief Record culling into a command buffer, outside a render pass.
+         *
+         * Builds the depth pyramid from the depth buffer given to `setDepth` first, if it hasn't been built
+         * yet. The commands and output matrices are ready for indirect draws and vertex input afterwards.
+         * Descriptors are kept for one frame in flight.
+         */
+        void record(VkCommandBuffer cb, const GpuCullPass& pass);
+
+    private:
+        friend base_t;
+
+        /**
+         * @brief Descriptors and parameters of one frame in flight
+         */
+        struct Frame
+        {
+            VkDescriptorPool pool = VK_NULL_HANDLE;
+            Buffer::Ptr params    = {};
+        };
+
+        GpuCuller(VkDevice device,
+                  ComputePipeline::Ptr cull,
+                  ComputePipeline::Ptr pyramid,
+                  Sampler::Ptr sampler);
+
+        static GpuCuller* createImpl(VkDevice device, NullResourceInfo info);
+
+        void destroyImpl();
+
+        VkDescriptorSet allocateSet(VkDescriptorPool pool, const ComputePipeline::Ptr& pipeline);
+
+        /**
+         * @brief Make sure the pyramid matches a depth buffer's extent, recreating it if it doesn't.
+         */
+        void reservePyramid(VkCommandBuffer cb, VkExtent2D depthExtent);
+        void destroyPyramidViews();
+        void recordPyramid(VkCommandBuffer cb, VkDescriptorPool pool, const Image::Ptr& depth);
+
+        std::vector<Frame> m_frames;
+        std::size_t m_frame = 0u;
+
+        Image::Ref m_depth              = {};
+        glm::mat4 m_depthViewProjection = glm::mat4(1);
+        bool m_bDepthPending            = false; ///< `m_depth` hasn't been reduced into the pyramid yet
+        bool m_bPyramidValid            = false; ///< The pyramid holds a depth buffer
+
+        Image::Ptr m_pyramid       = {};
+        VkExtent2D m_pyramidExtent = {};       ///< Extent of the first pyramid level
+        VkExtent2D m_depthExtent   = {};       ///< Extent of the depth buffer the pyramid was made for
+        std::vector<VkImageView> m_levelViews; ///< A view of each pyramid level
+    };
+} // namespace ivulk
@@ -0,0 +1,94 @@
+/**
+ * @file ibl.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `IBLEnvironment` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/image.hpp>
+#include <ivulk/core/vulkan_resource.hpp>
+
+#include <boost/filesystem.hpp>
+
+namespace ivulk {
+    /**
+     * @brief Information for initializing an IBLEnvironment resource
+     */
+    struct IBLInfo final
+    {
+        boost::filesystem::path hdriPath; ///< Equirectangular HDR image to bake from (relative to the assets dir)
+
+        uint32_t environmentSize = 512u; ///< Face size of the environment cube map (also used for skyboxes)
+        uint32_t irradianceSize  = 32u;  ///< Face size of the diffuse irradiance cube map
+        uint32_t prefilterSize   = 256u; ///< Face size of the first mip of the prefiltered specular cube map
+        uint32_t prefilterMips   = 6u;   ///< Number of roughness levels in the prefiltered specular cube map
+        uint32_t brdfLutSize     = 256u; ///< Size of the BRDF integration lookup table
+        uint32_t sampleCount     = 1024u; ///< Importance samples per texel for the specular and BRDF bakes
+
+        bool bUseCache = true; ///< If true (default), load from and save to the app's cache directory
+    };
+
+    /**
+     * @brief Precomputed image-based lighting data for an HDR environment.
+     *
+     * On creation the equirectangular source is converted to a cube map, and diffuse irradiance, a
+     * prefiltered specular mip chain and a BRDF integration lookup table are baked with compute shaders.
+     * The results are written to `App::getCacheDir()`, keyed by a hash of the source file, the bake shaders
+     * and the bake settings, so subsequent runs load them from disk instead of baking again.
+     *
+     * Use the `lib/lighting/ibl.glsl.jinja` shader library to sample the baked maps.
+     */
+    class IBLEnvironment
+        : public VulkanResource<IBLEnvironment, IBLInfo, Image::Ptr, Image::Ptr, Image::Ptr, Image::Ptr>
+    {
+    public:
+        /**
+         * @brief Get the environment cube map.
+         */
+        Image::Ptr getEnvironment() { return getHandleAt<0>(); }
+
+        /**
+         * @brief Get the diffuse irradiance cube map.
+         */
+        Image::Ptr getIrradiance() { return getHandleAt<1>(); }
+
+        /**
+         * @brief Get the prefiltered specular cube map. Mip level `i` corresponds to roughness
+         *        `i / (mipLevels - 1)`.
+         */
+        Image::Ptr getPrefiltered() { return getHandleAt<2>(); }
+
+        /**
+         * @brief Get the BRDF integration lookup table (scale in red, bias in green).
+         */
+        Image::Ptr getBrdfLut() { return getHandleAt<3>(); }
+
+        /**
+         * @brief Check whether the data was loaded from the disk cache rather than baked.
+         */
+        bool wasLoadedFromCache() const { return m_bFromCache; }
+
+    private:
+        friend base_t;
+
+        bool m_bFromCache = false;
+
+        IBLEnvironment(VkDevice device,
+                       Image::Ptr environment,
+                       Image::Ptr irradiance,
+                       Image::Ptr prefiltered,
+                       Image::Ptr brdfLut);
+
+        static IBLEnvironment* createImpl(VkDevice device, IBLInfo info);
+
+        void destroyImpl();
+
+        void bake(VkDevice device, const IBLInfo& info);
+        bool loadCache(VkDevice device, const boost::filesystem::path& p, uint64_t key);
+        void saveCache(VkDevice device, const boost::filesystem::path& p, uint64_t key);
+    };
+} // namespace ivulk
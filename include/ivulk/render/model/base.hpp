@@ -12,14 +12,18 @@
 #include <boost/filesystem.hpp>
 #include <ivulk/core/buffer.hpp>
 #include <ivulk/core/command_buffer.hpp>
+#include <ivulk/render/render_queue.hpp>
 #include <ivulk/render/renderable.hpp>
 #include <ivulk/render/standard_shader.hpp>
 
 #include <ivulk/utils/fs.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace ivulk {
 
@@ -59,13 +63,70 @@ namespace ivulk {
                         c->bindPipeline(pipeline);
                         c->pushConstants(&matrices, layout, sizeof(MatricesPushConstants), {});
                     }
-                    Buffer::Ref vBuf = m->getVertexBuffer();
-                    Buffer::Ref iBuf = m->getIndexBuffer();
-                    c->draw({.vertexBuffer = vBuf, .indexBuffer = iBuf});
+                    Buffer::Ref vBuf    = m->getVertexBuffer();
+                    Buffer::Ref iBuf    = m->getIndexBuffer();
+                    GeometryRange range = m->getGeometryRange();
+                    c->draw({
+                        .vertexBuffer = vBuf,
+                        .indexBuffer  = iBuf,
+                        .indices      = range.indexCount,
+                        .firstIndex   = range.firstIndex,
+                        .vertexOffset = range.vertexOffset,
+                    });
                 }
             }
         }
 
+        virtual void enqueue(RenderQueue& queue, const DrawContext& context) override
+        {
+            for (const auto& m : meshes)
+            {
+                queue.addMesh(context,
+                              m->getPipelineIndex(),
+                              m->getVertexBuffer(),
+                              m->getIndexBuffer(),
+                              m->getGeometryRange(context.lod),
+                              m->getBoundingSphere());
+            }
+        }
+
+        /**
+         * @brief Get a box around every mesh of the model.
+         */
+        virtual BoundingBox getBoundingBox() const override { return m_box; }
+
+        /**
+         * @brief Get a sphere around every mesh of the model.
+         */
+        virtual BoundingSphere getBoundingSphere() const override { return m_sphere; }
+
+        /**
+         * @brief Pick the coarsest level of detail whose simplification error stays under
+         *        `LodPixelError` pixels on screen.
+         *
+         * Switching to a coarser level waits until the model is `LodHysteresis` smaller than the level's
+         * threshold, and switching back until it is that much larger, so models near a threshold don't
+         * flicker between levels.
+         */
+        virtual uint32_t selectLod(float screenSize, uint32_t currentLod) const override
+        {
+            const auto count = static_cast<uint32_t>(m_lodScreenSizes.size());
+            if (count < 2u)
+                return 0u;
+
+            uint32_t lod = std::min(currentLod, count - 1u);
+            while (lod + 1u < count && screenSize < m_lodScreenSizes[lod + 1u] * (1.0f - LodHysteresis))
+                ++lod;
+            while (lod > 0u && screenSize > m_lodScreenSizes[lod] * (1.0f + LodHysteresis))
+                --lod;
+            return lod;
+        }
+
+        /**
+         * @brief Get the number of levels of detail, including the full model.
+         */
+        uint32_t getLodCount() const { return std::max<uint32_t>(1u, m_lodScreenSizes.size()); }
+
         static Ptr load(const boost::filesystem::path& p)
         {
             static_assert(
@@ -81,10 +142,72 @@ namespace ivulk {
                     utils::makeErrorMessage("FILE", "Invalid or missing model file path"));
             }
 
-            return Ptr(Derived::loadImpl(*loadPath));
+            auto model = Ptr(Derived::loadImpl(*loadPath));
+            model->updateBounds();
+            model->updateLods();
+            return model;
         }
 
+        static constexpr float LodPixelError   = 1.0f;    ///< Largest error of a level of detail, in pixels
+        static constexpr float LodScreenHeight = 1080.0f; ///< Screen height the pixel error is measured at
+        static constexpr float LodHysteresis   = 0.1f;    ///< Margin around thresholds before switching
+
     protected:
         std::vector<mesh_ptr_t> meshes;
+
+    private:
+        /**
+         * @brief Combine the bounds of the meshes into the model's
+         */
+        void updateBounds()
+        {
+            m_box = {};
+            for (const auto& m : meshes)
+                m_box.expand(m->getBoundingBox());
+
+            m_sphere = {};
+            if (!m_box.isValid())
+                return;
+            m_sphere = {.center = m_box.getCenter(), .radius = 0.0f};
+            for (const auto& m : meshes)
+            {
+                const auto sphere = m->getBoundingSphere();
+                m_sphere.radius   = std::max(m_sphere.radius,
+                                           glm::distance(m_sphere.center, sphere.center) + sphere.radius);
+            }
+        }
+
+        /**
+         * @brief Find the screen size below which each level of detail is fine enough
+         */
+        void updateLods()
+        {
+            uint32_t count = 0u;
+            for (const auto& m : meshes)
+                count = std::max(count, m->getLodCount());
+
+            // An error of e on a sphere of radius r covering a fraction s of the screen's height spans
+            // e * s * height / (2r) pixels, so a level is fine enough below s = 2r * pixels / (e * height).
+            // Meshes with fewer levels draw their coarsest, so their error counts for every level past it
+            m_lodScreenSizes.assign(count, std::numeric_limits<float>::max());
+            for (uint32_t lod = 1u; lod < count; ++lod)
+            {
+                float threshold = m_lodScreenSizes[lod - 1u];
+                for (const auto& m : meshes)
+                {
+                    const float error = m->getLodError(lod);
+                    if (error > 0.0f)
+                    {
+                        threshold = std::min(threshold,
+                                             2.0f * m_sphere.radius * LodPixelError / (error * LodScreenHeight));
+                    }
+                }
+                m_lodScreenSizes[lod] = threshold;
+            }
+        }
+
+        BoundingBox m_box;
+        BoundingSphere m_sphere;
+        std::vector<float> m_lodScreenSizes; ///< Screen size under which each level of detail is used
     };
 } // namespace ivulk
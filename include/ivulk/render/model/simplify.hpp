@@ -0,0 +1,48 @@
+/**
+ * @file simplify.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief Mesh simplification for levels of detail.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief The result of `simplifyMesh`.
+     */
+    struct SimplifiedMesh final
+    {
+        std::vector<uint32_t> indices = {};   ///< Triangles of the simplified mesh, into the same vertices
+        float error                   = 0.0f; ///< Estimated distance from the original surface
+    };
+
+    /**
+     * @brief Reduce the triangles of a mesh by collapsing edges, without adding or moving vertices.
+     *
+     * Edges are collapsed onto one of their vertices, cheapest first, where the cost is the quadric error:
+     * the mean squared distance of the kept vertex to the planes of the triangles merged into it.
+     * Collapses that would flip a triangle are skipped. Vertices on open borders and on seams, where
+     * vertices share a position but not their other attributes, are never moved, so the simplified mesh
+     * keeps its outline and doesn't tear along seams.
+     *
+     * Since vertices are only dropped, the result indexes the original vertex buffer, so every level of
+     * detail of a mesh can share it.
+     *
+     * @param positions The position of each vertex
+     * @param indices The triangles to simplify, three indices per triangle
+     * @param targetIndexCount The number of indices to aim for. Simplification may stop short of it if no
+     *                         more edges can be collapsed.
+     */
+    SimplifiedMesh simplifyMesh(const std::vector<glm::vec3>& positions,
+                                const std::vector<uint32_t>& indices,
+                                std::size_t targetIndexCount);
+} // namespace ivulk
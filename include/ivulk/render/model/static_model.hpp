@@ -13,7 +13,10 @@
 
 #include <assimp/scene.h>
 
+#include <ivulk/render/bounds.hpp>
+#include <ivulk/render/geometry_pool.hpp>
 #include <ivulk/render/model/base.hpp>
+#include <ivulk/render/model/simplify.hpp>
 
 namespace ivulk {
 
@@ -35,19 +38,89 @@ namespace ivulk {
         using vertex_t = StaticMeshVertex;
 
         StaticMesh() = delete;
-
-        static Ptr create(const std::vector<vertex_t>& vertices, const std::vector<uint32_t>& indices, uint32_t pipelineIndex);
+        ~StaticMesh();
+
+        /**
+         * @brief Upload a mesh to the shared `GeometryPool`.
+         *
+         * The mesh's space in the pool is freed when the mesh is destroyed.
+         *
+         * @param vertices The vertices, shared by every level of detail
+         * @param indices The full resolution triangles
+         * @param pipelineIndex Index of the mesh's pipeline
+         * @param box Box around the vertices
+         * @param sphere Sphere around the vertices
+         * @param lods Simplified triangles of the same vertices, from the finest to the coarsest
+         */
+        static Ptr create(const std::vector<vertex_t>& vertices,
+                          const std::vector<uint32_t>& indices,
+                          uint32_t pipelineIndex,
+                          BoundingBox box,
+                          BoundingSphere sphere,
+                          const std::vector<SimplifiedMesh>& lods = {});
 
         uint32_t getPipelineIndex() const;
 
-        Buffer::Ref getIndexBuffer() const { return m_indexBuffer; }
-        Buffer::Ref getVertexBuffer() const { return m_vertexBuffer; }
+        /**
+         * @brief Get the index buffer of the mesh's `GeometryPool`, shared with other meshes.
+         */
+        Buffer::Ref getIndexBuffer() const { return m_pool->getIndexBuffer(); }
+
+        /**
+         * @brief Get the vertex buffer of the mesh's `GeometryPool`, shared with other meshes.
+         */
+        Buffer::Ref getVertexBuffer() const { return m_pool->getVertexBuffer(); }
+
+        /**
+         * @brief Get the location of a level of detail of the mesh in its pool's buffers.
+         *
+         * @param lod The level of detail, 0 being the full mesh. Clamped to the coarsest level.
+         */
+        GeometryRange getGeometryRange(uint32_t lod = 0u) const
+        {
+            return m_lods[std::min<std::size_t>(lod, m_lods.size() - 1u)].range;
+        }
+
+        /**
+         * @brief Get the number of levels of detail, including the full mesh.
+         */
+        uint32_t getLodCount() const { return static_cast<uint32_t>(m_lods.size()); }
+
+        /**
+         * @brief Get how far a level of detail strays from the full mesh, in model space.
+         */
+        float getLodError(uint32_t lod) const
+        {
+            return m_lods[std::min<std::size_t>(lod, m_lods.size() - 1u)].error;
+        }
+
+        /**
+         * @brief Get a box around the mesh's vertices, in model space.
+         */
+        BoundingBox getBoundingBox() const { return m_box; }
+
+        /**
+         * @brief Get a sphere around the mesh's vertices, in model space.
+         */
+        BoundingSphere getBoundingSphere() const { return m_sphere; }
 
     private:
-        StaticMesh(Buffer::Ptr vBuf, Buffer::Ptr iBuf, uint32_t pipelineIndex);
-
-        Buffer::Ptr m_vertexBuffer;
-        Buffer::Ptr m_indexBuffer;
+        struct Lod
+        {
+            GeometryRange range = {};
+            float error         = 0.0f;
+        };
+
+        StaticMesh(GeometryPool::Ptr pool,
+                   std::vector<Lod> lods,
+                   BoundingBox box,
+                   BoundingSphere sphere,
+                   uint32_t pipelineIndex);
+
+        GeometryPool::Ptr m_pool;
+        std::vector<Lod> m_lods; ///< Levels of detail, the full mesh first
+        BoundingBox m_box;
+        BoundingSphere m_sphere;
         uint32_t m_pipelineIndex;
     };
 
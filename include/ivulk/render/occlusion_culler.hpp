@@ -0,0 +1,144 @@
+/**
+ * @file occlusion_culler.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `OcclusionCuller` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+#include <ivulk/render/bounds.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ivulk {
+    /**
+     * @brief A triangle mesh kept on the CPU, rasterized by `OcclusionCuller`.
+     *
+     * Occluders should be simple, e.g. the walls of a building rather than its detailed model, and lie
+     * inside the objects they stand for, so they never hide anything those objects wouldn't.
+     */
+    struct OccluderMesh final
+    {
+        using Ptr = std::shared_ptr<OccluderMesh>;
+
+        std::vector<glm::vec3> positions = {}; ///< Vertex positions, in model space
+        std::vector<uint32_t> indices    = {}; ///< Three indices per triangle
+
+        /**
+         * @brief Make a mesh of the six sides of a box.
+         */
+        static Ptr fromBox(const BoundingBox& box);
+    };
+
+    /**
+     * @brief Culls objects hidden behind occluders, with a depth buffer rasterized on the CPU.
+     *
+     * Every `render` rasterizes the occluders into a small depth buffer, 4 pixels at a time with SSE where
+     * available. Only pixels an occluder covers fully are written, with the farthest depth over the pixel,
+     * so occluders never hide more than they cover. The depth buffer is then reduced into a hierarchical
+     * depth buffer, where each level holds the farthest depth of every 2x2 texels of the level above.
+     * `isOccluded` then checks a box's nearest depth against a few texels of the level its screen bounds
+     * fit in.
+     *
+     * Everything runs on the CPU, so the result is ready before the frame's draws are collected, and
+     * needs no GPU.
+     */
+    class OcclusionCuller final
+    {
+    public:
+        using Ptr = std::shared_ptr<OcclusionCuller>;
+        using Ref = std::weak_ptr<OcclusionCuller>;
+
+        /**
+         * @brief Create an occlusion culler.
+         *
+         * @param width Width of the depth buffer, rounded up to a multiple of 4
+         * @param height Height of the depth buffer
+         */
+        static Ptr create(uint32_t width = 256u, uint32_t height = 128u)
+        {
+            return Ptr(new OcclusionCuller(width, height));
+        }
+
+        /**
+         * @brief Add an occluder.
+         *
+         * The mesh's triangles are linked to their neighbors here, so its indices must not change while
+         * it's in use.
+         *
+         * @param mesh The occluder's triangles
+         * @param modelMatrix Places the mesh in the space `render`'s view-projection expects
+         * @return An ID to move or remove the occluder with
+         */
+        uint32_t addOccluder(OccluderMesh::Ptr mesh, const glm::mat4& modelMatrix = glm::mat4(1));
+
+        /**
+         * @brief Move an occluder.
+         */
+        void setOccluderTransform(uint32_t occluder, const glm::mat4& modelMatrix);
+
+        /**
+         * @brief Remove an occluder. Its ID may be reused.
+         */
+        void removeOccluder(uint32_t occluder);
+
+        /**
+         * @brief Rasterize every occluder from a view, and build the hierarchical depth buffer.
+         */
+        void render(const glm::mat4& viewProjection);
+
+        /**
+         * @brief Check whether a box is entirely hidden behind the occluders of the last `render`.
+         *
+         * Boxes crossing the near plane or leaving the screen are never hidden. Boxes outside the view
+         * aren't hidden either; cull them against the frustum first.
+         */
+        bool isOccluded(const BoundingBox& box) const;
+
+        uint32_t getWidth() const { return m_width; }
+        uint32_t getHeight() const { return m_height; }
+
+        /**
+         * @brief Get the depth buffer of the last `render`, row by row, far depths being 1.
+         */
+        const float* getDepth() const { return m_depth.data(); }
+
+    private:
+        struct Occluder
+        {
+            OccluderMesh::Ptr mesh       = {};
+            glm::mat4 modelMatrix        = glm::mat4(1);
+            std::vector<uint32_t> across = {}; ///< Per triangle edge, far vertex of the triangle beyond
+        };
+
+        struct Level
+        {
+            uint32_t width     = 0u;
+            uint32_t height    = 0u;
+            std::size_t offset = 0u; ///< Offset of the level in `m_depth`
+        };
+
+        OcclusionCuller(uint32_t width, uint32_t height);
+
+        void rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, uint32_t outerEdges);
+        void buildHierarchy();
+
+        uint32_t m_width;
+        uint32_t m_height;
+        std::vector<Level> m_levels;
+        std::vector<float> m_depth; ///< Every level, the full resolution depth buffer first
+
+        std::vector<Occluder> m_occluders;
+        std::vector<uint32_t> m_freeOccluders;
+        std::vector<glm::vec3> m_screen; ///< Scratch for the screen positions of an occluder's vertices
+        std::vector<uint8_t> m_clipped;  ///< Scratch, set for vertices behind the near plane
+
+        glm::mat4 m_viewProjection = glm::mat4(1);
+    };
+} // namespace ivulk
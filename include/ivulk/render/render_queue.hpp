@@ -0,0 +1,319 @@
+/**
+ * @file render_queue.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `RenderQueue` class and related.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/glm.hpp>
+#include <ivulk/render/priorities.hpp>
+#include <ivulk/render/standard_shader.hpp>
+
+#include <ivulk/core/buffer.hpp>
+#include <ivulk/core/command_buffer.hpp>
+#include <ivulk/core/command_pool.hpp>
+#include <ivulk/core/descriptor_set.hpp>
+#include <ivulk/core/graphics_pipeline.hpp>
+#include <ivulk/render/bounds.hpp>
+#include <ivulk/render/geometry_pool.hpp>
+#include <ivulk/render/gpu_culler.hpp>
+#include <ivulk/utils/thread_pool.hpp>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+    class I_Renderable;
+
+    /**
+     * @brief Draw state passed down while renderables add themselves to a `RenderQueue`.
+     */
+    struct DrawContext final
+    {
+        glm::mat4 modelMatrix                        = glm::mat4(1); ///< Model matrix to draw with
+        std::vector<GraphicsPipeline::Ref> pipelines = {};           ///< Pipelines, by mesh pipeline index
+        std::optional<BindlessMaterial> material     = {};           ///< Bindless material indices to push
+        DescriptorSet::Ptr materialSet               = {};           ///< Shared set overriding the pipelines'
+        uint32_t lod                                 = 0u;           ///< Level of detail to draw meshes at
+        int16_t priority = E_RenderPriority::Normal;                 ///< Layer (see `E_RenderPriority`)
+    };
+
+    /**
+     * @brief A single draw in a `RenderQueue`.
+     *
+     * Draws a vertex buffer and optional index buffer with `pipeline`, unless `renderable` is set, in which
+     * case the renderable records its own commands through `I_Renderable::render`.
+     */
+    struct DrawPacket final
+    {
+        uint64_t sortKey = 0u; ///< Submission order, see `RenderQueue::makeSortKey`
+
+        GraphicsPipeline::Ptr pipeline           = {};           ///< Pipeline to bind, if any
+        DescriptorSet::Ptr materialSet           = {};           ///< Shared set overriding the pipeline's own
+        std::optional<BindlessMaterial> material = {};           ///< Bindless material indices to push
+        glm::mat4 modelMatrix                    = glm::mat4(1); ///< Model matrix to push
+        Buffer::Ref vertexBuffer                 = {};           ///< Vertex buffer to draw
+        Buffer::Ref indexBuffer                  = {};           ///< Index buffer to draw, if any
+        GeometryRange geometry                   = {};           ///< Range to draw, or all if empty
+        BoundingSphere bounds                    = {};           ///< Local bounds to cull with, if known
+
+        std::shared_ptr<I_Renderable> renderable     = {}; ///< Renderable that records itself instead
+        std::vector<GraphicsPipeline::Ref> pipelines = {}; ///< Pipelines passed to `renderable`
+    };
+
+    /**
+     * @brief How a `RenderQueue` records its draws across threads, see `RenderQueue::setParallelRecording`.
+     */
+    struct ParallelRecordInfo final
+    {
+        uint32_t threadCount        = 0u; ///< Threads to split the draws across, or 0 to record inline
+        vk::RenderPass renderPass   = {}; ///< The render pass the draws are recorded in, required
+        uint32_t subpass            = 0u; ///< The subpass of `renderPass` the draws are recorded in
+        vk::Framebuffer framebuffer = {}; ///< The framebuffer `renderPass` renders to, if known
+    };
+
+    /**
+     * @brief Collects draws into a flat array with 64-bit sort keys, and records them in key order.
+     *
+     * Keys are radix sorted, so draws are grouped by layer first, then by pipeline, material and mesh, to
+     * keep state changes to a minimum. Within the transparent layers, draws are sorted back to front
+     * instead. Consecutive draws with the same pipeline or material don't rebind it.
+     *
+     * Consecutive draws of the same mesh with the same instanced pipeline (see
+     * `GraphicsPipelineInfo::instance`) and material are merged into one instanced draw. Their model
+     * matrices are written to an instance buffer, one per frame in flight, in place of the push constant.
+     *
+     * If the device supports `drawIndirectFirstInstance`, consecutive instanced draws of different meshes
+     * from the same buffers, e.g. meshes in the same `GeometryPool`, are merged further: a
+     * `VkDrawIndexedIndirectCommand` is written for each mesh, and the whole run is recorded as a single
+     * indirect draw.
+     *
+     * Indirect draws can be culled on the GPU before they're recorded, see `cull`. Recording can be split
+     * across worker threads, see `setParallelRecording`.
+     *
+     * The queue is meant to be cleared and refilled every frame; it keeps its storage between frames.
+     */
+    class RenderQueue final
+    {
+    public:
+        /**
+         * @brief Build a sort key.
+         *
+         * From the most significant bits down:
+         * - Opaque layers: priority (16 bits), pipeline (12), material (12), mesh (12), depth front to back
+         *   (12).
+         * - Layers from `E_RenderPriority::Transparent` up to `E_RenderPriority::Normal`: priority (16),
+         *   depth back to front (24), pipeline (12), material (12).
+         *
+         * Lower priorities are drawn first. IDs are truncated to their field, so beyond 4096 distinct
+         * pipelines, materials or meshes a frame, some of them are no longer grouped together.
+         *
+         * @param priority The layer (see `E_RenderPriority`)
+         * @param pipeline Small ID of the pipeline
+         * @param material Small ID of the material
+         * @param mesh Small ID of the mesh
+         * @param depth Non-negative distance from the viewer
+         */
+        static uint64_t
+        makeSortKey(int16_t priority, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth);
+
+        /**
+         * @brief Remove every draw. Storage is kept for the next frame.
+         */
+        void clear();
+
+        /**
+         * @brief Set the position draws are sorted by depth from.
+         */
+        void setViewPosition(glm::vec3 position) { m_viewPosition = position; }
+
+        /**
+         * @brief Set the view-projection matrix draws are culled against.
+         */
+        void setViewProjection(const glm::mat4& viewProjection)
+        {
+            m_viewProjection  = viewProjection;
+            m_bViewProjection = true;
+        }
+
+        /**
+         * @brief Record draws on worker threads, into secondary command buffers.
+         *
+         * `record` then splits the sorted batches into runs of consecutive batches, one per thread, and
+         * records each run into a secondary command buffer allocated from a command pool of its own. The
+         * calling thread records the first run, and the others run on worker threads owned by the queue,
+         * so recording never waits behind shader compiles on `AppState::workers`. Once every run is
+         * recorded, they are executed in order, so draws keep their sorted order.
+         *
+         * The render pass must be begun with `VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS`, and
+         * renderables drawn through `I_Renderable::render` are rendered on the worker threads too.
+         *
+         * @throws std::runtime_error If `info.threadCount` is set without `info.renderPass`
+         */
+        void setParallelRecording(const ParallelRecordInfo& info);
+
+        /**
+         * @brief Get the height of a sphere on screen, as a fraction of the viewport's height.
+         *
+         * Used to pick levels of detail. Spheres crossing the near plane, unbounded spheres, and every
+         * sphere before `setViewProjection` is called, are as large as possible.
+         *
+         * @param sphere The sphere, in world space
+         */
+        float getScreenSize(const BoundingSphere& sphere) const;
+
+        /**
+         * @brief Add a draw of a mesh.
+         *
+         * @param context The draw state. The mesh is drawn at the origin of `context.modelMatrix`.
+         * @param pipelineIndex Index of the mesh's pipeline in `context.pipelines`
+         * @param vertexBuffer The vertex buffer to draw
+         * @param indexBuffer The index buffer to draw, if any
+         * @param geometry The range of the buffers to draw, for meshes in a `GeometryPool`. Leave empty
+         *                 to draw the whole buffers.
+         * @param bounds The bounds of the mesh, before `context.modelMatrix`. Leave empty to never cull it.
+         */
+        void addMesh(const DrawContext& context,
+                     uint32_t pipelineIndex,
+                     Buffer::Ref vertexBuffer,
+                     Buffer::Ref indexBuffer = {},
+                     GeometryRange geometry  = {},
+                     BoundingSphere bounds   = {});
+
+        /**
+         * @brief Add a renderable that records its own commands.
+         *
+         * Used for renderables that don't break down into meshes. The renderable is sorted by its layer
+         * and position only.
+         */
+        void addRenderable(std::shared_ptr<I_Renderable> renderable, const DrawContext& context);
+
+        /**
+         * @brief Sort the draws by their keys.
+         */
+        void sort();
+
+        /**
+         * @brief Build this frame's draws, and record culling of the indirect draws with a `GpuCuller`.
+         *
+         * Call after `sort` and before `record`, outside a render pass. Each instance of an indirect draw
+         * is tested against the frustum of `setViewProjection` and the culler's depth, and only visible
+         * instances are drawn. Other draws are recorded as usual. Without `drawIndirectFirstInstance`,
+         * nothing is culled.
+         */
+        void cull(VkCommandBuffer cb, GpuCuller& culler);
+
+        /**
+         * @brief Record every draw, in sorted order.
+         *
+         * Uses the draws built by `cull`, if it was called since the last `record`.
+         */
+        void record(std::weak_ptr<CommandBuffers> cmdBufs);
+
+        /**
+         * @brief Get the number of draws in the queue.
+         */
+        std::size_t size() const { return m_packets.size(); }
+
+    private:
+        struct SortEntry
+        {
+            uint64_t key;
+            uint32_t index; ///< Index into `m_packets`
+        };
+
+        /**
+         * @brief Consecutive sorted draws recorded as one draw
+         */
+        struct DrawBatch
+        {
+            uint32_t begin         = 0u;    ///< Index of the first draw in `m_order`
+            uint32_t count         = 1u;    ///< Number of draws, drawn as instances if `bInstanced`
+            uint32_t firstInstance = 0u;    ///< Index of the first draw's model matrix in `m_instances`
+            uint32_t firstCommand  = 0u;    ///< Index of the first command in `m_indirectCommands`
+            uint32_t commandCount  = 0u;    ///< Number of indirect commands, if `bIndirect`
+            bool bInstanced        = false; ///< The draws use an instanced pipeline
+            bool bIndirect         = false; ///< The draws are recorded as one indirect draw
+        };
+
+        uint32_t getSortId(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t key);
+        float getDepth(const glm::mat4& modelMatrix) const;
+        void buildBatches(bool bIndirect);
+        void addInstance(DrawBatch& batch, const DrawPacket& packet);
+
+        /**
+         * @brief Record `m_batches[begin, end)` into the current command buffer of `cb`.
+         */
+        void recordBatches(const CommandBuffers::Ptr& cb, std::size_t begin, std::size_t end) const;
+
+        /**
+         * @brief Record the batches into secondary command buffers on several threads, and execute them.
+         */
+        void recordParallel(CommandBuffers& cb);
+
+        /**
+         * @brief Advance to the next frame in flight, build the batches and upload their buffers.
+         */
+        void prepare(bool bCull);
+
+        /**
+         * @brief Copy data to this frame's buffer in `buffers`, growing it if needed.
+         */
+        Buffer::Ptr uploadFrameBuffer(std::vector<Buffer::Ptr>& buffers,
+                                      const void* data,
+                                      VkDeviceSize size,
+                                      vk::BufferUsageFlags usage);
+
+        std::vector<DrawPacket> m_packets;
+        std::vector<SortEntry> m_order;
+        std::vector<SortEntry> m_scratch;
+        std::vector<DrawBatch> m_batches;
+
+        std::vector<glm::mat4> m_instances;
+        std::vector<VkDrawIndexedIndirectCommand> m_indirectCommands;
+        std::vector<GpuCullInstance> m_cullInstances;
+        GeometryRange m_lastGeometry = {}; ///< Geometry of the last indirect command
+
+        std::vector<Buffer::Ptr> m_instanceBuffers; ///< Instance buffer of each frame in flight
+        std::vector<Buffer::Ptr> m_indirectBuffers; ///< Indirect command buffer of each frame in flight
+        std::vector<Buffer::Ptr> m_cullBuffers;     ///< Cull instance buffer of each frame in flight
+        Buffer::Ptr m_instanceBuffer = {};          ///< This frame's instance buffer
+        Buffer::Ptr m_indirectBuffer = {};          ///< This frame's indirect command buffer
+        std::size_t m_frame          = 0u;
+        std::size_t m_frameCount     = 0u;
+        bool m_bCull                 = false; ///< Indirect draws are being culled on the GPU
+        bool m_bPrepared             = false; ///< `prepare` ran since the last `record`
+
+        // Small IDs handed out in order of first use each frame
+        std::unordered_map<uint64_t, uint32_t> m_pipelineIds;
+        std::unordered_map<uint64_t, uint32_t> m_materialIds;
+        std::unordered_map<uint64_t, uint32_t> m_meshIds;
+
+        /**
+         * @brief A secondary command buffer and the pool it's allocated from, used by one thread at a time
+         */
+        struct Recorder
+        {
+            CommandPool::Ptr pool       = {};
+            CommandBuffers::Ptr cmdBufs = {};
+        };
+
+        ParallelRecordInfo m_parallel = {};
+        std::vector<std::vector<Recorder>> m_recorders; ///< Recorders of each frame in flight, one per run
+        std::unique_ptr<utils::ThreadPool> m_workers;   ///< Threads recording every run but the first
+        std::vector<std::future<void>> m_runs;          ///< Runs being recorded on worker threads
+        std::vector<vk::CommandBuffer> m_secondaries;   ///< Secondary command buffers to execute
+
+        glm::vec3 m_viewPosition   = glm::vec3(0);
+        glm::mat4 m_viewProjection = glm::mat4(1);
+        bool m_bViewProjection     = false; ///< `setViewProjection` was called
+    };
+} // namespace ivulk
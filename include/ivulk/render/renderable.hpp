@@ -10,12 +10,15 @@
 #include <ivulk/config.hpp>
 
 #include <ivulk/glm.hpp>
+#include <ivulk/render/bounds.hpp>
 #include <ivulk/render/priorities.hpp>
 #include <ivulk/core/graphics_pipeline.hpp>
 #include <memory>
 
 namespace ivulk {
     class CommandBuffers;
+    class RenderQueue;
+    struct DrawContext;
 
     /**
 	 * @brief Interface for objects that can be rendered to command buffers.
@@ -30,11 +33,49 @@ namespace ivulk {
 		 */
         virtual void render(std::weak_ptr<CommandBuffers> cmdBufs, glm::mat4 modelMatrix = glm::mat4(1), const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines = {}) = 0;
 
+        /**
+         * @brief Add the draws of this object to a render queue.
+         *
+         * The default implementation adds the whole object as a single draw that calls `render`. Override
+         * it to add each mesh separately, so the queue can sort and batch them.
+         *
+         * @param queue The queue to add draws to
+         * @param context The draw state inherited from the parent
+         */
+        virtual void enqueue(RenderQueue& queue, const DrawContext& context);
+
+        /**
+         * @brief Get a box around this object, in its model space.
+         *
+         * Used to cull the object on the CPU. The default implementation returns an empty box, so the
+         * object is never culled by it.
+         */
+        inline virtual BoundingBox getBoundingBox() const { return {}; }
+
+        /**
+         * @brief Get a sphere around this object, in its model space.
+         *
+         * The default implementation returns an unbounded sphere.
+         */
+        inline virtual BoundingSphere getBoundingSphere() const { return {}; }
+
+        /**
+         * @brief Pick the level of detail to draw this object at.
+         *
+         * The default implementation always returns 0, the full detail.
+         *
+         * @param screenSize Height of the object's bounding sphere on screen, as a fraction of the
+         *                   viewport's height (see `RenderQueue::getScreenSize`)
+         * @param currentLod The level the object was last drawn at, to avoid switching back and forth
+         *                   near a threshold
+         */
+        inline virtual uint32_t selectLod(float screenSize, uint32_t currentLod) const { return 0u; }
+
         /**
 		 * @brief Get the priority for rendering this object.
 		 *
 		 * @return The priority for determining the order in which to render this object.
-		 *         Higher priority renders sooner. Default implementation returns `0`.
+		 *         Lower priority renders sooner. Default implementation returns `E_RenderPriority::Normal`.
 		 */
         inline virtual int16_t renderOrder() const { return E_RenderPriority::Normal; }
     };
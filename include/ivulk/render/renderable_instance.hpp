@@ -9,11 +9,14 @@
 
 #include <ivulk/config.hpp>
 
+#include <ivulk/render/render_queue.hpp>
 #include <ivulk/render/renderable.hpp>
+#include <ivulk/render/standard_shader.hpp>
 #include <ivulk/render/transform.hpp>
 #include <ivulk/utils/keywords.hpp>
 
 #include <ivulk/core/command_buffer.hpp>
+#include <ivulk/core/descriptor_set.hpp>
 #include <ivulk/core/graphics_pipeline.hpp>
 
 #include <boost/mpl/and.hpp>
@@ -44,7 +47,21 @@ namespace ivulk {
         virtual void render(std::weak_ptr<CommandBuffers> cmdBufs,
                             glm::mat4 modelMatrix = glm::mat4(1),
                             const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines = {}) override;
-        virtual inline int16_t renderOrder() const override { return priority(); }
+        virtual void enqueue(RenderQueue& queue, const DrawContext& context) override;
+        virtual inline int16_t renderOrder() const override
+        {
+            return priority ? priority() : E_RenderPriority::Normal;
+        }
+
+        /**
+         * @brief Get a box around the base renderable, after the instance's transform.
+         */
+        virtual BoundingBox getBoundingBox() const override;
+
+        /**
+         * @brief Get a sphere around the base renderable, after the instance's transform.
+         */
+        virtual BoundingSphere getBoundingSphere() const override;
 
         // clang-format off
 		BOOST_PARAMETER_MEMBER_FUNCTION(
@@ -58,11 +75,14 @@ namespace ivulk {
 				(getPriority, (std::optional<std::function<int16_t()>>), std::optional<std::function<int16_t()>>{})
 				(pipeline, *, GraphicsPipeline::Ref{})
 				(pipelines, *, std::vector<GraphicsPipeline::Ref>{})
+				(material, (std::optional<BindlessMaterial>), std::optional<BindlessMaterial>{})
+				(materialSet, (DescriptorSet::Ptr), DescriptorSet::Ptr{})
 			)
 		)
         // clang-format on
         {
-            return createImpl(std::weak_ptr(base), xform, priority, getPriority, pipeline, pipelines);
+            return createImpl(
+                std::weak_ptr(base), xform, priority, getPriority, pipeline, pipelines, material, materialSet);
         }
 
         /**
@@ -80,19 +100,38 @@ namespace ivulk {
 		 */
         Transform transform;
 
+        /**
+		 * @brief Bindless material indices, pushed before rendering with bindless pipelines
+		 */
+        std::optional<BindlessMaterial> material;
+
+        /**
+		 * @brief Shared descriptor set to render with in place of the pipelines' own set for its slot
+		 */
+        DescriptorSet::Ptr materialSet;
+
+        /**
+		 * @brief Level of detail the instance was last enqueued at, kept to switch levels with hysteresis
+		 */
+        uint32_t lod = 0u;
+
     private:
         /**
 		 * @brief Function object to get rendering order priority
 		 */
         std::function<int16_t()> priority;
 
+        void pushMaterial(std::weak_ptr<CommandBuffers> cmdBufs);
+
         template <typename BaseRenderable>
         static Ptr createImpl(std::weak_ptr<BaseRenderable> base,
                               Transform xform,
                               std::optional<int16_t> priority,
                               std::optional<std::function<int16_t()>> getPriority,
                               std::weak_ptr<GraphicsPipeline> pipeline,
-                              const std::vector<GraphicsPipeline::Ref>& pipelines)
+                              const std::vector<GraphicsPipeline::Ref>& pipelines,
+                              std::optional<BindlessMaterial> material,
+                              DescriptorSet::Ptr materialSet)
         {
             auto r = Ptr(new RenderableInstance());
             if (auto b = base.lock())
@@ -107,6 +146,8 @@ namespace ivulk {
                 r->priority = [priority]() -> int16_t { return *priority; };
             }
             r->pipelines = (pipelines.empty()) ? std::vector<GraphicsPipeline::Ref>{pipeline} : pipelines;
+            r->material    = material;
+            r->materialSet = materialSet;
             return r;
         }
     };
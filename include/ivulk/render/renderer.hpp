@@ -40,10 +40,23 @@ namespace ivulk {
         
         void copyToSwapchain(Image::Ref colorBuf);
 
-        void beginOffscreenPass(FramebufferInfo fbInfo);
+        /**
+         * @brief Begin a render pass into a new framebuffer, recorded into a one-time command buffer.
+         *
+         * @param fbInfo The framebuffer to create
+         * @param contents Use `vk::SubpassContents::eSecondaryCommandBuffers` to record the pass with
+         *                 secondary command buffers only, e.g. from a `Scene` recorded in parallel
+         */
+        void beginOffscreenPass(FramebufferInfo fbInfo,
+                                vk::SubpassContents contents = vk::SubpassContents::eInline);
         void endOffscreenPass();
         vk::CommandBuffer getCmdBuf();
 
+        /**
+         * @brief Get the framebuffer of the current offscreen pass.
+         */
+        Framebuffer::Ptr getOffscreenFramebuffer() { return m_fb; }
+
         virtual void drawFinalFrame();
 
     protected:
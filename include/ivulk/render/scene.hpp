@@ -9,37 +9,165 @@
 
 #include <ivulk/config.hpp>
 
+#include <ivulk/render/bounds.hpp>
+#include <ivulk/render/bvh.hpp>
+#include <ivulk/render/frustum_culler.hpp>
+#include <ivulk/render/occlusion_culler.hpp>
+#include <ivulk/render/render_queue.hpp>
 #include <ivulk/render/renderable.hpp>
 #include <ivulk/render/renderable_instance.hpp>
 
 #include <ivulk/render/scene_ubo.hpp>
 
-#include <set>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace ivulk {
     class RenderableInstance;
 
+    /**
+     * @brief The nearest instance hit by a ray, see `Scene::raycast`.
+     */
+    struct SceneRayHit final
+    {
+        std::shared_ptr<RenderableInstance> renderable = {};   ///< The instance hit
+        float distance                                 = 0.0f; ///< Where the ray enters its box
+    };
+
+    /**
+     * @brief A collection of renderable instances, drawn through a `RenderQueue`.
+     *
+     * Every `render` collects the instances' draws, sorts them by layer, pipeline, material and mesh, and
+     * records them in that order.
+     *
+     * Instances with bounds (see `I_Renderable::getBoundingBox`) are kept in a `Bvh` by their box after
+     * their transform, so visibility, picking and light queries only visit the instances near the query.
+     * Call `updateRenderable` after moving an instance, or changing its base renderable's bounds, to
+     * refit it. Instances without bounds are always drawn, and never returned by queries.
+     *
+     * Once a view-projection matrix is set, instances are culled against its frustum on the CPU before
+     * their draws are collected. Instances whose box is partly outside are tested further, with their
+     * sphere as well, by a `FrustumCuller`.
+     *
+     * With an `OcclusionCuller` set, instances that pass the frustum test are also tested against its
+     * occluders, rendered from the same view-projection. Occluders are placed in the scene's space.
+     *
+     * To cull instances on the GPU as well, call `cull` before the render pass begins; the following
+     * `render` draws what it collected, with the model matrix and pipelines given to `cull`.
+     */
     class Scene : public I_Renderable
     {
     public:
         using Ptr = std::shared_ptr<Scene>;
         using Ref = std::weak_ptr<Scene>;
 
-        std::weak_ptr<RenderableInstance> addRenderable(const std::shared_ptr<RenderableInstance> rndbl)
+        std::weak_ptr<RenderableInstance> addRenderable(const std::shared_ptr<RenderableInstance> rndbl);
+
+        void removeRenderable(const std::shared_ptr<RenderableInstance> rndbl);
+
+        /**
+         * @brief Refit an instance's bounds, after its transform or base renderable changed.
+         */
+        void updateRenderable(const std::shared_ptr<RenderableInstance> rndbl);
+
+        /**
+         * @brief Call `f(instance)` for every instance whose box overlaps a box.
+         */
+        template <typename F>
+        void queryRenderables(const BoundingBox& box, F&& f) const
+        {
+            m_bvh.query(box, [&](uint32_t index) { f(m_renderables[index]); });
+        }
+
+        /**
+         * @brief Call `f(instance)` for every instance whose box overlaps a sphere, e.g. a light's range.
+         */
+        template <typename F>
+        void queryRenderables(const BoundingSphere& sphere, F&& f) const
+        {
+            m_bvh.query(sphere, [&](uint32_t index) { f(m_renderables[index]); });
+        }
+
+        /**
+         * @brief Call `f(instance)` for every instance whose box is at least partly inside a frustum.
+         */
+        template <typename F>
+        void queryRenderables(const Frustum& frustum, F&& f) const
         {
-            m_renderables.insert(rndbl);
-            return rndbl;
+            m_bvh.query(frustum, [&](uint32_t index, bool) { f(m_renderables[index]); });
         }
 
-        void removeRenderable(const std::shared_ptr<RenderableInstance> rndbl)
+        /**
+         * @brief Find the nearest instance whose box is hit by a ray.
+         *
+         * @param origin The start of the ray
+         * @param direction The direction of the ray
+         * @param maxDistance The length of the ray, in units of `direction`
+         */
+        std::optional<SceneRayHit> raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const;
+
+        /**
+         * @brief Set the position draws are sorted by depth from, usually the camera position.
+         */
+        void setViewPosition(glm::vec3 position) { m_queue.setViewPosition(position); }
+
+        /**
+         * @brief Set the view-projection matrix instances are culled against, on the CPU and in `cull`.
+         */
+        void setViewProjection(const glm::mat4& viewProjection)
         {
-            m_renderables.erase(rndbl);
+            m_viewProjection = viewProjection;
+            m_queue.setViewProjection(viewProjection);
         }
 
+        /**
+         * @brief Stop culling instances on the CPU, until the next `setViewProjection`.
+         */
+        void resetViewProjection() { m_viewProjection.reset(); }
+
+        /**
+         * @brief Set the occlusion culler to hide instances with, or nothing to stop occlusion culling.
+         */
+        void setOcclusionCuller(OcclusionCuller::Ptr culler) { m_occlusionCuller = culler; }
+
+        /**
+         * @brief Record the draws of `render` on worker threads. See `RenderQueue::setParallelRecording`.
+         */
+        void setParallelRecording(const ParallelRecordInfo& info) { m_queue.setParallelRecording(info); }
+
+        /**
+         * @brief Collect and sort the draws for the next `render`, and record GPU culling for them.
+         *
+         * Must be recorded outside a render pass, before the command buffer `render` records into.
+         * See `RenderQueue::cull`.
+         *
+         * @param cb The command buffer to record culling into
+         * @param culler The culler, holding the depth of the previous frame
+         * @param modelMatrix The model matrix passed on to the instances
+         * @param pipelines The pipelines passed on to the instances
+         */
+        void cull(VkCommandBuffer cb,
+                  GpuCuller& culler,
+                  glm::mat4 modelMatrix                                         = glm::mat4(1),
+                  const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines = {});
+
+        /**
+         * @brief Get the number of draws recorded by the last `render`.
+         */
+        std::size_t getDrawCount() const { return m_queue.size(); }
+
+        /**
+         * @brief Get the number of instances that passed the last CPU frustum test.
+         */
+        std::size_t getVisibleCount() const { return m_visibleCount; }
+
         virtual void render(std::weak_ptr<CommandBuffers> cmdBufs,
                             glm::mat4 modelMatrix = glm::mat4(1),
                             const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines = {}) override;
 
+        virtual void enqueue(RenderQueue& queue, const DrawContext& context) override;
+
         virtual inline int16_t renderOrder() const override { return E_RenderPriority::Normal - 100; }
 
         static inline Ptr create() { return Ptr(new Scene()); }
@@ -47,14 +175,23 @@ namespace ivulk {
     private:
         Scene() = default;
 
-        struct CompareRenderablePtr
-        {
-            inline bool operator()(const std::shared_ptr<RenderableInstance>& a,
-                                   const std::shared_ptr<RenderableInstance>& b) const
-            {
-                return a->renderOrder() < b->renderOrder(); 
-            }
-        };
-        std::multiset<std::shared_ptr<RenderableInstance>, CompareRenderablePtr> m_renderables;
+        /**
+         * @brief Add or remove an instance from the BVH as its bounds appear or disappear
+         */
+        void updateProxy(std::size_t index);
+
+        std::vector<std::shared_ptr<RenderableInstance>> m_renderables;
+        std::unordered_map<const RenderableInstance*, std::size_t> m_indices; ///< Index of each instance
+        std::vector<uint32_t> m_proxies;   ///< BVH proxy of each instance, or `Bvh::Null` if unbounded
+        std::vector<uint32_t> m_unbounded; ///< Indices of the instances without bounds
+        Bvh m_bvh;                         ///< Boxes of the bounded instances, valued by index
+
+        RenderQueue m_queue;
+        FrustumCuller m_frustumCuller;
+        std::vector<uint32_t> m_candidates;        ///< Instances partly inside the frustum
+        std::optional<glm::mat4> m_viewProjection; ///< Matrix to cull instances against, if set
+        OcclusionCuller::Ptr m_occlusionCuller;
+        std::size_t m_visibleCount = 0u;
+        bool m_bCulled             = false; ///< `m_queue` was filled by `cull` for the next `render`
     };
 } // namespace ivulk
@@ -13,8 +13,21 @@
 #include <ivulk/render/lighting.hpp>
 
 namespace ivulk {
+    /**
+     * @brief Capacity of the point light array in `SceneUBOData`.
+     *
+     * Matches the `pointLightsPerPass` default of the `lib/lighting/common.glsl.jinja` shader library. The
+     * number of lights a pipeline actually loops over is set with `E_SpecConstant::PointLightCount`.
+     */
     constexpr std::size_t POINT_LIGHTS_PER_PASS = 4;
-    constexpr std::size_t DIR_LIGHTS_PER_PASS   = 4;
+
+    /**
+     * @brief Capacity of the directional light array in `SceneUBOData`.
+     *
+     * Matches the `dirLightsPerPass` default of the `lib/lighting/common.glsl.jinja` shader library. The
+     * number of lights a pipeline actually loops over is set with `E_SpecConstant::DirLightCount`.
+     */
+    constexpr std::size_t DIR_LIGHTS_PER_PASS = 4;
 
     struct SceneUBOData
     {
@@ -9,6 +9,7 @@
 
 #include <ivulk/config.hpp>
 
+#include <ivulk/core/vertex.hpp>
 #include <ivulk/glm.hpp>
 
 namespace ivulk {
@@ -21,4 +22,56 @@ namespace ivulk {
         LAYOUT_MAT4 glm::mat4 view;
         LAYOUT_MAT4 glm::mat4 proj;
     };
+
+    /**
+     * @brief Vertex binding of `InstanceVertex` in instanced pipelines.
+     */
+    constexpr uint32_t InstanceBinding = 1u;
+
+    // clang-format off
+    /**
+     * @brief Per-instance vertex attributes of instanced pipelines: the columns of the model matrix.
+     *
+     * Read by shaders rendered with `INSTANCED` set in their template context (see `lib/base.vert.jinja`),
+     * in place of `MatricesPushConstants::model`.
+     */
+    IVULK_VERTEX_STRUCT(InstanceVertex,
+        ((glm::vec4, model0, 4))
+        ((glm::vec4, model1, 5))
+        ((glm::vec4, model2, 6))
+        ((glm::vec4, model3, 7))
+    );
+    // clang-format on
+
+    /**
+     * @brief Per-draw material indices into the bindless texture table.
+     *
+     * Pushed after `MatricesPushConstants` for pipelines created with `GraphicsPipelineInfo::bBindless`.
+     */
+    struct BindlessMaterial
+    {
+        uint32_t albedo  = 0u; ///< Index of the albedo texture
+        uint32_t normal  = 0u; ///< Index of the normal map
+        uint32_t packed  = 0u; ///< Index of the packed occlusion/roughness/metalness map
+        uint32_t sampler = 0u; ///< Index of the sampler used for every texture
+    };
+
+    /**
+     * @brief Push constant offset of `BindlessMaterial`.
+     */
+    constexpr uint32_t BindlessMaterialOffset = sizeof(MatricesPushConstants);
+
+    /**
+     * @brief Specialization constant IDs used by the shader library (see `lib/specialization.glsl.jinja`).
+     *
+     * Pass them in `GraphicsPipelineInfo::specialization`. Constants that aren't given keep the defaults
+     * baked into the SPIR-V: every light up to `POINT_LIGHTS_PER_PASS` and `DIR_LIGHTS_PER_PASS`, and every
+     * material feature enabled.
+     */
+    namespace E_SpecConstant {
+        constexpr uint32_t PointLightCount = 0u; ///< `int`: Point lights looped over (default all)
+        constexpr uint32_t DirLightCount   = 1u; ///< `int`: Directional lights looped over (default all)
+        constexpr uint32_t NormalMap       = 2u; ///< `bool`: Sample the normal map, or use vertex normals
+        constexpr uint32_t Ambient         = 3u; ///< `bool`: Use the material's ambient term, or a flat one
+    } // namespace E_SpecConstant
 } // namespace ivulk
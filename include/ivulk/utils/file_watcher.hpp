@@ -0,0 +1,68 @@
+/**
+ * @file file_watcher.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `FileWatcher` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <ctime>
+#include <map>
+#include <set>
+
+namespace ivulk::utils {
+
+    /**
+     * @brief Reports files that were written in a set of directory trees.
+     *
+     * Uses inotify on Linux, which also catches editors that save by renaming a temporary file over the
+     * original. Subdirectories created after a tree is added are watched too. On other platforms, `poll()`
+     * compares modification times instead, which costs a directory scan per call.
+     */
+    class FileWatcher final
+    {
+    public:
+        FileWatcher();
+
+        /**
+         * @brief Stop watching every directory.
+         */
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&)            = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        /**
+         * @brief Start watching a directory and all its subdirectories.
+         *
+         * Adding a directory that's already watched has no effect.
+         *
+         * @return Whether the directory exists and is now watched
+         */
+        bool addDirectory(const boost::filesystem::path& dir);
+
+        /**
+         * @brief Get the files that were written since the last call. Doesn't block.
+         *
+         * @return The absolute, normalized paths of the changed files
+         */
+        std::set<boost::filesystem::path> poll();
+
+    private:
+        void watchTree(const boost::filesystem::path& dir);
+
+        std::set<boost::filesystem::path> m_roots;
+
+#if defined(__linux__)
+        int m_fd = -1;
+        std::map<int, boost::filesystem::path> m_watches; ///< Watch descriptor to directory
+#else
+        std::map<boost::filesystem::path, std::time_t> m_times; ///< Last seen modification time of each file
+#endif
+    };
+} // namespace ivulk::utils
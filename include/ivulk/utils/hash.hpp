@@ -0,0 +1,100 @@
+/**
+ * @file hash.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief Helpers for hashing data, used for cache keys.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <ivulk/utils/messages.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+namespace ivulk::utils {
+
+    constexpr uint64_t FNV1a64OffsetBasis = 14695981039346656037ull; ///< FNV-1a 64-bit offset basis
+    constexpr uint64_t FNV1a64Prime       = 1099511628211ull;        ///< FNV-1a 64-bit prime
+
+    /**
+     * @brief Hash a block of memory with the 64-bit FNV-1a algorithm.
+     *
+     * @param data The data to hash
+     * @param size The number of bytes to hash
+     * @param seed The initial hash value. Pass a previous result to hash data incrementally.
+     */
+    inline uint64_t fnv1a64(const void* data, std::size_t size, uint64_t seed = FNV1a64OffsetBasis)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash     = seed;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= FNV1a64Prime;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Hash a string with the 64-bit FNV-1a algorithm.
+     */
+    inline uint64_t fnv1a64(const std::string& str, uint64_t seed = FNV1a64OffsetBasis)
+    {
+        return fnv1a64(str.data(), str.size(), seed);
+    }
+
+    /**
+     * @brief Combine the hash of `value` into `seed`.
+     */
+    template <typename T>
+    inline void hashCombine(uint64_t& seed, const T& value)
+    {
+        seed ^= static_cast<uint64_t>(std::hash<T> {}(value)) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    /**
+     * @brief Hash the contents of a file with the 64-bit FNV-1a algorithm.
+     *
+     * @throws std::runtime_error if the file can't be opened.
+     */
+    inline uint64_t hashFile(const boost::filesystem::path& p, uint64_t seed = FNV1a64OffsetBasis)
+    {
+        std::ifstream f(p.string(), std::ios::binary);
+        if (!f.is_open())
+        {
+            throw std::runtime_error(
+                makeErrorMessage("FILE", "Failed to open file for hashing: `" + p.string() + "`"));
+        }
+        std::array<char, 64 * 1024> chunk;
+        uint64_t hash = seed;
+        while (f)
+        {
+            f.read(chunk.data(), chunk.size());
+            hash = fnv1a64(chunk.data(), static_cast<std::size_t>(f.gcount()), hash);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Format a hash as a fixed-width hexadecimal string, suitable for file names.
+     */
+    inline std::string toHexString(uint64_t hash)
+    {
+        constexpr char digits[] = "0123456789abcdef";
+        std::string res(16, '0');
+        for (int i = 15; i >= 0; --i, hash >>= 4)
+        {
+            res[i] = digits[hash & 0xfu];
+        }
+        return res;
+    }
+} // namespace ivulk::utils
@@ -21,6 +21,8 @@ namespace ivulk {
 	BOOST_PARAMETER_NAME(index)
 	BOOST_PARAMETER_NAME(indexBuffer)
 	BOOST_PARAMETER_NAME(instances)
+	BOOST_PARAMETER_NAME(material)
+	BOOST_PARAMETER_NAME(materialSet)
 	BOOST_PARAMETER_NAME(pipeline)
 	BOOST_PARAMETER_NAME(pipelines)
 	BOOST_PARAMETER_NAME(priority)
@@ -0,0 +1,65 @@
+/**
+ * @file radix_sort.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief Radix sort for 64-bit keys.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ivulk::utils {
+
+    /**
+     * @brief Sort items by an unsigned 64-bit key, with a stable least-significant-digit radix sort.
+     *
+     * Keys are sorted a byte at a time. The histograms for every byte are built in a single pass, and bytes
+     * that are the same in every key are skipped, so keys that only vary in a few bytes only take a few
+     * passes. Best suited to small items, e.g. a key and an index into a separate array.
+     *
+     * @param items The items to sort
+     * @param scratch Temporary storage, resized to match `items`. Reuse it between calls to avoid
+     *                allocating.
+     * @param getKey Function object returning the `uint64_t` key of an item
+     */
+    template <typename T, typename KeyFn>
+    void radixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFn getKey)
+    {
+        constexpr std::size_t Digits = sizeof(uint64_t);
+        const std::size_t n          = items.size();
+        if (n < 2)
+            return;
+
+        std::array<std::array<std::size_t, 256>, Digits> counts = {};
+        for (const auto& item : items)
+        {
+            const uint64_t key = getKey(item);
+            for (std::size_t d = 0; d < Digits; ++d)
+                ++counts[d][(key >> (d * 8u)) & 0xffu];
+        }
+
+        scratch.resize(n);
+        for (std::size_t d = 0; d < Digits; ++d)
+        {
+            auto& count = counts[d];
+            if (count[(getKey(items.front()) >> (d * 8u)) & 0xffu] == n)
+                continue;
+
+            // Bucket counts to bucket offsets
+            std::size_t offset = 0u;
+            for (auto& c : count)
+                offset += std::exchange(c, offset);
+
+            for (auto& item : items)
+                scratch[count[(getKey(item) >> (d * 8u)) & 0xffu]++] = std::move(item);
+            items.swap(scratch);
+        }
+    }
+} // namespace ivulk::utils
@@ -0,0 +1,86 @@
+/**
+ * @file thread_pool.hpp
+ * @author Zachary Frost
+ * @copyright MIT License (See LICENSE.md in repostory root)
+ * @brief `ThreadPool` class.
+ */
+
+#pragma once
+
+#include <ivulk/config.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ivulk::utils {
+
+    /**
+     * @brief A fixed set of worker threads that run submitted tasks in FIFO order.
+     */
+    class ThreadPool final
+    {
+    public:
+        /**
+         * @brief Start the worker threads.
+         *
+         * @param threadCount The number of workers. If 0, one less than the number of hardware threads is
+         *                    used, leaving a core for the main thread, with a minimum of one.
+         */
+        explicit ThreadPool(std::size_t threadCount = 0u);
+
+        /**
+         * @brief Finish every queued task, then join the worker threads.
+         */
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&)            = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /**
+         * @brief Queue a task to run on a worker thread.
+         *
+         * @return A future for the task's result. Exceptions thrown by the task are rethrown by `get()`.
+         */
+        template <typename Fn>
+        auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>
+        {
+            using result_t = std::invoke_result_t<std::decay_t<Fn>>;
+            auto task      = std::make_shared<std::packaged_task<result_t()>>(std::forward<Fn>(fn));
+            auto result    = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.emplace([task]() { (*task)(); });
+            }
+            m_wake.notify_one();
+            return result;
+        }
+
+        /**
+         * @brief Block until every queued task has finished running.
+         */
+        void waitIdle();
+
+        /**
+         * @brief Get the number of worker threads.
+         */
+        std::size_t getThreadCount() const { return m_workers.size(); }
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> m_workers;
+        std::queue<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::size_t m_activeTasks = 0u;
+        bool m_bStopping          = false;
+    };
+} // namespace ivulk::utils
@@ -2,6 +2,12 @@
 #include <ivulk/config.hpp>
 
 #include <ivulk/core/app.hpp>
+#include <ivulk/core/descriptor_layout_cache.hpp>
+#include <ivulk/core/mip_generator.hpp>
+#include <ivulk/core/pipeline_registry.hpp>
+#include <ivulk/core/sampler_cache.hpp>
+#include <ivulk/core/shader_hot_reload.hpp>
+#include <ivulk/core/shader_module_cache.hpp>
 
 #include <ivulk/config.hpp>
 #include <ivulk/utils/containers.hpp>
@@ -13,12 +19,14 @@
 
 #include <vector>
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <iostream>
 #include <map>
 #include <stdexcept>
 
+#include <ivulk/render/geometry_pool.hpp>
 #include <ivulk/render/renderer.hpp>
 
 namespace ivulk {
@@ -48,12 +56,14 @@ namespace ivulk {
 
     App* App::current() { return s_currentApp; }
 
-    AppState App::getState() const { return state; }
+    const AppState& App::getState() const { return state; }
 
     bool App::getPrintDbg() const { return m_initArgs.bDebugPrint; }
 
     void App::quit() { state.evt.shouldQuit = true; }
 
+    boost::filesystem::path App::getCacheDir() { return getAssetsDir().parent_path() / "cache"; }
+
     void App::mainLoop()
     {
         using namespace std::chrono;
@@ -115,6 +125,10 @@ namespace ivulk {
         m_initArgs = getInitArgs();
         state.vk.swapChain.maxFramesInFlight = m_initArgs.vk.maxFramesInFlight;
 
+        state.workers.pool = std::make_shared<utils::ThreadPool>(m_initArgs.workerThreads);
+        if (m_initArgs.bShaderHotReload)
+            ShaderHotReload::enable();
+
         // ================== Initialize SDL2 =================== //
 
         initializeSDL();
@@ -129,12 +143,14 @@ namespace ivulk {
 
         // Create allocator
         createVmaAllocator();
+        createVkPipelineCache();
 
         createVkSwapChain();
         createVkImageViews();
         createVkCommandPools();
         createDepthResources();
-        createVkDescriptorPool();
+        createDescriptorAllocator();
+        createBindlessTable();
 
         // Run subclass initialization before creating framebuffers
         initialize();
@@ -146,9 +162,24 @@ namespace ivulk {
     void App::appCleanup()
     {
 
+        // Finish background work before releasing anything it may use
+        ShaderHotReload::disable();
+        state.workers.pool->waitIdle();
+
         // Run subclass cleanup
         cleanup(false);
 
+        state.workers.pool->waitIdle();
+        state.workers.pool.reset();
+
+        // Release shared resources owned by the library
+        MipGenerator::release();
+        PipelineRegistry::clear();
+        GeometryPool::release();
+        SamplerCache::clear();
+        ShaderModuleCache::clear();
+        state.vk.bindless.table.reset();
+
         // =================== Cleanup Vulkan =================== //
 
         // Destroy sync objects
@@ -164,6 +195,12 @@ namespace ivulk {
 
         cleanupVkSwapChain();
 
+        destroyVkPipelineCache();
+
+        // Destroy descriptor pools and cached layouts
+        state.vk.descriptor.allocator.reset();
+        DescriptorLayoutCache::clear();
+
         // Destroy VMA allocator
         vmaDestroyAllocator(state.vk.allocator);
 
@@ -236,7 +273,7 @@ namespace ivulk {
             .setApplicationVersion(m_initArgs.appVersion.toVkVersion())
             .setPEngineName("Incredible Vulk")
             .setEngineVersion(VK_MAKE_VERSION(IVULK_VERSION_MAJOR, IVULK_VERSION_MINOR, IVULK_VERSION_PATCH))
-            .setApiVersion(VK_API_VERSION_1_0);
+            .setApiVersion(VK_API_VERSION_1_1);
 
         vk::InstanceCreateInfo createInfo {};
         createInfo.setPApplicationInfo(&appInfo)
@@ -331,7 +368,8 @@ namespace ivulk {
 
     bool App::isDeviceSuitable(vk::PhysicalDevice device)
     {
-        auto features = device.getFeatures();
+        auto features   = device.getFeatures();
+        auto properties = device.getProperties();
         QueueFamilyIndices indices = findVkQueueFamilies(device);
         bool extensionsSupported   = checkDeviceExtensions(device);
         bool swapChainOk           = false;
@@ -340,7 +378,35 @@ namespace ivulk {
             SwapChainInfo scInfo = querySwapChainInfo(device);
             swapChainOk          = !scInfo.formats.empty() && !scInfo.presentModes.empty();
         }
-        return indices.isComplete() && extensionsSupported && swapChainOk && features.geometryShader;
+        return indices.isComplete() && extensionsSupported && swapChainOk && features.geometryShader
+               && properties.apiVersion >= VK_API_VERSION_1_1;
+    }
+
+    bool App::checkBindlessSupport(vk::PhysicalDevice device)
+    {
+        auto extensions = device.enumerateDeviceExtensionProperties();
+        if (extensions.result != vk::Result::eSuccess)
+            return false;
+
+        bool bHasExtension = std::any_of(
+            extensions.value.begin(), extensions.value.end(), [](const vk::ExtensionProperties& extProps) {
+                return std::strcmp(extProps.extensionName.data(), VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME) == 0;
+            });
+        if (!bHasExtension)
+            return false;
+
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+        };
+        VkPhysicalDeviceFeatures2 features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+            .pNext = &indexingFeatures,
+        };
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        return indexingFeatures.shaderSampledImageArrayNonUniformIndexing
+               && indexingFeatures.descriptorBindingSampledImageUpdateAfterBind
+               && indexingFeatures.descriptorBindingPartiallyBound && indexingFeatures.runtimeDescriptorArray;
     }
 
     std::vector<const char*> App::getRequiredVkDeviceExtensions()
@@ -581,6 +647,34 @@ namespace ivulk {
         vk::PhysicalDeviceFeatures deviceFeatures {};
         deviceFeatures.setSamplerAnisotropy(supportedFeatures.samplerAnisotropy);
         deviceFeatures.setGeometryShader(true);
+        deviceFeatures.setMultiDrawIndirect(supportedFeatures.multiDrawIndirect);
+        deviceFeatures.setDrawIndirectFirstInstance(supportedFeatures.drawIndirectFirstInstance);
+        state.vk.features.bMultiDrawIndirect         = supportedFeatures.multiDrawIndirect;
+        state.vk.features.bDrawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+        // Bindless textures are optional, so fall back to per-pipeline descriptors if unsupported
+        VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT,
+        };
+        state.vk.bindless.bEnabled = false;
+        if (m_initArgs.vk.bBindless)
+        {
+            if (checkBindlessSupport(state.vk.physicalDevice))
+            {
+                indexingFeatures.shaderSampledImageArrayNonUniformIndexing     = VK_TRUE;
+                indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                indexingFeatures.descriptorBindingPartiallyBound              = VK_TRUE;
+                indexingFeatures.runtimeDescriptorArray                       = VK_TRUE;
+                deviceExtensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+                state.vk.bindless.bEnabled = true;
+            }
+            else
+            {
+                std::cout << utils::makeWarningMessage(
+                    "VK::HARDWARE", "Descriptor indexing is not supported; bindless textures are disabled")
+                          << std::endl;
+            }
+        }
 
         // =========== Create logical device =========== //
 
@@ -590,6 +684,8 @@ namespace ivulk {
             .setEnabledExtensionCount(deviceExtensions.size())
             .setPpEnabledExtensionNames(deviceExtensions.data())
             .setPEnabledFeatures(&deviceFeatures);
+        if (state.vk.bindless.bEnabled)
+            createInfo.setPNext(&indexingFeatures);
         if (m_initArgs.vk.bEnableValidation)
         {
             createInfo.enabledLayerCount   = static_cast<uint32_t>(state.vk.requiredLayers.size());
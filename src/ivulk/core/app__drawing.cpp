@@ -2,6 +2,7 @@
 #include <ivulk/config.hpp>
 
 #include <ivulk/core/app.hpp>
+#include <ivulk/core/shader_hot_reload.hpp>
 #include <ivulk/utils/messages.hpp>
 
 #include <stdexcept>
@@ -17,6 +18,7 @@ namespace ivulk {
             .queueFamilyIndex = qfIndices.graphics.value(),
         };
 
+        state.vk.cmd.gfxFamily = gfxPoolInfo.queueFamilyIndex;
         if (vkCreateCommandPool(state.vk.device, &gfxPoolInfo, nullptr, &state.vk.cmd.gfxPool) != VK_SUCCESS)
         {
             throw std::runtime_error(
@@ -78,6 +80,9 @@ namespace ivulk {
         state.vk.queues.graphics.waitIdle();
         vkWaitForFences(
             state.vk.device, 1, &state.vk.sync.inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+        state.vk.descriptor.allocator->beginFrame(m_currentFrame);
+        ShaderHotReload::update();
+        GraphicsPipeline::updateAsync();
 
         uint32_t imageIndex;
 
@@ -26,29 +26,81 @@ namespace ivulk {
         {".comp", VK_SHADER_STAGE_COMPUTE_BIT},
     };
 
-    void App::createVkDescriptorPool()
+    void App::createVkPipelineCache()
     {
-        std::array<VkDescriptorPoolSize, 2> poolSizes;
+        // Seed the cache from a previous run, if available. Drivers ignore data from other devices or versions.
+        std::vector<char> initialData;
+        if (!m_initArgs.vk.pipelineCachePath.empty())
+        {
+            std::ifstream f(m_initArgs.vk.pipelineCachePath, std::ios::ate | std::ios::binary);
+            if (f.is_open())
+            {
+                initialData.resize(static_cast<std::size_t>(f.tellg()));
+                f.seekg(0);
+                f.read(initialData.data(), static_cast<std::streamsize>(initialData.size()));
+            }
+        }
 
-        VkDescriptorPoolSize poolSize {
-            .type            = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = static_cast<uint32_t>(35),
-        };
-        poolSizes[0]  = poolSize;
-        poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        poolSizes[1]  = poolSize;
-
-        VkDescriptorPoolCreateInfo poolInfo {
-            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-            .maxSets       = static_cast<uint32_t>(35),
-            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
-            .pPoolSizes    = poolSizes.data(),
+        const VkPipelineCacheCreateInfo cacheInfo {
+            .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .initialDataSize = initialData.size(),
+            .pInitialData    = initialData.empty() ? nullptr : initialData.data(),
         };
+        if (vkCreatePipelineCache(state.vk.device, &cacheInfo, nullptr, &state.vk.pipelines.cache) != VK_SUCCESS)
+        {
+            throw std::runtime_error(utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan pipeline cache"));
+        }
+        if (getPrintDbg() && !initialData.empty())
+        {
+            std::string description = "Loaded pipeline cache from `";
+            description += m_initArgs.vk.pipelineCachePath + "`";
+            std::cout << utils::makeInfoMessage("VK::CREATE", description) << std::endl;
+        }
+    }
+
+    void App::destroyVkPipelineCache()
+    {
+        if (!m_initArgs.vk.pipelineCachePath.empty())
+        {
+            std::size_t size = 0u;
+            vkGetPipelineCacheData(state.vk.device, state.vk.pipelines.cache, &size, nullptr);
+            std::vector<char> data(size);
+            if (size > 0u
+                && vkGetPipelineCacheData(state.vk.device, state.vk.pipelines.cache, &size, data.data()) == VK_SUCCESS)
+            {
+                std::ofstream f(m_initArgs.vk.pipelineCachePath, std::ios::binary | std::ios::trunc);
+                if (f.is_open())
+                {
+                    f.write(data.data(), static_cast<std::streamsize>(size));
+                }
+                else
+                {
+                    std::string description = "Failed to save pipeline cache to `";
+                    description += m_initArgs.vk.pipelineCachePath + "`";
+                    std::cout << utils::makeWarningMessage("FILE", description) << std::endl;
+                }
+            }
+        }
+        vkDestroyPipelineCache(state.vk.device, state.vk.pipelines.cache, nullptr);
+        state.vk.pipelines.cache = VK_NULL_HANDLE;
+    }
+
+    void App::createDescriptorAllocator()
+    {
+        state.vk.descriptor.allocator = DescriptorAllocator::create(
+            state.vk.device, {.framesInFlight = static_cast<uint32_t>(state.vk.swapChain.maxFramesInFlight)});
+    }
+
+    void App::createBindlessTable()
+    {
+        if (!state.vk.bindless.bEnabled)
+            return;
 
-        if (vkCreateDescriptorPool(state.vk.device, &poolInfo, nullptr, &state.vk.descriptor.pool)
-            != VK_SUCCESS)
-            throw std::runtime_error(
-                utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan descriptor pool"));
+        state.vk.bindless.table = BindlessTextureTable::create(state.vk.device,
+                                                               {
+                                                                   .maxTextures = m_initArgs.vk.maxBindlessTextures,
+                                                                   .maxSamplers = m_initArgs.vk.maxBindlessSamplers,
+                                                               });
     }
 
 } // namespace ivulk
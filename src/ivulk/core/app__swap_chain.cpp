@@ -242,20 +242,21 @@ namespace ivulk {
             vkDestroyImageView(state.vk.device, imgV, nullptr);
         vkDestroySwapchainKHR(state.vk.device, state.vk.swapChain.sc, nullptr);
 
-        vkDestroyDescriptorPool(state.vk.device, state.vk.descriptor.pool, nullptr);
         cleanup(true);
     }
 
     void App::recreateVkSwapChain()
     {
         vkDeviceWaitIdle(state.vk.device);
+        // Pipelines still being created on worker threads read the swapchain state
+        if (state.workers.pool)
+            state.workers.pool->waitIdle();
 
         cleanupVkSwapChain();
 
         createVkSwapChain();
         createVkImageViews();
         createDepthResources();
-        createVkDescriptorPool();
         // Run subclass initialization before creating framebuffers
         initialize(true);
 
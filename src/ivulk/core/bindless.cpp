@@ -0,0 +1,242 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/bindless.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/shader_stage.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace ivulk {
+
+    BindlessTextureTable::Ptr BindlessTextureTable::current()
+    {
+        return App::current()->getState().vk.bindless.table;
+    }
+
+    BindlessTextureTable::BindlessTextureTable(VkDevice device,
+                                               VkDescriptorPool pool,
+                                               VkDescriptorSetLayout layout,
+                                               VkDescriptorSet set,
+                                               BindlessTableInfo info)
+        : base_t(device, handles_t {pool, layout, set})
+        , m_info(info)
+    { }
+
+    void BindlessTextureTable::destroyImpl()
+    {
+        // The descriptor set is freed along with its pool
+        vkDestroyDescriptorPool(getDevice(), getDescriptorPool(), nullptr);
+        vkDestroyDescriptorSetLayout(getDevice(), getDescriptorSetLayout(), nullptr);
+        m_textures.clear();
+        m_samplers.clear();
+    }
+
+    BindlessTextureTable* BindlessTextureTable::createImpl(VkDevice device, BindlessTableInfo info)
+    {
+        // ============ Clamp to device limits ============= //
+
+        VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProps {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT,
+        };
+        VkPhysicalDeviceProperties2 props {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &indexingProps,
+        };
+        vkGetPhysicalDeviceProperties2(App::current()->getState().vk.physicalDevice, &props);
+
+        const uint32_t maxTextures = std::min({info.maxTextures,
+                                               indexingProps.maxDescriptorSetUpdateAfterBindSampledImages,
+                                               indexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages});
+        const uint32_t maxSamplers = std::min({info.maxSamplers,
+                                               indexingProps.maxDescriptorSetUpdateAfterBindSamplers,
+                                               indexingProps.maxPerStageDescriptorUpdateAfterBindSamplers});
+        if ((maxTextures < info.maxTextures || maxSamplers < info.maxSamplers) && App::current()->getPrintDbg())
+        {
+            std::cout << utils::makeWarningMessage("VK::CREATE",
+                                                   "Bindless texture table capacity was clamped to device limits")
+                      << std::endl;
+        }
+        info.maxTextures = maxTextures;
+        info.maxSamplers = maxSamplers;
+
+        // ============== Descriptor Set Layout =============== //
+
+        const std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
+            {
+                .binding         = TextureBinding,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+                .descriptorCount = info.maxTextures,
+                .stageFlags      = E_ShaderStage::All,
+            },
+            {
+                .binding         = SamplerBinding,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER,
+                .descriptorCount = info.maxSamplers,
+                .stageFlags      = E_ShaderStage::All,
+            },
+        }};
+        // Slots are filled lazily and may change while the set is bound
+        const std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT,
+        };
+        const VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT,
+            .bindingCount  = static_cast<uint32_t>(bindingFlags.size()),
+            .pBindingFlags = bindingFlags.data(),
+        };
+        const VkDescriptorSetLayoutCreateInfo layoutInfo {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .pNext        = &bindingFlagsInfo,
+            .flags        = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT,
+            .bindingCount = static_cast<uint32_t>(bindings.size()),
+            .pBindings    = bindings.data(),
+        };
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create bindless descriptor set layout"));
+        }
+
+        // ================ Descriptor Pool ================= //
+
+        const std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+            {.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, .descriptorCount = info.maxTextures},
+            {.type = VK_DESCRIPTOR_TYPE_SAMPLER, .descriptorCount = info.maxSamplers},
+        }};
+        const VkDescriptorPoolCreateInfo poolInfo {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .flags         = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT,
+            .maxSets       = 1,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+            .pPoolSizes    = poolSizes.data(),
+        };
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        {
+            vkDestroyDescriptorSetLayout(device, layout, nullptr);
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create bindless descriptor pool"));
+        }
+
+        // ================= Descriptor Set ================= //
+
+        const VkDescriptorSetAllocateInfo allocInfo {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout,
+        };
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+        {
+            vkDestroyDescriptorPool(device, pool, nullptr);
+            vkDestroyDescriptorSetLayout(device, layout, nullptr);
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::PIPELINE", "Failed to allocate bindless descriptor set"));
+        }
+
+        if (App::current()->getPrintDbg())
+        {
+            std::string description = "Created bindless texture table with ";
+            description += std::to_string(info.maxTextures) + " texture and ";
+            description += std::to_string(info.maxSamplers) + " sampler slots";
+            std::cout << utils::makeSuccessMessage("VK::CREATE", description) << std::endl;
+        }
+
+        return new BindlessTextureTable(device, pool, layout, set, info);
+    }
+
+    uint32_t BindlessTextureTable::addTexture(const Image::Ptr& image)
+    {
+        VkImageView view = image->getImageView();
+        if (auto it = m_textureIndices.find(view); it != m_textureIndices.end())
+            return it->second;
+
+        uint32_t index;
+        if (!m_freeTextures.empty())
+        {
+            index = m_freeTextures.back();
+            m_freeTextures.pop_back();
+            m_textures[index] = image;
+        }
+        else
+        {
+            if (m_textures.size() >= m_info.maxTextures)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::TEX", "Bindless texture table is full"));
+            }
+            index = static_cast<uint32_t>(m_textures.size());
+            m_textures.push_back(image);
+        }
+
+        const VkDescriptorImageInfo imageInfo {
+            .sampler     = VK_NULL_HANDLE,
+            .imageView   = view,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        };
+        const VkWriteDescriptorSet write {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = getDescriptorSet(),
+            .dstBinding      = TextureBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,
+            .pImageInfo      = &imageInfo,
+        };
+        vkUpdateDescriptorSets(getDevice(), 1, &write, 0, nullptr);
+
+        m_textureIndices.emplace(view, index);
+        ++m_textureCount;
+        return index;
+    }
+
+    void BindlessTextureTable::removeTexture(uint32_t index)
+    {
+        if (index >= m_textures.size() || !m_textures[index])
+            return;
+
+        // The slot is left as is; partially bound descriptors only need to be valid when accessed
+        m_textureIndices.erase(m_textures[index]->getImageView());
+        m_textures[index].reset();
+        m_freeTextures.push_back(index);
+        --m_textureCount;
+    }
+
+    uint32_t BindlessTextureTable::addSampler(const Sampler::Ptr& sampler)
+    {
+        VkSampler handle = sampler->getSampler();
+        if (auto it = m_samplerIndices.find(handle); it != m_samplerIndices.end())
+            return it->second;
+
+        if (m_samplers.size() >= m_info.maxSamplers)
+        {
+            throw std::runtime_error(utils::makeErrorMessage("VK::TEX", "Bindless sampler table is full"));
+        }
+        const auto index = static_cast<uint32_t>(m_samplers.size());
+        m_samplers.push_back(sampler);
+
+        const VkDescriptorImageInfo samplerInfo {
+            .sampler = handle,
+        };
+        const VkWriteDescriptorSet write {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = getDescriptorSet(),
+            .dstBinding      = SamplerBinding,
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_SAMPLER,
+            .pImageInfo      = &samplerInfo,
+        };
+        vkUpdateDescriptorSets(getDevice(), 1, &write, 0, nullptr);
+
+        m_samplerIndices.emplace(handle, index);
+        return index;
+    }
+} // namespace ivulk
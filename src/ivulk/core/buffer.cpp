@@ -73,17 +73,38 @@ namespace ivulk {
             m_count = *newCount;
     }
 
+    void Buffer::readBuffer(void* data, VkDeviceSize sz)
+    {
+        auto state     = App::current()->getState();
+        auto allocator = state.vk.allocator;
+        void* mappedData;
+        vmaMapMemory(allocator, getAllocation(), &mappedData);
+        vmaInvalidateAllocation(allocator, getAllocation(), 0, sz);
+        std::memcpy(data, mappedData, sz);
+        vmaUnmapMemory(allocator, getAllocation());
+    }
+
     void Buffer::copyFromBuffer(Buffer::Ref srcBuf, VkDeviceSize size, bool copyCount)
     {
-        auto state = App::current()->getState();
         if (auto sb = srcBuf.lock())
         {
             if (copyCount)
                 m_count = sb->m_count;
+            copyRegionFromBuffer(sb, 0, 0, size);
+        }
+    }
 
+    void Buffer::copyRegionFromBuffer(Buffer::Ref srcBuf,
+                                      VkDeviceSize srcOffset,
+                                      VkDeviceSize dstOffset,
+                                      VkDeviceSize size)
+    {
+        auto state = App::current()->getState();
+        if (auto sb = srcBuf.lock())
+        {
             vk::BufferCopy cpyRegion {};
-            cpyRegion.setSrcOffset(0);
-            cpyRegion.setDstOffset(0);
+            cpyRegion.setSrcOffset(srcOffset);
+            cpyRegion.setDstOffset(dstOffset);
             cpyRegion.setSize(size);
 
             auto cmdBufs = CommandBuffers::create(getDevice(),
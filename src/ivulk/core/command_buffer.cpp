@@ -8,17 +8,36 @@
 
 #include <ivulk/utils/messages.hpp>
 
+#include <cstring>
+
 namespace ivulk {
-    void CommandBuffers::startImpl(std::size_t index, vk::CommandBufferUsageFlags flags)
+    void CommandBuffers::startImpl(const StartCallInfo& callInfo)
     {
         if (m_currentIdx.has_value())
             throw std::runtime_error(
                 utils::makeErrorMessage("VK::CMD", "Command buffer recording already started"));
 
         vk::CommandBufferBeginInfo beginInfo {};
-        beginInfo.flags = flags;
+        beginInfo.flags = callInfo.flags;
 
-        vk::CommandBuffer cmdBuf = getCmdBuffer(index);
+        // Secondary command buffers always need inheritance info, even outside a render pass
+        vk::CommandBufferInheritanceInfo inheritance {};
+        if (m_level == vk::CommandBufferLevel::eSecondary)
+        {
+            inheritance.setRenderPass(callInfo.renderPass)
+                .setSubpass(callInfo.subpass)
+                .setFramebuffer(callInfo.framebuffer);
+            if (callInfo.renderPass)
+                beginInfo.flags |= vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+            beginInfo.pInheritanceInfo = &inheritance;
+        }
+        else if (callInfo.renderPass)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::CMD", "Only secondary command buffers can continue a render pass"));
+        }
+
+        vk::CommandBuffer cmdBuf = getCmdBuffer(callInfo.index);
         auto r = cmdBuf.begin(beginInfo);
         if (r != vk::Result::eSuccess)
         {
@@ -26,52 +45,146 @@ namespace ivulk {
                 utils::makeErrorMessage("VK::CMD", "Failed to start command buffer recording"));
         }
 
-        m_currentIdx = index;
+        m_currentIdx = callInfo.index;
+        m_bound      = {};
+        m_pipeline.reset();
     }
     void CommandBuffers::finish()
     {
         if (!m_currentIdx.has_value())
             throw std::runtime_error(
                 utils::makeErrorMessage("VK::CMD", "Command buffer recording not started"));
-        m_currentIdx = {};
-        
+
         vk::CommandBuffer cmdBuf = getCmdBuffer(*m_currentIdx);
+        m_currentIdx             = {};
         if (cmdBuf.end() != vk::Result::eSuccess)
             throw std::runtime_error(
                 utils::makeErrorMessage("VK::CMD", "Failed to finish command buffer recording"));
     }
 
-    void CommandBuffers::drawImpl(std::weak_ptr<Buffer> vertexBuffer,
-                                  std::weak_ptr<Buffer> indexBuffer,
-                                  uint32_t vertices,
-                                  uint32_t instances,
-                                  uint32_t firstVertex,
-                                  uint32_t firstInstance)
+    void CommandBuffers::executeCommands(const std::vector<vk::CommandBuffer>& cmdBufs)
+    {
+        if (!m_currentIdx.has_value())
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CMD", "Command buffer recording not started"));
+        if (cmdBufs.empty())
+            return;
+
+        getCmdBuffer(*m_currentIdx).executeCommands(cmdBufs);
+        m_bound = {};
+        m_pipeline.reset();
+    }
+
+    void CommandBuffers::bindVertexBuffers(vk::CommandBuffer cmdBuf,
+                                           const std::shared_ptr<Buffer>& vertexBuffer,
+                                           const std::shared_ptr<Buffer>& indexBuffer,
+                                           const std::shared_ptr<Buffer>& instanceBuffer,
+                                           uint32_t instanceBinding)
+    {
+        if (instanceBuffer)
+        {
+            if (m_bound.instanceBuffer != instanceBuffer->getBuffer()
+                || m_bound.instanceBinding != instanceBinding)
+            {
+                vk::Buffer buffers[]   = {instanceBuffer->getBuffer()};
+                VkDeviceSize offsets[] = {0};
+                cmdBuf.bindVertexBuffers(instanceBinding, 1, buffers, offsets);
+                m_bound.instanceBuffer  = instanceBuffer->getBuffer();
+                m_bound.instanceBinding = instanceBinding;
+                ++m_stats.vertexBufferBinds;
+            }
+            else
+                ++m_stats.vertexBufferBindsSkipped;
+        }
+        if (vertexBuffer)
+        {
+            if (m_bound.vertexBuffer != vertexBuffer->getBuffer())
+            {
+                vk::Buffer buffers[]   = {vertexBuffer->getBuffer()};
+                VkDeviceSize offsets[] = {0};
+                cmdBuf.bindVertexBuffers(0, 1, buffers, offsets);
+                m_bound.vertexBuffer = vertexBuffer->getBuffer();
+                ++m_stats.vertexBufferBinds;
+            }
+            else
+                ++m_stats.vertexBufferBindsSkipped;
+        }
+        if (indexBuffer)
+        {
+            if (m_bound.indexBuffer != indexBuffer->getBuffer())
+            {
+                cmdBuf.bindIndexBuffer(indexBuffer->getBuffer(), 0, vk::IndexType::eUint32);
+                m_bound.indexBuffer = indexBuffer->getBuffer();
+                ++m_stats.indexBufferBinds;
+            }
+            else
+                ++m_stats.indexBufferBindsSkipped;
+        }
+    }
+
+    void CommandBuffers::drawImpl(const DrawCallInfo& callInfo)
     {
         if (!m_currentIdx.has_value())
             m_currentIdx = 0;
 
         vk::CommandBuffer cmdBuf = getCmdBuffer(*m_currentIdx);
-        auto count     = vertices;
+        auto count     = callInfo.vertices;
         bool isIndexed = false;
-        if (auto vbuf = vertexBuffer.lock())
+        auto vbuf      = callInfo.vertexBuffer.lock();
+        auto ibuf      = vbuf ? callInfo.indexBuffer.lock() : Buffer::Ptr {};
+        bindVertexBuffers(cmdBuf, vbuf, ibuf, callInfo.instanceBuffer.lock(), callInfo.instanceBinding);
+        if (vbuf)
         {
-            vk::Buffer buffers[]     = {vbuf->getBuffer()};
-            VkDeviceSize offsets[] = {0};
-            cmdBuf.bindVertexBuffers(0, 1, buffers, offsets);
             if (count == 0)
                 count = vbuf->getCount();
-            if (auto ibuf = indexBuffer.lock())
+            if (ibuf)
             {
-                cmdBuf.bindIndexBuffer(ibuf->getBuffer(), 0, vk::IndexType::eUint32);
                 isIndexed = true;
-                count     = ibuf->getCount();
+                count     = callInfo.indices > 0u ? callInfo.indices : ibuf->getCount();
             }
         }
+        ++m_stats.draws;
         if (isIndexed)
-            cmdBuf.drawIndexed(count, 1, 0, 0, 0);
+        {
+            cmdBuf.drawIndexed(count,
+                               callInfo.instances,
+                               callInfo.firstIndex,
+                               callInfo.vertexOffset,
+                               callInfo.firstInstance);
+        }
         else
-            cmdBuf.draw(count, instances, firstVertex, firstInstance);
+            cmdBuf.draw(count, callInfo.instances, callInfo.firstVertex, callInfo.firstInstance);
+    }
+
+    void CommandBuffers::drawIndexedIndirectImpl(const DrawIndexedIndirectCallInfo& callInfo)
+    {
+        if (!m_currentIdx.has_value())
+            m_currentIdx = 0;
+
+        auto indirectBuf = callInfo.indirectBuffer.lock();
+        if (!indirectBuf || callInfo.drawCount == 0u)
+            return;
+
+        vk::CommandBuffer cmdBuf = getCmdBuffer(*m_currentIdx);
+        bindVertexBuffers(cmdBuf,
+                          callInfo.vertexBuffer.lock(),
+                          callInfo.indexBuffer.lock(),
+                          callInfo.instanceBuffer.lock(),
+                          callInfo.instanceBinding);
+
+        constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+        if (App::current()->getState().vk.features.bMultiDrawIndirect)
+        {
+            cmdBuf.drawIndexedIndirect(indirectBuf->getBuffer(), callInfo.offset, callInfo.drawCount, stride);
+            ++m_stats.indirectDraws;
+        }
+        else
+        {
+            for (uint32_t i = 0; i < callInfo.drawCount; ++i)
+                cmdBuf.drawIndexedIndirect(indirectBuf->getBuffer(), callInfo.offset + i * stride, 1, stride);
+            m_stats.indirectDraws += callInfo.drawCount;
+        }
+        m_stats.indirectDrawRecords += callInfo.drawCount;
     }
 
     void CommandBuffers::clearAttachmentsImpl(std::weak_ptr<GraphicsPipeline> pipeline, glm::vec4 color)
@@ -106,30 +219,115 @@ namespace ivulk {
 
         if (auto pl = pipeline.lock())
         {
+            m_pipeline = pl;
+            if (m_bound.pipeline == pl->getPipeline())
+            {
+                // Same pipeline, but the descriptor overrides may have changed since
+                ++m_stats.pipelineBindsSkipped;
+                bindDescriptorSetsFor(pl);
+                return;
+            }
+
             vkCmdBindPipeline(
                 getCmdBuffer(*m_currentIdx), VK_PIPELINE_BIND_POINT_GRAPHICS, pl->getPipeline());
+            m_bound.pipeline       = pl->getPipeline();
+            m_bound.pipelineLayout = pl->getPipelineLayout();
+            ++m_stats.pipelineBinds;
 
-            if (pl->getDescriptorSets().size() > 0)
+            // Sets stay bound up to the first slot where the layouts stop being compatible
+            bool bCompatible = m_bound.pushConstantSize == pl->getPushConstantSize();
+            for (uint32_t i = 0; i < E_DescriptorFrequency::Count; ++i)
             {
-                auto descrSet = pl->getDescriptorSetAt(*m_currentIdx);
-                vkCmdBindDescriptorSets(getCmdBuffer(*m_currentIdx),
-                                        VK_PIPELINE_BIND_POINT_GRAPHICS,
-                                        pl->getPipelineLayout(),
-                                        0,
-                                        1,
-                                        &descrSet,
-                                        0,
-                                        nullptr);
+                bCompatible = bCompatible && m_bound.layouts[i] == pl->getSetLayoutAt(i);
+                if (!bCompatible)
+                {
+                    m_bound.layouts[i] = pl->getSetLayoutAt(i);
+                    m_bound.sets[i]    = VK_NULL_HANDLE;
+                }
             }
+            // Push constants stay valid across pipelines with the same push constant range
+            if (m_bound.pushConstantSize != pl->getPushConstantSize())
+                m_bound.pushValid.reset();
+            m_bound.pushConstantSize = pl->getPushConstantSize();
+
+            bindDescriptorSetsFor(pl);
         }
     }
 
+    void CommandBuffers::bindDescriptorSetsFor(const std::shared_ptr<GraphicsPipeline>& pl)
+    {
+        for (uint32_t i = 0; i < E_DescriptorFrequency::Count; ++i)
+        {
+            if (pl->getSetLayoutAt(i) == VK_NULL_HANDLE)
+                continue;
+
+            VkDescriptorSet set = pl->getDefaultSetAt(i, *m_currentIdx);
+            if (i < m_overrides.size() && m_overrides[i] && m_overrides[i]->getLayout() == pl->getSetLayoutAt(i))
+                set = m_overrides[i]->getDescriptorSet();
+
+            if (set == VK_NULL_HANDLE)
+                continue;
+            if (set == m_bound.sets[i])
+            {
+                ++m_stats.descriptorSetBindsSkipped;
+                continue;
+            }
+
+            vkCmdBindDescriptorSets(getCmdBuffer(*m_currentIdx),
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                    pl->getPipelineLayout(),
+                                    i,
+                                    1,
+                                    &set,
+                                    0,
+                                    nullptr);
+            m_bound.sets[i] = set;
+            ++m_stats.descriptorSetBinds;
+        }
+    }
+
+    void CommandBuffers::overrideDescriptorSet(std::shared_ptr<DescriptorSet> set)
+    {
+        if (!set)
+            return;
+        m_overrides.at(set->getFrequency()) = set;
+        if (auto pl = m_pipeline.lock())
+            bindDescriptorSetsFor(pl);
+    }
+
+    void CommandBuffers::clearDescriptorOverride(uint32_t slot) { m_overrides.at(slot).reset(); }
+
     void CommandBuffers::pushConstantsImpl(const void* data, VkPipelineLayout layout, VkShaderStageFlags stages, VkDeviceSize offset, VkDeviceSize size)
     {
         if (!m_currentIdx.has_value())
             m_currentIdx = 0;
 
+        // Only updates through the bound pipeline's layout are known to land in the tracked range
+        const bool bTracked = layout == m_bound.pipelineLayout && offset + size <= TrackedPushConstantSize;
+        if (bTracked && stages == m_bound.pushStages)
+        {
+            bool bSame = std::memcmp(m_bound.pushData.data() + offset, data, size) == 0;
+            for (auto i = offset; bSame && i < offset + size; ++i)
+                bSame = m_bound.pushValid[i];
+            if (bSame)
+            {
+                ++m_stats.pushConstantsSkipped;
+                return;
+            }
+        }
+
         vkCmdPushConstants(getCmdBuffer(*m_currentIdx), layout, stages, offset, size, data);
+        ++m_stats.pushConstants;
+
+        if (!bTracked || stages != m_bound.pushStages)
+            m_bound.pushValid.reset();
+        if (bTracked)
+        {
+            std::memcpy(m_bound.pushData.data() + offset, data, size);
+            for (auto i = offset; i < offset + size; ++i)
+                m_bound.pushValid[i] = true;
+            m_bound.pushStages = stages;
+        }
     }
 
 } // namespace ivulk
@@ -0,0 +1,42 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/command_pool.hpp>
+
+#include <ivulk/utils/messages.hpp>
+
+#include <stdexcept>
+
+namespace ivulk {
+    CommandPool::CommandPool(VkDevice device, vk::CommandPool pool)
+        : base_t(device, handles_t {pool})
+    { }
+
+    CommandPool* CommandPool::createImpl(VkDevice device, CommandPoolCreateInfo createInfo)
+    {
+        VkCommandPoolCreateInfo poolInfo {
+            .sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .flags            = static_cast<VkCommandPoolCreateFlags>(createInfo.flags),
+            .queueFamilyIndex = createInfo.queueFamily,
+        };
+
+        VkCommandPool pool = VK_NULL_HANDLE;
+        if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan command pool"));
+        }
+        return new CommandPool(device, pool);
+    }
+
+    void CommandPool::reset()
+    {
+        if (vkResetCommandPool(getDevice(), getCmdPool(), 0u) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CMD", "Failed to reset Vulkan command pool"));
+        }
+    }
+
+    void CommandPool::destroyImpl() { vkDestroyCommandPool(getDevice(), getCmdPool(), nullptr); }
+} // namespace ivulk
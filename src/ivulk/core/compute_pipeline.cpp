@@ -0,0 +1,106 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/compute_pipeline.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/shader_module_cache.hpp>
+#include <ivulk/core/shader_stage.hpp>
+
+namespace ivulk {
+
+    ComputePipeline::ComputePipeline(vk::Device device,
+                                     vk::Pipeline pipeline,
+                                     vk::PipelineLayout pipelineLayout,
+                                     vk::DescriptorSetLayout descrSetLayout)
+        : base_t(device, handles_t {pipeline, pipelineLayout, descrSetLayout})
+    { }
+
+    void ComputePipeline::destroyImpl()
+    {
+        vk::Device device(getDevice());
+        device.destroy(getPipeline());
+        device.destroy(getPipelineLayout());
+        device.destroy(getDescriptorSetLayout());
+    }
+
+    ComputePipeline* ComputePipeline::createImpl(VkDevice _device, ComputePipelineInfo info)
+    {
+        vk::Device device(_device);
+
+        // ============== Descriptor Set =============== //
+
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        bindings.reserve(info.descriptor.bindings.size());
+        for (const auto& b : info.descriptor.bindings)
+        {
+            vk::DescriptorSetLayoutBinding binding {};
+            binding.setBinding(b.binding)
+                .setDescriptorType(vk::DescriptorType(b.type))
+                .setDescriptorCount(b.count)
+                .setStageFlags(vk::ShaderStageFlags(E_ShaderStage::Compute));
+            bindings.push_back(binding);
+        }
+
+        vk::DescriptorSetLayoutCreateInfo descrSetLayoutInfo {};
+        descrSetLayoutInfo.setBindingCount(bindings.size()).setPBindings(bindings.data());
+        auto _descrL = device.createDescriptorSetLayout(descrSetLayoutInfo);
+        if (_descrL.result != vk::Result::eSuccess)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create compute descriptor set layout"));
+        }
+        vk::DescriptorSetLayout descrSetLayout = _descrL.value;
+
+        // ============= Pipeline Layout ============== //
+
+        vk::PushConstantRange pushConstantRange {};
+        pushConstantRange.setStageFlags(vk::ShaderStageFlags(E_ShaderStage::Compute))
+            .setOffset(0u)
+            .setSize(info.pushConstantSize);
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.setSetLayoutCount(1u)
+            .setPSetLayouts(&descrSetLayout)
+            .setPushConstantRangeCount(info.pushConstantSize > 0u ? 1u : 0u)
+            .setPPushConstantRanges(info.pushConstantSize > 0u ? &pushConstantRange : nullptr);
+
+        auto _plLayout = device.createPipelineLayout(pipelineLayoutInfo);
+        if (_plLayout.result != vk::Result::eSuccess)
+        {
+            device.destroy(descrSetLayout);
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan compute pipeline layout"));
+        }
+        vk::PipelineLayout pipelineLayout = _plLayout.value;
+
+        // ============= Create Pipeline ============== //
+
+        // Held until the pipeline is created, in case the module is replaced meanwhile
+        const auto shaderModule = ShaderModuleCache::acquire(info.shaderPath);
+
+        const SpecializationData specialization(info.specialization);
+
+        vk::PipelineShaderStageCreateInfo stage {};
+        stage.setStage(vk::ShaderStageFlagBits::eCompute)
+            .setModule(shaderModule.get())
+            .setPName("main")
+            .setPSpecializationInfo(reinterpret_cast<const vk::SpecializationInfo*>(specialization.get()));
+
+        vk::ComputePipelineCreateInfo pipelineInfo {};
+        pipelineInfo.setStage(stage).setLayout(pipelineLayout).setBasePipelineIndex(-1);
+
+        vk::Pipeline computePipeline;
+        auto _pl = device.createComputePipelines(
+            App::current()->getState().vk.pipelines.cache, 1, &pipelineInfo, nullptr, &computePipeline);
+        if (_pl != vk::Result::eSuccess)
+        {
+            device.destroy(pipelineLayout);
+            device.destroy(descrSetLayout);
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan compute pipeline"));
+        }
+
+        return new ComputePipeline(device, computePipeline, pipelineLayout, descrSetLayout);
+    }
+} // namespace ivulk
@@ -0,0 +1,209 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/descriptor_allocator.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/utils/hash.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ivulk {
+
+    DescriptorAllocator::Ptr DescriptorAllocator::current()
+    {
+        return App::current()->getState().vk.descriptor.allocator;
+    }
+
+    uint64_t DescriptorAllocator::hashBindings(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+    {
+        // Binding order doesn't affect the layout definition
+        auto sorted = bindings;
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+
+        uint64_t key = utils::FNV1a64OffsetBasis;
+        for (const auto& b : sorted)
+        {
+            utils::hashCombine(key, b.binding);
+            utils::hashCombine(key, b.descriptorType);
+            utils::hashCombine(key, b.descriptorCount);
+            utils::hashCombine(key, b.stageFlags);
+        }
+        return key;
+    }
+
+    DescriptorAllocator::DescriptorAllocator(VkDevice device, DescriptorAllocatorInfo info)
+        : base_t(device, handles_t {})
+        , m_info(info)
+        , m_stats {}
+        , m_persistent {.nextSets = info.initialSets}
+        , m_frames(info.framesInFlight, PoolChain {.nextSets = info.initialSets})
+    { }
+
+    DescriptorAllocator* DescriptorAllocator::createImpl(VkDevice device, DescriptorAllocatorInfo info)
+    {
+        info.initialSets    = std::max(info.initialSets, 1u);
+        info.maxSetsPerPool = std::max(info.maxSetsPerPool, info.initialSets);
+        info.framesInFlight = std::max(info.framesInFlight, 1u);
+        return new DescriptorAllocator(device, info);
+    }
+
+    void DescriptorAllocator::destroyImpl()
+    {
+        // Sets are freed along with their pools
+        for (auto pool : m_persistent.pools)
+            vkDestroyDescriptorPool(getDevice(), pool, nullptr);
+        for (auto& frame : m_frames)
+        {
+            for (auto pool : frame.pools)
+                vkDestroyDescriptorPool(getDevice(), pool, nullptr);
+        }
+        m_persistent = {};
+        m_frames.clear();
+        m_freeSets.clear();
+    }
+
+    VkDescriptorPool DescriptorAllocator::createPool(uint32_t sets)
+    {
+        std::vector<VkDescriptorPoolSize> poolSizes;
+        poolSizes.reserve(m_info.ratios.size());
+        for (const auto& r : m_info.ratios)
+        {
+            const auto count = static_cast<uint32_t>(std::ceil(r.ratio * static_cast<float>(sets)));
+            if (count > 0u)
+                poolSizes.push_back({.type = r.type, .descriptorCount = count});
+        }
+
+        const VkDescriptorPoolCreateInfo poolInfo {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets       = sets,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+            .pPoolSizes    = poolSizes.data(),
+        };
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        if (vkCreateDescriptorPool(getDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan descriptor pool"));
+        }
+        if (App::current()->getPrintDbg())
+        {
+            std::string description = "Created descriptor pool with ";
+            description += std::to_string(sets) + " sets";
+            std::cout << utils::makeInfoMessage("VK::CREATE", description) << std::endl;
+        }
+        return pool;
+    }
+
+    VkDescriptorSet DescriptorAllocator::allocateFromChain(PoolChain& chain,
+                                                           VkDescriptorSetLayout layout,
+                                                           bool bPersistent)
+    {
+        bool bFreshPool = false;
+        while (true)
+        {
+            if (chain.current < chain.pools.size())
+            {
+                const VkDescriptorSetAllocateInfo allocInfo {
+                    .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                    .descriptorPool     = chain.pools[chain.current],
+                    .descriptorSetCount = 1,
+                    .pSetLayouts        = &layout,
+                };
+                VkDescriptorSet set = VK_NULL_HANDLE;
+                auto result         = vkAllocateDescriptorSets(getDevice(), &allocInfo, &set);
+                if (result == VK_SUCCESS)
+                    return set;
+
+                if ((result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL) || bFreshPool)
+                {
+                    throw std::runtime_error(
+                        utils::makeErrorMessage("VK::PIPELINE", "Failed to allocate Vulkan descriptor set"));
+                }
+
+                // Full pools are skipped until they are reset
+                ++chain.current;
+                continue;
+            }
+
+            chain.pools.push_back(createPool(chain.nextSets));
+            if (bPersistent)
+            {
+                ++m_stats.pools;
+                m_stats.poolCapacity += chain.nextSets;
+            }
+            else
+            {
+                ++m_stats.framePools;
+            }
+            chain.nextSets = std::min(chain.nextSets * 2u, m_info.maxSetsPerPool);
+            bFreshPool     = true;
+        }
+    }
+
+    std::vector<VkDescriptorSet> DescriptorAllocator::allocate(VkDescriptorSetLayout layout,
+                                                               uint64_t key,
+                                                               uint32_t count)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<VkDescriptorSet> sets;
+        sets.reserve(count);
+
+        auto& freeSets = m_freeSets[key];
+        while (sets.size() < count && !freeSets.empty())
+        {
+            sets.push_back(freeSets.back());
+            freeSets.pop_back();
+            ++m_stats.setsRecycled;
+            --m_stats.setsFree;
+        }
+        while (sets.size() < count)
+        {
+            sets.push_back(allocateFromChain(m_persistent, layout, true));
+            ++m_stats.setsAllocated;
+        }
+        return sets;
+    }
+
+    void DescriptorAllocator::free(uint64_t key, const std::vector<VkDescriptorSet>& sets)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& freeSets = m_freeSets[key];
+        freeSets.insert(freeSets.end(), sets.begin(), sets.end());
+        m_stats.setsFree += sets.size();
+    }
+
+    void DescriptorAllocator::retire(uint64_t key, const std::vector<VkDescriptorSet>& sets)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto& retired = m_frames[m_currentFrame].retired;
+        for (auto set : sets)
+            retired.emplace_back(key, set);
+        m_stats.setsRetired += sets.size();
+    }
+
+    VkDescriptorSet DescriptorAllocator::allocateFrame(VkDescriptorSetLayout layout)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.frameSets;
+        return allocateFromChain(m_frames[m_currentFrame], layout, false);
+    }
+
+    void DescriptorAllocator::beginFrame(std::size_t frameIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_currentFrame = frameIndex % m_frames.size();
+        auto& frame    = m_frames[m_currentFrame];
+        for (std::size_t i = 0; i < frame.pools.size() && i <= frame.current; ++i)
+            vkResetDescriptorPool(getDevice(), frame.pools[i], 0);
+        frame.current = 0u;
+
+        for (const auto& [key, set] : frame.retired)
+            m_freeSets[key].push_back(set);
+        m_stats.setsFree += frame.retired.size();
+        m_stats.setsRetired -= frame.retired.size();
+        frame.retired.clear();
+    }
+} // namespace ivulk
@@ -0,0 +1,157 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/descriptor_layout_cache.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/descriptor_allocator.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ivulk {
+
+    struct DescriptorLayoutCacheInstance
+    {
+        // Entries sharing a hash are compared binding by binding
+        std::unordered_map<uint64_t,
+                           std::vector<std::pair<std::vector<VkDescriptorSetLayoutBinding>, VkDescriptorSetLayout>>>
+            layouts;
+        std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSetLayoutBinding>> bindings;
+        std::unordered_map<VkDescriptorSetLayout, DescriptorUpdateTemplate> templates;
+        DescriptorLayoutCacheStats stats;
+        std::mutex mutex;
+    };
+
+    DescriptorLayoutCacheInstance s_layoutCache;
+
+    bool layoutBindingsEqual(const std::vector<VkDescriptorSetLayoutBinding>& a,
+                             const std::vector<VkDescriptorSetLayoutBinding>& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto& x, const auto& y) {
+            return x.binding == y.binding && x.descriptorType == y.descriptorType
+                   && x.descriptorCount == y.descriptorCount && x.stageFlags == y.stageFlags;
+        });
+    }
+
+    VkDescriptorSetLayout DescriptorLayoutCache::get(const std::vector<VkDescriptorSetLayoutBinding>& bindings)
+    {
+        auto sorted = bindings;
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.binding < b.binding; });
+        const auto key = DescriptorAllocator::hashBindings(sorted);
+
+        std::lock_guard<std::mutex> lock(s_layoutCache.mutex);
+        ++s_layoutCache.stats.requests;
+        auto& bucket = s_layoutCache.layouts[key];
+        for (const auto& [cachedBindings, layout] : bucket)
+        {
+            if (layoutBindingsEqual(cachedBindings, sorted))
+            {
+                ++s_layoutCache.stats.hits;
+                return layout;
+            }
+        }
+
+        const VkDescriptorSetLayoutCreateInfo layoutInfo {
+            .sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+            .bindingCount = static_cast<uint32_t>(sorted.size()),
+            .pBindings    = sorted.data(),
+        };
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        if (vkCreateDescriptorSetLayout(App::current()->getState().vk.device, &layoutInfo, nullptr, &layout)
+            != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create descriptor set layout"));
+        }
+        s_layoutCache.bindings.emplace(layout, sorted);
+        bucket.emplace_back(std::move(sorted), layout);
+        ++s_layoutCache.stats.layouts;
+        return layout;
+    }
+
+    const DescriptorUpdateTemplate& DescriptorLayoutCache::getUpdateTemplate(VkDescriptorSetLayout layout)
+    {
+        std::lock_guard<std::mutex> lock(s_layoutCache.mutex);
+        if (auto it = s_layoutCache.templates.find(layout); it != s_layoutCache.templates.end())
+            return it->second;
+
+        auto bindingsIt = s_layoutCache.bindings.find(layout);
+        if (bindingsIt == s_layoutCache.bindings.end())
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::CREATE", "Descriptor update templates can only be created for cached layouts"));
+        }
+
+        // One tightly packed data element per descriptor, in binding order
+        DescriptorUpdateTemplate result {};
+        std::vector<VkDescriptorUpdateTemplateEntry> entries;
+        entries.reserve(bindingsIt->second.size());
+        for (const auto& b : bindingsIt->second)
+        {
+            if (b.descriptorCount == 0u)
+                continue;
+            result.dataIndices[b.binding] = result.dataCount;
+            result.dataCounts[b.binding]  = b.descriptorCount;
+            entries.push_back({
+                .dstBinding      = b.binding,
+                .dstArrayElement = 0u,
+                .descriptorCount = b.descriptorCount,
+                .descriptorType  = b.descriptorType,
+                .offset          = result.dataCount * sizeof(DescriptorTemplateData),
+                .stride          = sizeof(DescriptorTemplateData),
+            });
+            result.dataCount += b.descriptorCount;
+        }
+
+        if (!entries.empty())
+        {
+            const VkDescriptorUpdateTemplateCreateInfo templateInfo {
+                .sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO,
+                .descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size()),
+                .pDescriptorUpdateEntries   = entries.data(),
+                .templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET,
+                .descriptorSetLayout        = layout,
+            };
+            if (vkCreateDescriptorUpdateTemplate(
+                    App::current()->getState().vk.device, &templateInfo, nullptr, &result.handle)
+                != VK_SUCCESS)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::CREATE", "Failed to create descriptor update template"));
+            }
+            ++s_layoutCache.stats.templates;
+        }
+        return s_layoutCache.templates.emplace(layout, std::move(result)).first->second;
+    }
+
+    DescriptorLayoutCacheStats DescriptorLayoutCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(s_layoutCache.mutex);
+        return s_layoutCache.stats;
+    }
+
+    void DescriptorLayoutCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(s_layoutCache.mutex);
+        VkDevice device = App::current()->getState().vk.device;
+        for (const auto& [layout, updateTemplate] : s_layoutCache.templates)
+        {
+            if (updateTemplate.handle != VK_NULL_HANDLE)
+                vkDestroyDescriptorUpdateTemplate(device, updateTemplate.handle, nullptr);
+        }
+        for (const auto& [key, bucket] : s_layoutCache.layouts)
+        {
+            for (const auto& entry : bucket)
+                vkDestroyDescriptorSetLayout(device, entry.second, nullptr);
+        }
+        s_layoutCache.layouts.clear();
+        s_layoutCache.bindings.clear();
+        s_layoutCache.templates.clear();
+        s_layoutCache.stats = {};
+    }
+} // namespace ivulk
@@ -0,0 +1,117 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/descriptor_set.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/descriptor_allocator.hpp>
+#include <ivulk/core/descriptor_layout_cache.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <utility>
+
+namespace ivulk {
+
+    DescriptorSet::DescriptorSet(VkDevice device,
+                                 VkDescriptorSetLayout layout,
+                                 VkDescriptorSet set,
+                                 uint32_t frequency,
+                                 uint64_t key,
+                                 std::vector<DescriptorTemplateData> data)
+        : base_t(device, handles_t {layout, set})
+        , m_frequency(frequency)
+        , m_key(key)
+        , m_data(std::move(data))
+    { }
+
+    void DescriptorSet::destroyImpl()
+    {
+        // The layout belongs to the layout cache. Frames in flight may still use the set.
+        if (auto allocator = DescriptorAllocator::current())
+            allocator->retire(m_key, {getDescriptorSet()});
+    }
+
+    void DescriptorSet::fillTemplateData(const DescriptorUpdateTemplate& updateTemplate,
+                                         std::vector<DescriptorTemplateData>& data,
+                                         const std::vector<PipelineUniformBufferBinding>& ubos,
+                                         const std::vector<PipelineTextureBinding>& textures)
+    {
+        // Array bindings get the same descriptor in every element, so none is left stale
+        auto elementsOf = [&updateTemplate, &data](uint32_t binding) {
+            auto it = updateTemplate.dataIndices.find(binding);
+            if (it == updateTemplate.dataIndices.end())
+            {
+                throw std::runtime_error(utils::makeErrorMessage(
+                    "VK::PIPELINE", "Descriptor binding " + std::to_string(binding) + " is not in the set layout"));
+            }
+            const uint32_t count = updateTemplate.dataCounts.at(binding);
+            if (it->second + count > data.size())
+            {
+                throw std::runtime_error(utils::makeErrorMessage(
+                    "VK::PIPELINE", "Descriptor template data is too small for the set layout"));
+            }
+            return std::make_pair(data.begin() + it->second, data.begin() + it->second + count);
+        };
+
+        for (const auto& ubo : ubos)
+        {
+            const auto [first, last] = elementsOf(ubo.binding);
+            const auto info          = ubo.getDescriptorBufferInfo();
+            for (auto it = first; it != last; ++it)
+                it->buffer = info;
+        }
+        for (const auto& tex : textures)
+        {
+            const auto [first, last] = elementsOf(tex.binding);
+            const auto info          = tex.getDescriptorImageInfo();
+            for (auto it = first; it != last; ++it)
+                it->image = info;
+        }
+    }
+
+    void DescriptorSet::update(const std::vector<PipelineUniformBufferBinding>& ubos,
+                               const std::vector<PipelineTextureBinding>& textures)
+    {
+        const auto& updateTemplate = DescriptorLayoutCache::getUpdateTemplate(getLayout());
+        fillTemplateData(updateTemplate, m_data, ubos, textures);
+
+        // The old set may still be used by frames in flight, so write a new one
+        auto allocator = DescriptorAllocator::current();
+        auto set       = allocator->allocate(getLayout(), m_key).front();
+        if (updateTemplate.handle != VK_NULL_HANDLE)
+            vkUpdateDescriptorSetWithTemplate(getDevice(), set, updateTemplate.handle, m_data.data());
+
+        allocator->retire(m_key, {getDescriptorSet()});
+        std::get<1>(handles) = set;
+    }
+
+    DescriptorSet* DescriptorSet::createImpl(VkDevice device, DescriptorSetInfo info)
+    {
+        if (info.frequency >= E_DescriptorFrequency::Bindless)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::PIPELINE", "Descriptor sets can only be created for the frame, pass and material slots"));
+        }
+
+        std::vector<VkDescriptorSetLayoutBinding> bindings;
+        bindings.reserve(info.uboBindings.size() + info.textureBindings.size());
+        for (auto& ubo : info.uboBindings)
+            bindings.push_back(ubo.getDescriptorSetLayoutBinding());
+        for (auto& tex : info.textureBindings)
+            bindings.push_back(tex.getDescriptorSetLayoutBinding());
+
+        auto layout    = DescriptorLayoutCache::get(bindings);
+        const auto key = DescriptorAllocator::hashBindings(bindings);
+        auto set       = DescriptorAllocator::current()->allocate(layout, key).front();
+
+        // ============== Write descriptors =============== //
+
+        const auto& updateTemplate = DescriptorLayoutCache::getUpdateTemplate(layout);
+        std::vector<DescriptorTemplateData> data(updateTemplate.dataCount);
+        fillTemplateData(updateTemplate, data, info.uboBindings, info.textureBindings);
+        if (updateTemplate.handle != VK_NULL_HANDLE)
+            vkUpdateDescriptorSetWithTemplate(device, set, updateTemplate.handle, data.data());
+
+        return new DescriptorSet(device, layout, set, info.frequency, key, std::move(data));
+    }
+} // namespace ivulk
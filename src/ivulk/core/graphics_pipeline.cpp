@@ -5,63 +5,103 @@
 #include <ivulk/render/standard_shader.hpp>
 
 #include <ivulk/core/app.hpp>
+#include <ivulk/core/descriptor_layout_cache.hpp>
+#include <ivulk/core/shader_module_cache.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <exception>
+#include <mutex>
 
 namespace ivulk {
 
     namespace fs = boost::filesystem;
 
-    void GraphicsPipeline::recreate(GraphicsPipelineInfo info)
+    struct AsyncPipelineInstance
     {
-        auto* tmpPipeline = createImpl(getDevice(), info);
-        destroy();
-        handles = tmpPipeline->handles;
-        setDestroyed(false);
-        tmpPipeline->setDestroyed(true);
-        delete tmpPipeline;
-    }
+        std::mutex mutex;
+        std::vector<GraphicsPipeline::Ref> pending; ///< Pipelines whose new handles aren't ready yet
+        std::vector<GraphicsPipeline::Ref> live;    ///< Pipelines that `recreateAsync` can rebuild
+    };
+
+    AsyncPipelineInstance s_asyncPipelines;
 
-    std::vector<char> GraphicsPipeline::readSPIRVFile(const fs::path& fpath)
+    std::vector<fs::path> getPipelineShaderPaths(const GraphicsPipelineInfo& info)
     {
-        auto p = fpath.lexically_normal();
-        std::ifstream f(p, std::ios::ate | std::ios::binary);
-        if (!f.is_open())
+        std::vector<fs::path> paths;
+        for (const auto& path : {info.shaderPath.vert,
+                                 info.shaderPath.frag,
+                                 info.shaderPath.tese,
+                                 info.shaderPath.tesc,
+                                 info.shaderPath.geom,
+                                 info.shaderPath.comp})
         {
-            std::string description = "Failed to open file for reading: `";
-            description += p.string() + "`";
-            throw std::runtime_error(utils::makeErrorMessage("FILE", description));
+            if (path)
+                paths.push_back(*path);
         }
-        auto fileSize = f.tellg();
-        std::vector<char> buffer(fileSize);
-        f.seekg(0);
-        f.read(buffer.data(), fileSize);
-        f.close();
-        return buffer;
+        return paths;
     }
 
-    vk::ShaderModule GraphicsPipeline::createShaderModule(VkDevice _device,
-                                                          const std::vector<char>& shaderCode,
-                                                          const fs::path& assetPath)
+    template <typename Binding>
+    void mergePipelineBindings(std::vector<Binding>& bindings, const std::vector<Binding>& updates)
     {
-        vk::Device device(_device);
-        vk::ShaderModuleCreateInfo createInfo {};
-        createInfo.setCodeSize(shaderCode.size())
-            .setPCode(reinterpret_cast<const uint32_t*>(shaderCode.data()));
-        auto shaderModule = device.createShaderModule(createInfo);
-        if (shaderModule.result != vk::Result::eSuccess)
+        for (const auto& update : updates)
         {
-            std::string description = "Failed to create Vulkan shader module from shader: `";
-            description += assetPath.string() + "`";
-            throw std::runtime_error(utils::makeErrorMessage("VK::CREATE", description));
+            auto it = std::find_if(bindings.begin(), bindings.end(), [&](const auto& b) {
+                return b.binding == update.binding;
+            });
+            if (it != bindings.end())
+                *it = update;
+            else
+                bindings.push_back(update);
         }
-        else if (App::current()->getPrintDbg())
+    }
+
+    void GraphicsPipeline::track(const Ptr& pipeline)
+    {
+        std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+        auto& live = s_asyncPipelines.live;
+
+        // Drop released pipelines whenever the list would have to grow
+        if (live.size() == live.capacity())
         {
-            std::string description = "Created Vulkan shader module from shader: `";
-            description += assetPath.string() + "`";
-            std::cout << utils::makeSuccessMessage("VK::CREATE", description) << std::endl;
+            live.erase(std::remove_if(live.begin(), live.end(), [](const auto& ref) { return ref.expired(); }),
+                       live.end());
         }
-        return shaderModule.value;
+        live.push_back(pipeline);
+    }
+
+    GraphicsPipeline::Ptr GraphicsPipeline::create(VkDevice device, const GraphicsPipelineInfo& info)
+    {
+        auto pipeline = base_t::create(device, info);
+        track(pipeline);
+        return pipeline;
+    }
+
+    void GraphicsPipeline::adopt(GraphicsPipeline& other)
+    {
+        handles            = other.handles;
+        m_colorAttIndices  = other.m_colorAttIndices;
+        m_bBindless        = other.m_bBindless;
+        m_bSharedSets      = other.m_bSharedSets;
+        m_bInstanced       = other.m_bInstanced;
+        m_descrSetKey      = other.m_descrSetKey;
+        m_descrData        = other.m_descrData;
+        m_pushConstantSize = other.m_pushConstantSize;
+        m_setLayouts       = other.m_setLayouts;
+        m_sharedSets       = other.m_sharedSets;
+        m_info             = other.m_info;
+        setDestroyed(false);
+        other.setDestroyed(true);
+    }
+
+    void GraphicsPipeline::recreate(GraphicsPipelineInfo info)
+    {
+        auto* tmpPipeline = createImpl(getDevice(), info);
+        destroy();
+        adopt(*tmpPipeline);
+        delete tmpPipeline;
     }
 
     GraphicsPipeline::GraphicsPipeline(vk::Device device,
@@ -76,30 +116,333 @@ namespace ivulk {
 
     void GraphicsPipeline::destroyImpl()
     {
+        // A pending pipeline has no handles of its own. Wait for it, so it's destroyed on this thread.
+        if (m_pending.valid())
+            m_pending.wait();
+        m_pending = {};
+        m_fallback.reset();
+        m_deferredUpdates.clear();
+
         vk::Device device(getDevice());
         device.destroy(getPipeline());
         device.destroy(getPipelineLayout());
         device.destroy(getRenderPass());
-        device.destroy(getDescriptorSetLayout());
+
+        // Layouts belong to the layout cache, and sets can be reused by any pipeline with the same bindings
+        // once frames in flight are done with them
+        auto descrSets = getDescriptorSets();
+        if (auto allocator = DescriptorAllocator::current(); allocator && !descrSets.empty())
+        {
+            allocator->retire(m_descrSetKey, std::vector<VkDescriptorSet>(descrSets.begin(), descrSets.end()));
+        }
+        m_sharedSets = {};
+    }
+
+    VkDescriptorSet GraphicsPipeline::getDefaultSetAt(uint32_t slot, std::size_t imageIndex)
+    {
+        if (m_fallback)
+            return m_fallback->getDefaultSetAt(slot, imageIndex);
+
+        if (slot == E_DescriptorFrequency::Bindless)
+        {
+            if (!m_bBindless)
+                return VK_NULL_HANDLE;
+            return App::current()->getState().vk.bindless.table->getDescriptorSet();
+        }
+        if (m_bSharedSets)
+            return m_sharedSets.at(slot) ? m_sharedSets[slot]->getDescriptorSet() : VK_NULL_HANDLE;
+        if (slot == 0u && imageIndex < getDescriptorSets().size())
+            return getDescriptorSetAt(imageIndex);
+        return VK_NULL_HANDLE;
+    }
+
+    std::vector<std::future<GraphicsPipeline::Ptr>>
+    GraphicsPipeline::createBatch(VkDevice device, const std::vector<GraphicsPipelineInfo>& infos)
+    {
+        auto pool = App::current()->getState().workers.pool;
+
+        const auto context = captureContext();
+
+        std::vector<std::future<Ptr>> results;
+        results.reserve(infos.size());
+        for (const auto& info : infos)
+        {
+            // Tracked like `create`'s pipelines, so shader hot reload rebuilds them too
+            results.push_back(pool->submit([device, info, context]() {
+                auto pipeline = Ptr(createWithContext(device, info, context));
+                track(pipeline);
+                return pipeline;
+            }));
+        }
+        return results;
+    }
+
+    GraphicsPipeline::Ptr
+    GraphicsPipeline::createAsync(VkDevice device, GraphicsPipelineInfo info, Ptr fallback)
+    {
+        if (!fallback)
+            return create(device, info);
+
+        auto pool     = App::current()->getState().workers.pool;
+        auto pipeline = Ptr(new GraphicsPipeline(device, {}, {}, {}, {}, {}));
+        pipeline->m_info     = info;
+        pipeline->m_fallback = std::move(fallback);
+        pipeline->m_pending  = pool->submit([device, info, context = captureContext()]() {
+            return Ptr(createWithContext(device, info, context));
+        });
+        track(pipeline);
+
+        std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+        s_asyncPipelines.pending.push_back(pipeline);
+        return pipeline;
+    }
+
+    std::set<fs::path> GraphicsPipeline::getShaderPaths()
+    {
+        std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+        std::set<fs::path> paths;
+        for (const auto& ref : s_asyncPipelines.live)
+        {
+            auto pipeline = ref.lock();
+            if (!pipeline || pipeline->isDestroyed())
+                continue;
+            for (const auto& path : getPipelineShaderPaths(pipeline->m_info))
+                paths.insert(path);
+        }
+        return paths;
+    }
+
+    std::size_t GraphicsPipeline::recreateAsync(const std::set<fs::path>& shaderPaths,
+                                                const std::vector<std::shared_future<bool>>& ready)
+    {
+        std::vector<Ptr> pipelines;
+        {
+            std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+            for (const auto& ref : s_asyncPipelines.live)
+            {
+                if (auto pipeline = ref.lock(); pipeline && !pipeline->isDestroyed())
+                    pipelines.push_back(pipeline);
+            }
+        }
+
+        auto pool          = App::current()->getState().workers.pool;
+        const auto context = captureContext();
+        std::size_t count  = 0u;
+        for (const auto& pipeline : pipelines)
+        {
+            const auto paths = getPipelineShaderPaths(pipeline->m_info);
+            const bool bAffected =
+                std::any_of(paths.begin(), paths.end(), [&](const auto& p) { return shaderPaths.count(p) > 0; });
+            if (!bAffected)
+                continue;
+
+            // A build that's already running is superseded, but it's left to finish on its worker. The pool
+            // runs tasks in order, so the futures waited on here are never stuck behind this task.
+            std::shared_future<Ptr> previous = {};
+            const bool bWasPending           = pipeline->m_pending.valid();
+            if (bWasPending)
+                previous = pipeline->m_pending.share();
+
+            pipeline->m_pending = pool->submit(
+                [device = pipeline->getDevice(), info = pipeline->m_info, context, ready, previous]() {
+                    if (previous.valid())
+                        previous.wait();
+                    for (const auto& r : ready)
+                    {
+                        if (!r.get())
+                            return Ptr {};
+                    }
+                    return Ptr(createWithContext(device, info, context));
+                });
+            ++count;
+
+            if (!bWasPending)
+            {
+                std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+                s_asyncPipelines.pending.push_back(pipeline);
+            }
+        }
+        return count;
+    }
+
+    void GraphicsPipeline::updateAsync()
+    {
+        std::vector<Ref> pending;
+        {
+            std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+            pending.swap(s_asyncPipelines.pending);
+        }
+
+        std::vector<Ref> stillPending;
+        std::exception_ptr error = nullptr;
+        for (const auto& ref : pending)
+        {
+            auto pipeline = ref.lock();
+            if (!pipeline || !pipeline->m_pending.valid())
+                continue;
+            if (pipeline->m_pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                stillPending.push_back(ref);
+                continue;
+            }
+
+            try
+            {
+                auto compiled = pipeline->m_pending.get();
+                auto updates  = std::move(pipeline->m_deferredUpdates);
+                pipeline->m_deferredUpdates.clear();
+
+                // A rebuild whose shaders failed to compile keeps the current handles. Its descriptor
+                // updates are already in `m_info`, so the next rebuild picks them up.
+                if (!compiled)
+                    continue;
+
+                // Nothing is in flight at the start of a frame, so replaced handles can go right away
+                pipeline->destroy();
+                pipeline->adopt(*compiled);
+
+                for (const auto& [ubos, textures] : updates)
+                    pipeline->updateDescriptors(ubos, textures);
+
+                if (App::current()->getPrintDbg())
+                {
+                    std::cout << utils::makeInfoMessage("VK::PIPELINE",
+                                                        "Switched to asynchronously created pipeline")
+                              << std::endl;
+                }
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(s_asyncPipelines.mutex);
+            s_asyncPipelines.pending.insert(
+                s_asyncPipelines.pending.end(), stillPending.begin(), stillPending.end());
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    void GraphicsPipeline::updateDescriptors(const std::vector<PipelineUniformBufferBinding>& ubos,
+                                             const std::vector<PipelineTextureBinding>& textures)
+    {
+        if (!m_fallback && m_bSharedSets)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::PIPELINE", "Pipelines using shared descriptor sets are updated through their sets"));
+        }
+
+        // Keep the bindings for rebuilds, and repeat the update on a pipeline that's being built
+        mergePipelineBindings(m_info.descriptor.uboBindings, ubos);
+        mergePipelineBindings(m_info.descriptor.textureBindings, textures);
+        if (m_pending.valid())
+            m_deferredUpdates.emplace_back(ubos, textures);
+
+        // The fallback's sets aren't ours to update
+        if (m_fallback)
+            return;
+
+        auto layout                = static_cast<VkDescriptorSetLayout>(getDescriptorSetLayout());
+        const auto& updateTemplate = DescriptorLayoutCache::getUpdateTemplate(layout);
+        DescriptorSet::fillTemplateData(updateTemplate, m_descrData, ubos, textures);
+
+        // The old sets may still be used by frames in flight, so write new ones
+        auto allocator = DescriptorAllocator::current();
+        auto oldSets   = getDescriptorSets();
+        auto newSets   = allocator->allocate(layout, m_descrSetKey, static_cast<uint32_t>(oldSets.size()));
+        if (updateTemplate.handle != VK_NULL_HANDLE)
+        {
+            for (auto set : newSets)
+                vkUpdateDescriptorSetWithTemplate(getDevice(), set, updateTemplate.handle, m_descrData.data());
+        }
+
+        allocator->retire(m_descrSetKey, std::vector<VkDescriptorSet>(oldSets.begin(), oldSets.end()));
+        std::get<4>(handles).assign(newSets.begin(), newSets.end());
+    }
+
+    GraphicsPipeline::CreateContext GraphicsPipeline::captureContext()
+    {
+        const auto& state = App::current()->getState();
+        return {
+            .bindlessTable       = state.vk.bindless.table,
+            .descriptorAllocator = state.vk.descriptor.allocator,
+            .imageCount          = static_cast<uint32_t>(state.vk.swapChain.images.size()),
+            .extent              = state.vk.swapChain.extent,
+            .colorFormat         = state.vk.swapChain.format,
+            .depthFormat         = state.vk.swapChain.depthImage->getFormat(),
+            .cache               = state.vk.pipelines.cache,
+        };
     }
 
-    GraphicsPipeline* GraphicsPipeline::createImpl(VkDevice _device, GraphicsPipelineInfo info)
+    GraphicsPipeline* GraphicsPipeline::createImpl(VkDevice device, GraphicsPipelineInfo info)
+    {
+        return createWithContext(device, std::move(info), captureContext());
+    }
+
+    GraphicsPipeline* GraphicsPipeline::createWithContext(VkDevice _device,
+                                                          GraphicsPipelineInfo info,
+                                                          const CreateContext& context)
     {
         vk::Device device(_device);
-        auto state = App::current()->getState();
 
         // ============ Extract parameters ============= //
 
-        auto attribDescrs = info.vertex.attributes;
-        auto bindingDescr = info.vertex.binding;
-        auto textures     = info.descriptor.textureBindings;
-        auto ubos         = info.descriptor.uboBindings;
+        auto attribDescrs  = info.vertex.attributes;
+        auto bindingDescrs = std::vector<vk::VertexInputBindingDescription> {info.vertex.binding};
+        auto textures      = info.descriptor.textureBindings;
+        auto ubos          = info.descriptor.uboBindings;
+        if (info.instance.has_value())
+        {
+            bindingDescrs.push_back(info.instance->binding);
+            attribDescrs.insert(
+                attribDescrs.end(), info.instance->attributes.begin(), info.instance->attributes.end());
+        }
+
+        const SpecializationData specialization(info.specialization);
+
+        BindlessTextureTable::Ptr bindlessTable = {};
+        if (info.bBindless)
+        {
+            bindlessTable = context.bindlessTable;
+            if (!bindlessTable)
+            {
+                throw std::runtime_error(utils::makeErrorMessage(
+                    "VK::PIPELINE", "Bindless pipeline requested, but bindless textures are not enabled"));
+            }
+        }
+
+        std::array<DescriptorSet::Ptr, E_DescriptorFrequency::Bindless> sharedSets = {
+            info.sets.frame.lock(),
+            info.sets.pass.lock(),
+            info.sets.material.lock(),
+        };
+        const bool bSharedSets = std::any_of(sharedSets.begin(), sharedSets.end(), [](const auto& s) { return static_cast<bool>(s); });
+        if (bSharedSets && (!ubos.empty() || !textures.empty()))
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::PIPELINE", "Pipelines using shared descriptor sets can't have their own descriptor bindings"));
+        }
+        for (uint32_t i = 0; i < sharedSets.size(); ++i)
+        {
+            if (sharedSets[i] && sharedSets[i]->getFrequency() != i)
+            {
+                throw std::runtime_error(utils::makeErrorMessage(
+                    "VK::PIPELINE", "Shared descriptor set was created for a different frequency slot"));
+            }
+        }
 
         // ============== Descriptor Set =============== //
 
         vk::DescriptorSetLayout descrSetLayout;
         std::vector<vk::DescriptorSet> descrSets;
+        uint64_t descrSetKey = 0u;
+        std::vector<DescriptorTemplateData> descrData;
         std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        if (!bSharedSets)
         {
             std::transform(
                 ubos.begin(), ubos.end(), std::back_inserter(bindings), [](PipelineUniformBufferBinding ubo) {
@@ -109,80 +452,23 @@ namespace ivulk {
                            textures.end(),
                            std::back_inserter(bindings),
                            [](PipelineTextureBinding tex) { return tex.getDescriptorSetLayoutBinding(); });
-            vk::DescriptorSetLayoutCreateInfo descrSetLayoutInfo {};
-            descrSetLayoutInfo.setBindingCount(bindings.size()).setPBindings(bindings.data());
-            auto _descrL = device.createDescriptorSetLayout(descrSetLayoutInfo);
-            if (_descrL.result != vk::Result::eSuccess)
-            {
-                throw std::runtime_error(utils::makeErrorMessage(
-                    "VK::CREATE", "Failed to create uniform buffer descriptor set layout"));
-            }
-            descrSetLayout = _descrL.value;
-
-            std::vector<vk::DescriptorSetLayout> layouts(state.vk.swapChain.images.size(), descrSetLayout);
-            vk::DescriptorSetAllocateInfo descrAllocInfo {};
-            descrAllocInfo.setDescriptorPool(state.vk.descriptor.pool)
-                .setDescriptorSetCount(state.vk.swapChain.images.size())
-                .setPSetLayouts(layouts.data());
-            auto _descrSets = device.allocateDescriptorSets(descrAllocInfo);
-            if (_descrSets.result != vk::Result::eSuccess)
-            {
-                throw std::runtime_error(
-                    utils::makeErrorMessage("VK::PIPELINE", "Failed to create Vulkan descriptor sets"));
-            }
-            descrSets = _descrSets.value;
 
-            // Configure descriptors for UBOs
-            std::vector<vk::WriteDescriptorSet> writes;
-            std::vector<vk::DescriptorBufferInfo> bufferInfos;
-            bufferInfos.reserve(ubos.size() * state.vk.swapChain.images.size());
-            std::vector<vk::DescriptorImageInfo> imageInfos;
-            imageInfos.reserve(textures.size() * state.vk.swapChain.images.size());
-
-            for (uint32_t i = 0; i < state.vk.swapChain.images.size(); ++i)
+            std::vector<VkDescriptorSetLayoutBinding> rawBindings(bindings.begin(), bindings.end());
+            descrSetLayout  = DescriptorLayoutCache::get(rawBindings);
+            descrSetKey     = DescriptorAllocator::hashBindings(rawBindings);
+            auto _descrSets =
+                context.descriptorAllocator->allocate(descrSetLayout, descrSetKey, context.imageCount);
+            descrSets.assign(_descrSets.begin(), _descrSets.end());
+
+            // Every image's set gets the same descriptors, written with the layout's update template
+            const auto& updateTemplate = DescriptorLayoutCache::getUpdateTemplate(descrSetLayout);
+            descrData.resize(updateTemplate.dataCount);
+            DescriptorSet::fillTemplateData(updateTemplate, descrData, ubos, textures);
+            if (updateTemplate.handle != VK_NULL_HANDLE)
             {
-                for (const auto& ubo : ubos)
-                {
-                    vk::Buffer buffer = ubo.getBuffer();
-                    vk::DeviceSize sz = ubo.getSize();
-                    vk::DescriptorBufferInfo bufferInfo {};
-                    bufferInfo.setBuffer(buffer).setOffset(0u).setRange(sz);
-                    bufferInfos.push_back(bufferInfo);
-
-                    vk::WriteDescriptorSet descriptorWrite {};
-                    descriptorWrite.setDstSet(descrSets[i])
-                        .setDstBinding(ubo.binding)
-                        .setDstArrayElement(0u)
-                        .setDescriptorCount(1u)
-                        .setDescriptorType(vk::DescriptorType::eUniformBuffer)
-                        .setPImageInfo(nullptr)
-                        .setPBufferInfo(&bufferInfos[bufferInfos.size() - 1])
-                        .setPTexelBufferView(nullptr);
-
-                    writes.push_back(descriptorWrite);
-                }
-
-                for (const auto& tex : textures)
-                {
-                    vk::DescriptorImageInfo imageInfo {};
-                    imageInfo.setSampler(tex.getSampler())
-                        .setImageView(tex.getImageView())
-                        .setImageLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
-                    imageInfos.push_back(imageInfo);
-
-                    vk::WriteDescriptorSet descriptorWrite {};
-                    descriptorWrite.setDstSet(descrSets[i])
-                        .setDstBinding(tex.binding)
-                        .setDstArrayElement(0u)
-                        .setDescriptorCount(1u)
-                        .setDescriptorType(vk::DescriptorType::eCombinedImageSampler)
-                        .setPImageInfo(&imageInfos[imageInfos.size() - 1])
-                        .setPBufferInfo(nullptr)
-                        .setPTexelBufferView(nullptr);
-                    writes.push_back(descriptorWrite);
-                }
+                for (auto set : _descrSets)
+                    vkUpdateDescriptorSetWithTemplate(_device, set, updateTemplate.handle, descrData.data());
             }
-            device.updateDescriptorSets(writes, {});
         }
 
         // ###################### Pipeline ####################### //
@@ -191,21 +477,16 @@ namespace ivulk {
         vk::RenderPass renderPass;
         vk::Pipeline graphicsPipeline;
 
-        const auto assetsDir = App::current()->getAssetsDir();
-
-        // ========== Create shader modules =========== //
+        // ========== Get shader modules =========== //
 
-        using shadermodule_info_t = std::tuple<fs::path, VkShaderStageFlagBits, vk::ShaderModule>;
+        // Modules belong to the shader module cache, and are held until the pipeline is created in case
+        // another thread replaces them meanwhile
+        using shadermodule_info_t = std::tuple<fs::path, VkShaderStageFlagBits, ShaderModuleCache::Lease>;
         std::vector<shadermodule_info_t> shaderModules;
         shaderModules.reserve(6);
 
-        auto pathToShaderModule = [&assetsDir, &device](const fs::path& p,
-                                                        VkShaderStageFlagBits stage) -> shadermodule_info_t {
-            auto shaderExt    = p.stem().extension();
-            auto shaderP      = assetsDir / p;
-            auto shaderCode   = readSPIRVFile(shaderP);
-            auto shaderModule = createShaderModule(device, shaderCode, p);
-            return {shaderP, stage, shaderModule};
+        auto pathToShaderModule = [](const fs::path& p, VkShaderStageFlagBits stage) -> shadermodule_info_t {
+            return {p, stage, ShaderModuleCache::acquire(p)};
         };
         if (info.shaderPath.vert.has_value())
             shaderModules.push_back(pathToShaderModule(*info.shaderPath.vert, VK_SHADER_STAGE_VERTEX_BIT));
@@ -224,13 +505,17 @@ namespace ivulk {
 
         // =========== Create shader stages =========== //
 
+        // Every stage shares the same constants; stages ignore the ones they don't declare
+        const auto* pSpecialization = reinterpret_cast<const vk::SpecializationInfo*>(specialization.get());
+
         std::vector<vk::PipelineShaderStageCreateInfo> shaderStages(shaderModules.size());
         auto shaderModuleToStage =
-            [](const shadermodule_info_t& shaderMod) -> vk::PipelineShaderStageCreateInfo {
+            [pSpecialization](const shadermodule_info_t& shaderMod) -> vk::PipelineShaderStageCreateInfo {
             vk::PipelineShaderStageCreateInfo res {};
             res.setStage(vk::ShaderStageFlagBits(std::get<1>(shaderMod)))
-                .setModule(std::get<2>(shaderMod))
-                .setPName("main");
+                .setModule(std::get<2>(shaderMod).get())
+                .setPName("main")
+                .setPSpecializationInfo(pSpecialization);
             return res;
         };
         std::transform(shaderModules.begin(), shaderModules.end(), shaderStages.begin(), shaderModuleToStage);
@@ -238,8 +523,8 @@ namespace ivulk {
         // ======= Fixed Function Configuration ======= //
 
         vk::PipelineVertexInputStateCreateInfo vertexInputInfo {};
-        vertexInputInfo.setVertexBindingDescriptionCount(info.bNoVertex ? 0u : 1u)
-            .setPVertexBindingDescriptions(info.bNoVertex ? nullptr : &bindingDescr)
+        vertexInputInfo.setVertexBindingDescriptionCount(info.bNoVertex ? 0u : bindingDescrs.size())
+            .setPVertexBindingDescriptions(info.bNoVertex ? nullptr : bindingDescrs.data())
             .setVertexAttributeDescriptionCount(info.bNoVertex ? 0u : attribDescrs.size())
             .setPVertexAttributeDescriptions(info.bNoVertex ? nullptr : attribDescrs.data());
 
@@ -249,13 +534,13 @@ namespace ivulk {
         vk::Viewport viewport {};
         viewport.setX(0.0f)
             .setY(0.0f)
-            .setWidth(static_cast<float>(state.vk.swapChain.extent.width))
-            .setHeight(static_cast<float>(state.vk.swapChain.extent.height))
+            .setWidth(static_cast<float>(context.extent.width))
+            .setHeight(static_cast<float>(context.extent.height))
             .setMinDepth(0.0f)
             .setMaxDepth(1.0f);
 
         vk::Rect2D scissor {};
-        scissor.setOffset(vk::Offset2D(0, 0)).setExtent(vk::Extent2D(state.vk.swapChain.extent));
+        scissor.setOffset(vk::Offset2D(0, 0)).setExtent(vk::Extent2D(context.extent));
 
         vk::PipelineViewportStateCreateInfo viewportState {};
         viewportState.setViewportCount(1u).setPViewports(&viewport).setScissorCount(1u).setPScissors(
@@ -310,20 +595,45 @@ namespace ivulk {
 
         std::array<vk::PushConstantRange, 1> pushConstantRanges = {{}};
 
+        const uint32_t pushConstantSize
+            = sizeof(MatricesPushConstants) + (bindlessTable ? sizeof(BindlessMaterial) : 0u);
         pushConstantRanges[0]
             .setStageFlags(vk::ShaderStageFlags(E_ShaderStage::All))
             .setOffset(0u)
-            .setSize(sizeof(MatricesPushConstants));
+            .setSize(pushConstantSize);
+
+        // Fill each slot by frequency; unused slots below a used one get an empty layout
+        std::array<VkDescriptorSetLayout, E_DescriptorFrequency::Count> slotLayouts = {};
+        if (bSharedSets)
+        {
+            for (uint32_t i = 0; i < sharedSets.size(); ++i)
+                slotLayouts[i] = sharedSets[i] ? sharedSets[i]->getLayout() : VK_NULL_HANDLE;
+        }
+        else
+        {
+            slotLayouts[0] = descrSetLayout;
+        }
+        // The table must sit at the set index shaders declare, even without sets of the pipeline's own
+        static_assert(BindlessTextureTable::SetIndex < E_DescriptorFrequency::Count,
+                      "The bindless table must have a descriptor frequency slot");
+        if (bindlessTable)
+            slotLayouts[BindlessTextureTable::SetIndex] = bindlessTable->getDescriptorSetLayout();
+
+        std::vector<vk::DescriptorSetLayout> setLayouts;
+        auto lastSlot = std::find_if(slotLayouts.rbegin(), slotLayouts.rend(), [](auto l) { return l != VK_NULL_HANDLE; });
+        const auto slotCount = static_cast<uint32_t>(std::distance(lastSlot, slotLayouts.rend()));
+        for (uint32_t i = 0; i < slotCount; ++i)
+        {
+            if (slotLayouts[i] == VK_NULL_HANDLE)
+                slotLayouts[i] = DescriptorLayoutCache::get({});
+            setLayouts.push_back(slotLayouts[i]);
+        }
 
         vk::PipelineLayoutCreateInfo pipelineLayoutInfo {};
-        pipelineLayoutInfo.setSetLayoutCount(0u)
-            .setPSetLayouts(nullptr)
+        pipelineLayoutInfo.setSetLayoutCount(setLayouts.size())
+            .setPSetLayouts(setLayouts.empty() ? nullptr : setLayouts.data())
             .setPushConstantRangeCount(pushConstantRanges.size())
             .setPPushConstantRanges(pushConstantRanges.data());
-        if (descrSetLayout)
-        {
-            pipelineLayoutInfo.setSetLayoutCount(1u).setPSetLayouts(&descrSetLayout);
-        }
 
         auto _plLayout = device.createPipelineLayout(pipelineLayoutInfo);
         if (_plLayout.result != vk::Result::eSuccess)
@@ -336,7 +646,7 @@ namespace ivulk {
         // ============ Create Render Pass ============ //
 
         vk::AttachmentDescription colorAttachment {};
-        colorAttachment.format         = static_cast<vk::Format>(state.vk.swapChain.format);
+        colorAttachment.format         = static_cast<vk::Format>(context.colorFormat);
         colorAttachment.samples        = vk::SampleCountFlagBits::e1;
         colorAttachment.loadOp         = vk::AttachmentLoadOp::eClear;
         colorAttachment.storeOp        = vk::AttachmentStoreOp::eStore;
@@ -350,10 +660,11 @@ namespace ivulk {
         colorAttachmentRef.layout     = vk::ImageLayout::eColorAttachmentOptimal;
 
         vk::AttachmentDescription depthAttachment {};
-        depthAttachment.format         = static_cast<vk::Format>(state.vk.swapChain.depthImage->getFormat());
+        depthAttachment.format         = static_cast<vk::Format>(context.depthFormat);
         depthAttachment.samples        = vk::SampleCountFlagBits::e1;
         depthAttachment.loadOp         = vk::AttachmentLoadOp::eClear;
-        depthAttachment.storeOp        = vk::AttachmentStoreOp::eDontCare;
+        // Stored so the depth can be read after the pass, e.g. by `GpuCuller`
+        depthAttachment.storeOp        = vk::AttachmentStoreOp::eStore;
         depthAttachment.stencilLoadOp  = vk::AttachmentLoadOp::eDontCare;
         depthAttachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
         depthAttachment.initialLayout  = vk::ImageLayout::eUndefined;
@@ -417,27 +728,30 @@ namespace ivulk {
         pipelineInfo.basePipelineHandle  = nullptr;
         pipelineInfo.basePipelineIndex   = -1;
 
-        auto _pl = device.createGraphicsPipelines(nullptr, 1, &pipelineInfo, nullptr, &graphicsPipeline);
+        auto _pl = device.createGraphicsPipelines(
+            context.cache, 1, &pipelineInfo, nullptr, &graphicsPipeline);
         if (_pl != vk::Result::eSuccess)
         {
             throw std::runtime_error(
                 utils::makeErrorMessage("VK::CREATE", "Failed to create Vulkan graphics pipeline"));
         }
 
-        // ========== Destroy shader modules ========== //
-
-        auto shaderModuleDeleter = [&device](const shadermodule_info_t& shaderMod) {
-            device.destroy(std::get<2>(shaderMod));
-        };
-        std::for_each(shaderModules.begin(), shaderModules.end(), shaderModuleDeleter);
-
         // ====== Create/Return pipeline wrapper ====== //
 
         auto* pipeline = new GraphicsPipeline(
-            state.vk.device, graphicsPipeline, renderPass, pipelineLayout, descrSetLayout, descrSets);
+            device, graphicsPipeline, renderPass, pipelineLayout, descrSetLayout, descrSets);
 
         // Set pipline attachment indices
         pipeline->m_colorAttIndices = {0};
+        pipeline->m_bBindless        = static_cast<bool>(bindlessTable);
+        pipeline->m_bSharedSets      = bSharedSets;
+        pipeline->m_bInstanced       = !info.bNoVertex && info.instance.has_value();
+        pipeline->m_descrSetKey      = descrSetKey;
+        pipeline->m_descrData        = std::move(descrData);
+        pipeline->m_pushConstantSize = pushConstantSize;
+        pipeline->m_setLayouts       = slotLayouts;
+        pipeline->m_sharedSets       = sharedSets;
+        pipeline->m_info             = std::move(info);
 
         return pipeline;
     }
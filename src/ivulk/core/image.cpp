@@ -5,17 +5,23 @@
 
 #include <ivulk/core/app.hpp>
 #include <ivulk/core/buffer.hpp>
+#include <ivulk/core/mip_generator.hpp>
 #include <ivulk/utils/commands.hpp>
 #include <ivulk/utils/format.hpp>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace ivulk {
     namespace fs = boost::filesystem;
     Image::Image(VkDevice device, VkImage image, VmaAllocation allocation, VkImageView view)
         : base_t(device, handles_t {image, allocation, view})
         , m_mipLevels(1u)
+        , m_arrayLayers(1u)
     { }
 
     void Image::changeLayout(vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage, vk::ImageLayout oldLayout,  vk::ImageLayout newLayout)
@@ -135,19 +141,33 @@ namespace ivulk {
                    ImageInfo createInfo,
                    VkExtent3D extent,
                    VkFormat format,
-                   uint32_t mipLevels)
+                   uint32_t mipLevels,
+                   bool bComputeMips)
     {
         VkImageUsageFlags usage = createInfo.usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-        usage |= (createInfo.load.bEnable && createInfo.load.bGenMips) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0u;
+        VkImageCreateFlags flags = createInfo.bCube ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u;
+        if (bComputeMips)
+        {
+            // sRGB images are written through a UNORM storage view by the mip generator
+            usage |= VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+            if (MipGenerator::getStorageFormat(format) != format)
+                flags |= VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT;
+        }
+        else if (mipLevels > 1u)
+        {
+            // Blit fallback
+            usage |= (createInfo.load.bEnable && createInfo.load.bGenMips) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0u;
+            usage |= (createInfo.pack.bEnable && createInfo.pack.bGenMips) ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0u;
+        }
         const VkImageCreateInfo imageInfo {
             .sType       = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
             .pNext       = nullptr,
-            .flags       = 0,
+            .flags       = flags,
             .imageType   = VK_IMAGE_TYPE_2D,
             .format      = format,
             .extent      = extent,
             .mipLevels   = mipLevels,
-            .arrayLayers = 1,
+            .arrayLayers = createInfo.arrayLayers,
             .samples     = VK_SAMPLE_COUNT_1_BIT,
             .tiling      = createInfo.tiling,
             .usage       = usage,
@@ -165,7 +185,28 @@ namespace ivulk {
         }
     }
 
-    void generateMipMaps(vk::Image image, vk::Extent3D extent, uint32_t mipLevels)
+    /**
+     * @brief Throw if mips for `format` can't be generated with `vkCmdBlitImage`.
+     *
+     * Used for formats without a compute mip generation path, which would otherwise fail inside the blit.
+     */
+    void checkBlitMipSupport(VkFormat format)
+    {
+        constexpr VkFormatFeatureFlags required
+            = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+              | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(App::current()->getState().vk.physicalDevice, format, &props);
+        if ((props.optimalTilingFeatures & required) != required)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "VK::IMAGE",
+                "Mip generation is not supported for " + vk::to_string(static_cast<vk::Format>(format))
+                    + ": it has no compute path and the device doesn't support linear-filter blits for it"));
+        }
+    }
+
+    void blitMipMaps(vk::Image image, vk::Extent3D extent, uint32_t mipLevels)
     {
         vk::CommandBuffer cmdBuf(utils::beginOneTimeCommands());
 
@@ -261,6 +302,85 @@ namespace ivulk {
         utils::endOneTimeCommands(cmdBuf);
     }
 
+    fs::path resolveAssetPath(fs::path p)
+    {
+        if (p.is_relative())
+        {
+            p = App::current()->getAssetsDir() / p;
+        }
+        return p;
+    }
+
+    std::vector<uint8_t> loadPackedPixels(const ImageInfo::pack& packInfo, int& outWidth, int& outHeight)
+    {
+        const std::array<const ImageInfo::pack::channel*, 4> channels = {
+            &packInfo.r, &packInfo.g, &packInfo.b, &packInfo.a};
+
+        // Load each source map, keeping only the requested channel
+        std::array<std::vector<uint8_t>, 4> sources;
+        outWidth  = 0;
+        outHeight = 0;
+        for (auto i = 0u; i < channels.size(); ++i)
+        {
+            const auto& ch = *channels[i];
+            if (ch.path.empty())
+                continue;
+
+            auto pStr = resolveAssetPath(ch.path).string();
+            int texW, texH, texCh;
+            stbi_uc* pixels = stbi_load(pStr.c_str(), &texW, &texH, &texCh, 0);
+            if (!pixels)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::TEX", "Failed to load texture for packing: " + pStr));
+            }
+            if (outWidth == 0)
+            {
+                outWidth  = texW;
+                outHeight = texH;
+            }
+            else if (texW != outWidth || texH != outHeight)
+            {
+                stbi_image_free(pixels);
+                throw std::runtime_error(utils::makeErrorMessage(
+                    "VK::TEX", "Packed texture sources must share the same dimensions: " + pStr));
+            }
+
+            const auto srcCh = std::min<uint32_t>(ch.sourceChannel, static_cast<uint32_t>(texCh) - 1u);
+            const auto count = static_cast<size_t>(texW) * static_cast<size_t>(texH);
+            sources[i].resize(count);
+            for (size_t px = 0; px < count; ++px)
+            {
+                sources[i][px] = pixels[px * texCh + srcCh];
+            }
+            stbi_image_free(pixels);
+        }
+
+        if (outWidth == 0)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::TEX", "Packed texture requires at least one source path"));
+        }
+
+        // Interleave into RGBA8
+        const auto count = static_cast<size_t>(outWidth) * static_cast<size_t>(outHeight);
+        std::vector<uint8_t> packed(count * 4);
+        for (auto i = 0u; i < channels.size(); ++i)
+        {
+            if (sources[i].empty())
+            {
+                for (size_t px = 0; px < count; ++px)
+                    packed[px * 4 + i] = channels[i]->fallback;
+            }
+            else
+            {
+                for (size_t px = 0; px < count; ++px)
+                    packed[px * 4 + i] = sources[i][px];
+            }
+        }
+        return packed;
+    }
+
     Image* Image::createImpl(VkDevice device, ImageInfo createInfo)
     {
         auto physDevice = App::current()->getState().vk.physicalDevice;
@@ -272,30 +392,44 @@ namespace ivulk {
         VmaAllocation alloc;
         VkFormat format    = createInfo.format;
         uint32_t mipLevels = 1u;
-        if (createInfo.load.bEnable)
+        bool bComputeMips  = false;
+        bool bMipsPending  = false;
+        if (createInfo.load.bEnable || createInfo.pack.bEnable)
         {
-            auto p = createInfo.load.path;
-            if (p.is_relative())
-            {
-                p = App::current()->getAssetsDir() / p;
-            }
-            auto pStr = p.string();
-            int texW, texH, texCh;
+            int texW, texH;
             void* pixels = nullptr;
+            std::vector<uint8_t> packed;
             VkDeviceSize imageSize;
-            if (createInfo.load.bHDR)
+            bool bGenMips;
+            if (createInfo.pack.bEnable)
             {
-                pixels        = stbi_loadf(pStr.c_str(), &texW, &texH, &texCh, STBI_rgb_alpha);
-                imageSize = texW * texH * sizeof(float) * 4;
+                packed    = loadPackedPixels(createInfo.pack, texW, texH);
+                pixels    = packed.data();
+                imageSize = packed.size();
+                format    = VK_FORMAT_R8G8B8A8_UNORM;
+                bGenMips  = createInfo.pack.bGenMips;
             }
             else
             {
-                pixels        = stbi_load(pStr.c_str(), &texW, &texH, &texCh, STBI_rgb_alpha);
-                imageSize = texW * texH * 4;
-            }
-            if (!pixels)
-            {
-                throw std::runtime_error(utils::makeErrorMessage("VK::TEX", "Failed to load texture"));
+                auto pStr = resolveAssetPath(createInfo.load.path).string();
+                int texCh;
+                if (createInfo.load.bHDR)
+                {
+                    pixels    = stbi_loadf(pStr.c_str(), &texW, &texH, &texCh, STBI_rgb_alpha);
+                    imageSize = texW * texH * sizeof(float) * 4;
+                    format    = VK_FORMAT_R32G32B32A32_SFLOAT;
+                }
+                else
+                {
+                    pixels    = stbi_load(pStr.c_str(), &texW, &texH, &texCh, STBI_rgb_alpha);
+                    imageSize = texW * texH * 4;
+                    format    = (createInfo.load.bSrgb) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+                }
+                if (!pixels)
+                {
+                    throw std::runtime_error(utils::makeErrorMessage("VK::TEX", "Failed to load texture"));
+                }
+                bGenMips = createInfo.load.bGenMips;
             }
 
             Buffer::Ptr stagingBuffer = Buffer::create(device,
@@ -312,25 +446,40 @@ namespace ivulk {
                 .depth  = 1,
             };
 
-            stbi_image_free(pixels);
+            if (!createInfo.pack.bEnable)
+                stbi_image_free(pixels);
 
-            if (createInfo.load.bGenMips)
+            if (bGenMips)
                 mipLevels = calcMipLevels(extent);
-            
-            if (createInfo.load.bHDR)
-            {
-                format = VK_FORMAT_R32G32B32A32_SFLOAT;
-            }
-            else
-                format = (createInfo.load.bSrgb) ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
-            makeImage(image, alloc, createInfo, extent, format, mipLevels);
+            bComputeMips = mipLevels > 1u && MipGenerator::isFormatSupported(format);
+            if (bGenMips && mipLevels > 1u && !bComputeMips)
+                checkBlitMipSupport(format);
+
+            makeImage(image, alloc, createInfo, extent, format, mipLevels, bComputeMips);
 
             transitionImageLayout(
                 image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
             utils::copyBufferToImage(
                 stagingBuffer->getBuffer(), image, static_cast<uint32_t>(texW), static_cast<uint32_t>(texH));
-            if (createInfo.load.bGenMips) { 
-                generateMipMaps(image, extent, mipLevels);
+            if (mipLevels > 1u && createInfo.bDeferMips)
+            {
+                // Left in the transfer layout until `Image::generateMipMaps` runs
+                bMipsPending = true;
+            }
+            else if (bComputeMips)
+            {
+                MipGenerator::get()->generate({{
+                    .image     = image,
+                    .format    = format,
+                    .extent    = extent,
+                    .mipLevels = mipLevels,
+                    .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .newLayout = createInfo.layout,
+                }});
+            }
+            else if (bGenMips)
+            {
+                blitMipMaps(image, extent, mipLevels);
             }
             else
             {
@@ -340,20 +489,33 @@ namespace ivulk {
         }
         else
         {
-            makeImage(image, alloc, createInfo, extent, createInfo.format, mipLevels);
+            // Allow mips of color images to be regenerated at runtime
+            mipLevels    = createInfo.mipLevels;
+            bComputeMips = mipLevels > 1u && createInfo.aspect == VK_IMAGE_ASPECT_COLOR_BIT
+                           && MipGenerator::isFormatSupported(format);
+            makeImage(image, alloc, createInfo, extent, createInfo.format, mipLevels, bComputeMips);
         }
-        
+
+        // The default view shouldn't inherit storage usage added for an sRGB format
+        const VkImageViewUsageCreateInfo viewUsageInfo {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+            .usage = createInfo.usage & ~VK_IMAGE_USAGE_STORAGE_BIT,
+        };
+        const bool bRestrictUsage = bComputeMips && MipGenerator::getStorageFormat(format) != format;
+
         VkImageViewCreateInfo viewInfo {
 			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = bRestrictUsage ? &viewUsageInfo : nullptr,
 			.image = image,
-			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.viewType = createInfo.bCube ? VK_IMAGE_VIEW_TYPE_CUBE
+					  : (createInfo.arrayLayers > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D),
 			.format = format,
 			.subresourceRange = {
 				.aspectMask = createInfo.aspect,
 				.baseMipLevel = 0,
 				.levelCount = mipLevels,
 				.baseArrayLayer = 0,
-				.layerCount = 1,
+				.layerCount = createInfo.arrayLayers,
 			},
 		};
         if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
@@ -364,11 +526,67 @@ namespace ivulk {
 
         // Create/return new `Image*`
         auto ret      = new Image(device, image, alloc, view);
-        ret->m_format = format;
-        ret->m_extent = extent;
+        ret->m_format       = format;
+        ret->m_extent       = extent;
+        ret->m_mipLevels    = mipLevels;
+        ret->m_arrayLayers  = createInfo.arrayLayers;
+        ret->m_layout       = createInfo.layout;
+        ret->m_bMipsPending = bMipsPending;
         return ret;
     }
 
+    std::vector<Image::Ptr> Image::createBatch(VkDevice device, const std::vector<ImageInfo>& createInfos)
+    {
+        std::vector<Ptr> images;
+        images.reserve(createInfos.size());
+        for (auto info : createInfos)
+        {
+            info.bDeferMips = true;
+            images.push_back(create(device, info));
+        }
+        generateMipMaps(images);
+        return images;
+    }
+
+    void Image::generateMipMaps(const std::vector<Ptr>& images)
+    {
+        std::vector<MipGenTarget> targets;
+        for (const auto& img : images)
+        {
+            if (img->m_mipLevels <= 1u)
+                continue;
+
+            if (!MipGenerator::isFormatSupported(img->m_format))
+            {
+                if (!img->m_bMipsPending)
+                {
+                    throw std::invalid_argument(utils::makeErrorMessage(
+                        "VK::IMAGE", "Runtime mip generation is not supported for this image format"));
+                }
+                checkBlitMipSupport(img->m_format);
+                blitMipMaps(img->getImage(), img->m_extent, img->m_mipLevels);
+                img->m_bMipsPending = false;
+                continue;
+            }
+
+            targets.push_back({
+                .image       = img->getImage(),
+                .format      = img->m_format,
+                .extent      = img->m_extent,
+                .mipLevels   = img->m_mipLevels,
+                .arrayLayers = img->m_arrayLayers,
+                .oldLayout   = img->m_bMipsPending ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : img->m_layout,
+                .newLayout   = img->m_layout,
+            });
+            img->m_bMipsPending = false;
+        }
+
+        if (!targets.empty())
+        {
+            MipGenerator::get()->generate(targets);
+        }
+    }
+
     void Image::destroyImpl()
     {
         auto allocator = App::current()->getState().vk.allocator;
@@ -0,0 +1,426 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/mip_generator.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/utils/commands.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace ivulk {
+
+    MipGenerator::Ptr s_mipGenerator = {};
+
+    // Push constant block, matching the `shaders/mipgen/*.comp` shaders
+    struct MipGenParams
+    {
+        int32_t srcWidth;
+        int32_t srcHeight;
+        uint32_t levelCount;
+        uint32_t bSrgb;
+    };
+
+    /**
+     * @brief A single dispatch, downsampling `levelCount` levels below `baseLevel` of a target.
+     */
+    struct MipGenPass
+    {
+        const MipGenTarget* target;
+        uint32_t baseLevel;
+        uint32_t levelCount;
+        VkDescriptorSet set;
+    };
+
+    bool isSrgbMipFormat(VkFormat format) { return format == VK_FORMAT_R8G8B8A8_SRGB; }
+
+    VkImageView makeMipGenView(VkDevice device,
+                               const MipGenTarget& target,
+                               VkFormat format,
+                               VkImageUsageFlags usage,
+                               uint32_t mipLevel)
+    {
+        // Restrict the view usage so sRGB views of storage images remain valid
+        const VkImageViewUsageCreateInfo usageInfo {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO,
+            .usage = usage,
+        };
+        VkImageViewCreateInfo viewInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = &usageInfo,
+			.image = target.image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+			.format = format,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = mipLevel,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = target.arrayLayers,
+			},
+		};
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to make Vulkan image view for mip generation"));
+        }
+        return view;
+    }
+
+    VkImageMemoryBarrier makeMipGenBarrier(const MipGenTarget& target,
+                                           VkImageLayout oldLayout,
+                                           VkImageLayout newLayout,
+                                           VkAccessFlags srcAccess,
+                                           VkAccessFlags dstAccess)
+    {
+        return VkImageMemoryBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = srcAccess,
+			.dstAccessMask = dstAccess,
+			.oldLayout = oldLayout,
+			.newLayout = newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = target.image,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = target.mipLevels,
+				.baseArrayLayer = 0,
+				.layerCount = target.arrayLayers,
+			},
+		};
+    }
+
+    // ===== MipGenBatch ===== //
+
+    MipGenBatch::MipGenBatch(VkDevice device)
+        : m_device(device)
+    { }
+
+    MipGenBatch::~MipGenBatch()
+    {
+        for (auto view : m_views)
+        {
+            vkDestroyImageView(m_device, view, nullptr);
+        }
+        if (m_pool != VK_NULL_HANDLE)
+        {
+            vkDestroyDescriptorPool(m_device, m_pool, nullptr);
+        }
+    }
+
+    // ===== MipGenerator ===== //
+
+    MipGenerator::MipGenerator(VkDevice device,
+                               ComputePipeline::Ptr rgba8,
+                               ComputePipeline::Ptr rgba16f,
+                               ComputePipeline::Ptr rgba32f,
+                               Sampler::Ptr sampler)
+        : base_t(device, handles_t {rgba8, rgba16f, rgba32f, sampler})
+    { }
+
+    void MipGenerator::destroyImpl()
+    {
+        // Pipelines and sampler are released with the handles tuple
+    }
+
+    MipGenerator* MipGenerator::createImpl(VkDevice device, NullResourceInfo)
+    {
+        const std::vector<ComputeDescriptorBinding> bindings = {
+            {.binding = 0u, .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+            {.binding = 1u, .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .count = LevelsPerDispatch},
+        };
+        auto makePipeline = [&](const char* shaderPath) {
+            return ComputePipeline::create(device,
+                                           {
+                                               .shaderPath       = shaderPath,
+                                               .descriptor       = {.bindings = bindings},
+                                               .pushConstantSize = sizeof(MipGenParams),
+                                           });
+        };
+        auto sampler = Sampler::create(device,
+                                       {
+                                           .filter      = {.min = E_SamplerFilter::Nearest,
+                                                      .mag = E_SamplerFilter::Nearest},
+                                           .addressMode = {
+                                               .u = E_SamplerAddressMode::ClampEdge,
+                                               .v = E_SamplerAddressMode::ClampEdge,
+                                               .w = E_SamplerAddressMode::ClampEdge,
+                                           },
+                                           .anisotropy = {.bEnable = VK_FALSE},
+                                           .mips       = {.mode = VK_SAMPLER_MIPMAP_MODE_NEAREST},
+                                       });
+        return new MipGenerator(device,
+                                makePipeline(ShaderPaths[0]),
+                                makePipeline(ShaderPaths[1]),
+                                makePipeline(ShaderPaths[2]),
+                                sampler);
+    }
+
+    MipGenerator::Ptr MipGenerator::get()
+    {
+        if (!s_mipGenerator)
+        {
+            s_mipGenerator = create(App::current()->getState().vk.device, {});
+        }
+        return s_mipGenerator;
+    }
+
+    void MipGenerator::release() { s_mipGenerator.reset(); }
+
+    VkFormat MipGenerator::getStorageFormat(VkFormat format)
+    {
+        return isSrgbMipFormat(format) ? VK_FORMAT_R8G8B8A8_UNORM : format;
+    }
+
+    bool MipGenerator::isFormatSupported(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32B32A32_SFLOAT: break;
+        default: return false;
+        }
+
+        auto physDevice = App::current()->getState().vk.physicalDevice;
+        VkFormatProperties sampledProps, storageProps;
+        vkGetPhysicalDeviceFormatProperties(physDevice, format, &sampledProps);
+        vkGetPhysicalDeviceFormatProperties(physDevice, getStorageFormat(format), &storageProps);
+        return (sampledProps.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT)
+               && (storageProps.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+    }
+
+    ComputePipeline::Ptr MipGenerator::getPipelineFor(VkFormat format)
+    {
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB: return getHandleAt<0>();
+        case VK_FORMAT_R16G16B16A16_SFLOAT: return getHandleAt<1>();
+        case VK_FORMAT_R32G32B32A32_SFLOAT: return getHandleAt<2>();
+        default:
+            throw std::invalid_argument(
+                utils::makeErrorMessage("VK::IMAGE", "Unsupported format for compute mip generation"));
+        }
+    }
+
+    std::unique_ptr<MipGenBatch> MipGenerator::record(VkCommandBuffer cb, const std::vector<MipGenTarget>& targets)
+    {
+        VkDevice device = getDevice();
+        auto batch      = std::make_unique<MipGenBatch>(device);
+
+        // ============== Plan dispatches ============== //
+
+        std::vector<MipGenPass> passes;
+        uint32_t passCount = 0u;
+        for (const auto& target : targets)
+        {
+            if (target.mipLevels <= 1u)
+                continue;
+            for (uint32_t base = 0u; base + 1u < target.mipLevels; base += LevelsPerDispatch)
+            {
+                passes.push_back({
+                    .target     = &target,
+                    .baseLevel  = base,
+                    .levelCount = std::min(LevelsPerDispatch, target.mipLevels - 1u - base),
+                });
+            }
+            passCount = std::max(passCount, (target.mipLevels - 2u) / LevelsPerDispatch + 1u);
+        }
+
+        // =========== Transient descriptors =========== //
+
+        if (!passes.empty())
+        {
+            const auto setCount = static_cast<uint32_t>(passes.size());
+            const std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+                {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = setCount},
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = setCount * LevelsPerDispatch},
+            }};
+            const VkDescriptorPoolCreateInfo poolInfo {
+                .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                .maxSets       = setCount,
+                .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+                .pPoolSizes    = poolSizes.data(),
+            };
+            if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &batch->m_pool) != VK_SUCCESS)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::CREATE", "Failed to create descriptor pool for mip generation"));
+            }
+        }
+
+        VkSampler sampler = getHandleAt<3>()->getSampler();
+        for (auto& pass : passes)
+        {
+            const auto& target = *pass.target;
+            VkDescriptorSetLayout layout = getPipelineFor(target.format)->getDescriptorSetLayout();
+            const VkDescriptorSetAllocateInfo allocInfo {
+                .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool     = batch->m_pool,
+                .descriptorSetCount = 1,
+                .pSetLayouts        = &layout,
+            };
+            if (vkAllocateDescriptorSets(device, &allocInfo, &pass.set) != VK_SUCCESS)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::PIPELINE", "Failed to allocate descriptor set for mip generation"));
+            }
+
+            batch->m_views.push_back(
+                makeMipGenView(device, target, target.format, VK_IMAGE_USAGE_SAMPLED_BIT, pass.baseLevel));
+            const VkDescriptorImageInfo srcInfo {
+                .sampler     = sampler,
+                .imageView   = batch->m_views.back(),
+                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            };
+
+            // Unused output slots repeat the last level; the shader never writes them
+            std::array<VkDescriptorImageInfo, LevelsPerDispatch> dstInfos;
+            for (uint32_t i = 0; i < LevelsPerDispatch; ++i)
+            {
+                if (i < pass.levelCount)
+                {
+                    batch->m_views.push_back(makeMipGenView(device,
+                                                            target,
+                                                            getStorageFormat(target.format),
+                                                            VK_IMAGE_USAGE_STORAGE_BIT,
+                                                            pass.baseLevel + 1u + i));
+                }
+                dstInfos[i] = {
+                    .sampler     = VK_NULL_HANDLE,
+                    .imageView   = batch->m_views.back(),
+                    .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+                };
+            }
+
+            const std::array<VkWriteDescriptorSet, 2> writes = {{
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = pass.set,
+                    .dstBinding      = 0u,
+                    .descriptorCount = 1u,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo      = &srcInfo,
+                },
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = pass.set,
+                    .dstBinding      = 1u,
+                    .descriptorCount = LevelsPerDispatch,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .pImageInfo      = dstInfos.data(),
+                },
+            }};
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        }
+
+        // ================== Record ================== //
+
+        std::vector<VkImageMemoryBarrier> barriers;
+        for (const auto& target : targets)
+        {
+            barriers.push_back(makeMipGenBarrier(target,
+                                                 target.oldLayout,
+                                                 VK_IMAGE_LAYOUT_GENERAL,
+                                                 VK_ACCESS_MEMORY_WRITE_BIT,
+                                                 VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT));
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+
+        // Passes at the same depth are independent, so every image shares one barrier between depths
+        for (uint32_t depth = 0u; depth < passCount; ++depth)
+        {
+            if (depth > 0u)
+            {
+                const VkMemoryBarrier barrier {
+                    .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+                    .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+                    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                };
+                vkCmdPipelineBarrier(cb,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                     0,
+                                     1,
+                                     &barrier,
+                                     0,
+                                     nullptr,
+                                     0,
+                                     nullptr);
+            }
+
+            for (const auto& pass : passes)
+            {
+                if (pass.baseLevel != depth * LevelsPerDispatch)
+                    continue;
+
+                const auto& target = *pass.target;
+                auto pipeline      = getPipelineFor(target.format);
+                VkPipelineLayout plLayout = pipeline->getPipelineLayout();
+                const MipGenParams params {
+                    .srcWidth   = static_cast<int32_t>(std::max(target.extent.width >> pass.baseLevel, 1u)),
+                    .srcHeight  = static_cast<int32_t>(std::max(target.extent.height >> pass.baseLevel, 1u)),
+                    .levelCount = pass.levelCount,
+                    .bSrgb      = isSrgbMipFormat(target.format) ? 1u : 0u,
+                };
+
+                // Each workgroup reads a (2 * GroupSize)^2 texel region of the source level
+                vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->getPipeline());
+                vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, plLayout, 0, 1, &pass.set, 0, nullptr);
+                vkCmdPushConstants(cb, plLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(MipGenParams), &params);
+                vkCmdDispatch(cb,
+                              ComputePipeline::groupCount(static_cast<uint32_t>(params.srcWidth), 2u * GroupSize),
+                              ComputePipeline::groupCount(static_cast<uint32_t>(params.srcHeight), 2u * GroupSize),
+                              target.arrayLayers);
+            }
+        }
+
+        barriers.clear();
+        for (const auto& target : targets)
+        {
+            barriers.push_back(makeMipGenBarrier(target,
+                                                 VK_IMAGE_LAYOUT_GENERAL,
+                                                 target.newLayout,
+                                                 VK_ACCESS_SHADER_WRITE_BIT,
+                                                 VK_ACCESS_MEMORY_READ_BIT));
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+
+        return batch;
+    }
+
+    void MipGenerator::generate(const std::vector<MipGenTarget>& targets)
+    {
+        if (targets.empty())
+            return;
+
+        VkCommandBuffer cb = utils::beginOneTimeCommands();
+        auto batch         = record(cb, targets);
+        utils::endOneTimeCommands(cb);
+    }
+} // namespace ivulk
@@ -0,0 +1,280 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/pipeline_registry.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/utils/hash.hpp>
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+
+    namespace fs = boost::filesystem;
+
+    /**
+     * @brief A flattened pipeline description, compared byte for byte between requests
+     */
+    struct PipelineDescription
+    {
+        std::string bytes;
+        std::vector<std::weak_ptr<void>> resources; ///< Resources whose addresses are part of `bytes`
+    };
+
+    struct PipelineRegistryEntry
+    {
+        PipelineDescription description;
+        GraphicsPipeline::Ref pipeline;
+    };
+
+    struct PipelineRegistryInstance
+    {
+        // Entries sharing a hash are compared by description
+        std::unordered_map<uint64_t, std::vector<PipelineRegistryEntry>> pipelines;
+        PipelineRegistryStats stats;
+        std::mutex mutex;
+    };
+
+    PipelineRegistryInstance s_pipelineRegistry;
+
+    template <typename T>
+    void appendPipelineBytes(PipelineDescription& desc, const T& value)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Only plain values can be appended");
+        desc.bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void appendPipelinePath(PipelineDescription& desc, const std::optional<fs::path>& path)
+    {
+        appendPipelineBytes(desc, path.has_value());
+        if (!path.has_value())
+            return;
+        const auto str = path->generic_string();
+        appendPipelineBytes(desc, str.size());
+        desc.bytes += str;
+    }
+
+    template <typename T>
+    void appendPipelineResource(PipelineDescription& desc, const std::weak_ptr<T>& ref)
+    {
+        // An address is only unique while the resource is alive, so the entry goes stale with it
+        auto resource = ref.lock();
+        appendPipelineBytes(desc, static_cast<const void*>(resource.get()));
+        if (resource)
+            desc.resources.emplace_back(resource);
+    }
+
+    PipelineDescription describePipeline(const GraphicsPipelineInfo& info, const AppState& state)
+    {
+        PipelineDescription desc;
+
+        // Swapchain state baked into the pipeline and its render pass
+        const auto& swapChain = state.vk.swapChain;
+        appendPipelineBytes(desc, swapChain.extent);
+        appendPipelineBytes(desc, swapChain.format);
+        const VkFormat depthFormat =
+            swapChain.depthImage ? swapChain.depthImage->getFormat() : VK_FORMAT_UNDEFINED;
+        appendPipelineBytes(desc, depthFormat);
+        appendPipelineBytes(desc, swapChain.images.size());
+
+        appendPipelineBytes(desc, info.vertex.binding);
+        appendPipelineBytes(desc, info.vertex.attributes.size());
+        for (const auto& attribute : info.vertex.attributes)
+            appendPipelineBytes(desc, attribute);
+        appendPipelineBytes(desc, info.instance.has_value());
+        if (info.instance.has_value())
+        {
+            appendPipelineBytes(desc, info.instance->binding);
+            appendPipelineBytes(desc, info.instance->attributes.size());
+            for (const auto& attribute : info.instance->attributes)
+                appendPipelineBytes(desc, attribute);
+        }
+
+        appendPipelineBytes(desc, info.bDepthEnable);
+        appendPipelineBytes(desc, info.bCullFront);
+        appendPipelineBytes(desc, info.bNoVertex);
+        appendPipelineBytes(desc, info.bBindless);
+
+        appendPipelinePath(desc, info.shaderPath.vert);
+        appendPipelinePath(desc, info.shaderPath.frag);
+        appendPipelinePath(desc, info.shaderPath.tese);
+        appendPipelinePath(desc, info.shaderPath.tesc);
+        appendPipelinePath(desc, info.shaderPath.geom);
+        appendPipelinePath(desc, info.shaderPath.comp);
+
+        appendPipelineBytes(desc, info.descriptor.uboBindings.size());
+        for (const auto& ubo : info.descriptor.uboBindings)
+        {
+            appendPipelineBytes(desc, ubo.binding);
+            appendPipelineResource(desc, ubo.ubo);
+        }
+        appendPipelineBytes(desc, info.descriptor.textureBindings.size());
+        for (const auto& texture : info.descriptor.textureBindings)
+        {
+            appendPipelineBytes(desc, texture.binding);
+            appendPipelineResource(desc, texture.image);
+            appendPipelineResource(desc, texture.sampler);
+        }
+
+        appendPipelineResource(desc, info.sets.frame);
+        appendPipelineResource(desc, info.sets.pass);
+        appendPipelineResource(desc, info.sets.material);
+
+        appendPipelineBytes(desc, info.specialization.size());
+        for (const auto& constant : info.specialization)
+            appendPipelineBytes(desc, constant);
+
+        return desc;
+    }
+
+    bool isPipelineEntryStale(const PipelineRegistryEntry& entry)
+    {
+        auto pipeline = entry.pipeline.lock();
+        if (!pipeline || pipeline->isDestroyed())
+            return true;
+        const auto& resources = entry.description.resources;
+        return std::any_of(resources.begin(), resources.end(), [](const auto& r) { return r.expired(); });
+    }
+
+    // The registry mutex must be held
+    GraphicsPipeline::Ptr findRegisteredPipeline(uint64_t key, const PipelineDescription& desc)
+    {
+        auto it = s_pipelineRegistry.pipelines.find(key);
+        if (it == s_pipelineRegistry.pipelines.end())
+            return {};
+
+        for (const auto& entry : it->second)
+        {
+            if (entry.description.bytes == desc.bytes && !isPipelineEntryStale(entry))
+                return entry.pipeline.lock();
+        }
+        return {};
+    }
+
+    // The registry mutex must be held
+    GraphicsPipeline::Ptr registerPipeline(uint64_t key,
+                                           PipelineDescription desc,
+                                           GraphicsPipeline::Ptr pipeline)
+    {
+        // Another thread may have created the same pipeline in the meantime
+        if (auto existing = findRegisteredPipeline(key, desc))
+            return existing;
+
+        auto& bucket = s_pipelineRegistry.pipelines[key];
+        bucket.erase(std::remove_if(bucket.begin(), bucket.end(), isPipelineEntryStale), bucket.end());
+        bucket.push_back({std::move(desc), pipeline});
+        ++s_pipelineRegistry.stats.created;
+        return pipeline;
+    }
+
+    GraphicsPipeline::Ptr PipelineRegistry::get(VkDevice device, const GraphicsPipelineInfo& info)
+    {
+        auto desc      = describePipeline(info, App::current()->getState());
+        const auto key = utils::fnv1a64(desc.bytes);
+        {
+            std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+            ++s_pipelineRegistry.stats.requests;
+            if (auto pipeline = findRegisteredPipeline(key, desc))
+            {
+                ++s_pipelineRegistry.stats.hits;
+                return pipeline;
+            }
+        }
+
+        // Created without holding the lock, so other threads can create different pipelines meanwhile
+        auto pipeline = GraphicsPipeline::create(device, info);
+
+        std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+        return registerPipeline(key, std::move(desc), pipeline);
+    }
+
+    std::vector<GraphicsPipeline::Ptr>
+    PipelineRegistry::getBatch(VkDevice device, const std::vector<GraphicsPipelineInfo>& infos)
+    {
+        const auto state = App::current()->getState();
+
+        std::vector<GraphicsPipeline::Ptr> results(infos.size());
+        std::vector<PipelineDescription> descs;
+        std::vector<uint64_t> keys;
+        std::vector<GraphicsPipelineInfo> missingInfos;
+        std::vector<std::size_t> missing(infos.size(), infos.size()); // Index into `missingInfos` per request
+        std::unordered_multimap<uint64_t, std::size_t> batchRequests; // Key to the first request creating it
+        {
+            std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+            for (std::size_t i = 0; i < infos.size(); ++i)
+            {
+                descs.push_back(describePipeline(infos[i], state));
+                keys.push_back(utils::fnv1a64(descs[i].bytes));
+                ++s_pipelineRegistry.stats.requests;
+
+                if ((results[i] = findRegisteredPipeline(keys[i], descs[i])))
+                {
+                    ++s_pipelineRegistry.stats.hits;
+                    continue;
+                }
+
+                // Duplicates within the batch share the first request's pipeline
+                auto [first, last] = batchRequests.equal_range(keys[i]);
+                for (auto it = first; it != last; ++it)
+                {
+                    if (descs[it->second].bytes == descs[i].bytes)
+                    {
+                        missing[i] = missing[it->second];
+                        ++s_pipelineRegistry.stats.hits;
+                        break;
+                    }
+                }
+                if (missing[i] == infos.size())
+                {
+                    missing[i] = missingInfos.size();
+                    missingInfos.push_back(infos[i]);
+                    batchRequests.emplace(keys[i], i);
+                }
+            }
+        }
+
+        auto futures = GraphicsPipeline::createBatch(device, missingInfos);
+        std::vector<GraphicsPipeline::Ptr> created;
+        created.reserve(futures.size());
+        for (auto& future : futures)
+            created.push_back(future.get());
+
+        std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+        for (std::size_t i = 0; i < infos.size(); ++i)
+        {
+            if (results[i])
+                continue;
+            results[i] = registerPipeline(keys[i], descs[i], created[missing[i]]);
+        }
+        return results;
+    }
+
+    PipelineRegistryStats PipelineRegistry::getStats()
+    {
+        std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+        auto stats      = s_pipelineRegistry.stats;
+        stats.pipelines = 0u;
+        for (const auto& [key, bucket] : s_pipelineRegistry.pipelines)
+        {
+            const auto live = std::count_if(
+                bucket.begin(), bucket.end(), [](const auto& entry) { return !isPipelineEntryStale(entry); });
+            stats.pipelines += static_cast<uint32_t>(live);
+        }
+        return stats;
+    }
+
+    void PipelineRegistry::clear()
+    {
+        std::lock_guard<std::mutex> lock(s_pipelineRegistry.mutex);
+        s_pipelineRegistry.pipelines.clear();
+        s_pipelineRegistry.stats = {};
+    }
+} // namespace ivulk
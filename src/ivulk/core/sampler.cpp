@@ -5,19 +5,34 @@
 
 #include <ivulk/core/app.hpp>
 
+#include <algorithm>
+
 namespace ivulk {
     Sampler::Sampler(VkDevice device, VkSampler sampler, VkDescriptorSetLayoutBinding binding)
         : base_t(device, handles_t {sampler, binding})
     { }
 
-    Sampler* Sampler::createImpl(VkDevice device, SamplerInfo info)
+    SamplerInfo Sampler::resolveInfo(SamplerInfo info)
     {
-        auto state = App::current()->getState().vk;
+        const auto& state = App::current()->getState().vk;
         VkPhysicalDeviceFeatures features;
+        VkPhysicalDeviceProperties properties;
         vkGetPhysicalDeviceFeatures(state.physicalDevice, &features);
+        vkGetPhysicalDeviceProperties(state.physicalDevice, &properties);
 
-        VkBool32 enableAnisotropy = features.samplerAnisotropy && info.anisotropy.bEnable;
-        float maxAnisotropy       = enableAnisotropy ? info.anisotropy.level : 1.0f;
+        if (info.mips.maxLod == E_SamplerLod::FromImage)
+            info.mips.maxLod = E_SamplerLod::Unclamped;
+
+        info.anisotropy.bEnable = features.samplerAnisotropy && info.anisotropy.bEnable;
+        info.anisotropy.level   = info.anisotropy.bEnable
+                                    ? std::clamp(info.anisotropy.level, 1.0f, properties.limits.maxSamplerAnisotropy)
+                                    : 1.0f;
+        return info;
+    }
+
+    Sampler* Sampler::createImpl(VkDevice device, SamplerInfo info)
+    {
+        info = resolveInfo(info);
 
         VkSampler sampler = VK_NULL_HANDLE;
         VkSamplerCreateInfo samplerInfo {
@@ -29,8 +44,8 @@ namespace ivulk {
             .addressModeV            = info.addressMode.v,
             .addressModeW            = info.addressMode.w,
             .mipLodBias              = info.mips.lodBias,
-            .anisotropyEnable        = enableAnisotropy,
-            .maxAnisotropy           = maxAnisotropy,
+            .anisotropyEnable        = info.anisotropy.bEnable,
+            .maxAnisotropy           = info.anisotropy.level,
             .compareEnable           = info.compare.bEnable,
             .compareOp               = info.compare.compareOp,
             .minLod                  = info.mips.minLod,
@@ -0,0 +1,103 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/sampler_cache.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/utils/hash.hpp>
+
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ivulk {
+
+    struct SamplerCacheInstance
+    {
+        // Entries sharing a hash are compared field by field
+        std::unordered_map<uint64_t, std::vector<std::pair<SamplerInfo, Sampler::Ptr>>> samplers;
+        SamplerCacheStats stats;
+        std::mutex mutex;
+    };
+
+    SamplerCacheInstance s_samplerCache;
+
+    uint64_t hashSamplerInfo(const SamplerInfo& info)
+    {
+        uint64_t key = utils::FNV1a64OffsetBasis;
+        utils::hashCombine(key, info.filter.min);
+        utils::hashCombine(key, info.filter.mag);
+        utils::hashCombine(key, info.addressMode.u);
+        utils::hashCombine(key, info.addressMode.v);
+        utils::hashCombine(key, info.addressMode.w);
+        utils::hashCombine(key, info.anisotropy.bEnable);
+        utils::hashCombine(key, info.anisotropy.level);
+        utils::hashCombine(key, info.compare.bEnable);
+        utils::hashCombine(key, info.compare.compareOp);
+        utils::hashCombine(key, info.mips.mode);
+        utils::hashCombine(key, info.mips.lodBias);
+        utils::hashCombine(key, info.mips.minLod);
+        utils::hashCombine(key, info.mips.maxLod);
+        utils::hashCombine(key, info.defaultBinding);
+        utils::hashCombine(key, info.stageFlags);
+        return key;
+    }
+
+    bool samplerInfoEquals(const SamplerInfo& a, const SamplerInfo& b)
+    {
+        return a.filter.min == b.filter.min && a.filter.mag == b.filter.mag
+               && a.addressMode.u == b.addressMode.u && a.addressMode.v == b.addressMode.v
+               && a.addressMode.w == b.addressMode.w && a.anisotropy.bEnable == b.anisotropy.bEnable
+               && a.anisotropy.level == b.anisotropy.level && a.compare.bEnable == b.compare.bEnable
+               && a.compare.compareOp == b.compare.compareOp && a.mips.mode == b.mips.mode
+               && a.mips.lodBias == b.mips.lodBias && a.mips.minLod == b.mips.minLod
+               && a.mips.maxLod == b.mips.maxLod && a.defaultBinding == b.defaultBinding
+               && a.stageFlags == b.stageFlags;
+    }
+
+    Sampler::Ptr SamplerCache::get(const SamplerInfo& info)
+    {
+        const auto resolved = Sampler::resolveInfo(info);
+        const auto key      = hashSamplerInfo(resolved);
+
+        std::lock_guard<std::mutex> lock(s_samplerCache.mutex);
+        ++s_samplerCache.stats.requests;
+        auto& bucket = s_samplerCache.samplers[key];
+        for (const auto& [cachedInfo, sampler] : bucket)
+        {
+            if (samplerInfoEquals(cachedInfo, resolved))
+            {
+                ++s_samplerCache.stats.hits;
+                return sampler;
+            }
+        }
+
+        auto sampler = Sampler::create(App::current()->getState().vk.device, resolved);
+        bucket.emplace_back(resolved, sampler);
+        ++s_samplerCache.stats.samplers;
+        return sampler;
+    }
+
+    Sampler::Ptr SamplerCache::get(SamplerInfo info, const Image::Ptr& image)
+    {
+        if (info.mips.maxLod == E_SamplerLod::FromImage && image)
+        {
+            info.mips.maxLod = static_cast<float>(image->getMipLevels() - 1u);
+        }
+        return get(info);
+    }
+
+    SamplerCacheStats SamplerCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(s_samplerCache.mutex);
+        return s_samplerCache.stats;
+    }
+
+    void SamplerCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(s_samplerCache.mutex);
+        s_samplerCache.samplers.clear();
+        s_samplerCache.stats = {};
+    }
+} // namespace ivulk
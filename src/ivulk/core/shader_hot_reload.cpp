@@ -0,0 +1,126 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/shader_hot_reload.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/graphics_pipeline.hpp>
+#include <ivulk/core/shader_variant_compiler.hpp>
+#include <ivulk/utils/file_watcher.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ivulk {
+
+    namespace fs = boost::filesystem;
+
+    struct ShaderHotReloadInstance
+    {
+        std::unique_ptr<utils::FileWatcher> watcher; ///< Empty while hot reloading is disabled
+        std::set<fs::path> watchedDirs;
+        std::mutex mutex;
+    };
+
+    ShaderHotReloadInstance s_hotReload;
+
+    void ShaderHotReload::enable()
+    {
+        std::lock_guard<std::mutex> lock(s_hotReload.mutex);
+        if (!s_hotReload.watcher)
+            s_hotReload.watcher = std::make_unique<utils::FileWatcher>();
+    }
+
+    void ShaderHotReload::disable()
+    {
+        std::lock_guard<std::mutex> lock(s_hotReload.mutex);
+        s_hotReload.watcher.reset();
+        s_hotReload.watchedDirs.clear();
+    }
+
+    bool ShaderHotReload::isEnabled()
+    {
+        std::lock_guard<std::mutex> lock(s_hotReload.mutex);
+        return static_cast<bool>(s_hotReload.watcher);
+    }
+
+    void ShaderHotReload::update()
+    {
+        std::lock_guard<std::mutex> lock(s_hotReload.mutex);
+        if (!s_hotReload.watcher)
+            return;
+
+        // Source directories can be added at any time, and may not exist yet
+        for (const auto& dir : ShaderVariantCompiler::getSourceDirs())
+        {
+            const auto absDir = fs::absolute(dir).lexically_normal();
+            if (!s_hotReload.watchedDirs.count(absDir) && s_hotReload.watcher->addDirectory(absDir))
+                s_hotReload.watchedDirs.insert(absDir);
+        }
+
+        const auto changed = s_hotReload.watcher->poll();
+        if (changed.empty())
+            return;
+
+        // ========== Find the modules using the changed files ========== //
+
+        std::set<fs::path> modules;
+        for (const auto& module : GraphicsPipeline::getShaderPaths())
+        {
+            std::vector<fs::path> deps;
+            try
+            {
+                deps = ShaderVariantCompiler::getDependencies(module);
+            }
+            catch (const std::exception& e)
+            {
+                // E.g. a template that was deleted or renamed
+                std::cout << e.what() << std::endl;
+                continue;
+            }
+            if (std::any_of(deps.begin(), deps.end(), [&](const auto& d) { return changed.count(d) > 0; }))
+                modules.insert(module);
+        }
+        if (modules.empty())
+            return;
+
+        // ============ Rebuild the modules and pipelines ============ //
+
+        auto pool = App::current()->getState().workers.pool;
+        std::vector<std::shared_future<bool>> rebuilt;
+        rebuilt.reserve(modules.size());
+        for (const auto& module : modules)
+        {
+            auto task = [module]() {
+                try
+                {
+                    ShaderVariantCompiler::reload(module);
+                    return true;
+                }
+                catch (const std::exception& e)
+                {
+                    std::cout << e.what() << std::endl;
+                    return false;
+                }
+            };
+            rebuilt.push_back(pool->submit(task).share());
+        }
+        const auto pipelines = GraphicsPipeline::recreateAsync(modules, rebuilt);
+
+        if (App::current()->getPrintDbg())
+        {
+            std::string description = "Rebuilding ";
+            description += std::to_string(modules.size()) + " shaders and " + std::to_string(pipelines)
+                           + " pipelines after " + std::to_string(changed.size()) + " files changed";
+            std::cout << utils::makeInfoMessage("SHADER", description) << std::endl;
+        }
+    }
+} // namespace ivulk
@@ -0,0 +1,238 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/shader_module_cache.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/utils/hash.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ivulk {
+
+    namespace fs = boost::filesystem;
+
+    struct ShaderModuleCacheInstance
+    {
+        struct Module
+        {
+            VkShaderModule module = VK_NULL_HANDLE;
+            uint32_t refs         = 0u; // Number of paths mapped to the module
+            uint32_t leases       = 0u; // Number of pipelines being created from the module
+        };
+
+        std::unordered_map<uint64_t, Module> modules;    // By content hash
+        std::unordered_map<std::string, uint64_t> paths; // Normalized path to content hash
+        ShaderModuleCacheStats stats;
+        std::mutex mutex;
+    };
+
+    ShaderModuleCacheInstance s_shaderModuleCache;
+
+    std::string shaderCacheKey(const fs::path& path)
+    {
+        return (App::current()->getAssetsDir() / path).lexically_normal().string();
+    }
+
+    std::vector<uint32_t> readShaderFile(const fs::path& path)
+    {
+        const auto fullPath = (App::current()->getAssetsDir() / path).lexically_normal();
+        std::ifstream f(fullPath.string(), std::ios::ate | std::ios::binary);
+        if (!f.is_open())
+        {
+            std::string description = "Failed to open file for reading: `";
+            description += fullPath.string() + "`";
+            throw std::runtime_error(utils::makeErrorMessage("FILE", description));
+        }
+        const auto fileSize = static_cast<std::size_t>(f.tellg());
+        if (fileSize == 0u || fileSize % sizeof(uint32_t) != 0u)
+        {
+            std::string description = "Invalid SPIR-V file size: `";
+            description += fullPath.string() + "`";
+            throw std::runtime_error(utils::makeErrorMessage("FILE", description));
+        }
+        std::vector<uint32_t> code(fileSize / sizeof(uint32_t));
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(code.data()), static_cast<std::streamsize>(fileSize));
+
+        ++s_shaderModuleCache.stats.filesRead;
+        s_shaderModuleCache.stats.bytesRead += fileSize;
+        return code;
+    }
+
+    // Drop a path's or a lease's hold on a module, and destroy it once neither kind is left
+    void releaseShaderModule(uint64_t hash, bool bLease = false)
+    {
+        auto it = s_shaderModuleCache.modules.find(hash);
+        if (it == s_shaderModuleCache.modules.end())
+            return;
+        auto& module = it->second;
+        --(bLease ? module.leases : module.refs);
+        if (module.refs > 0u || module.leases > 0u)
+            return;
+        vkDestroyShaderModule(App::current()->getState().vk.device, it->second.module, nullptr);
+        s_shaderModuleCache.modules.erase(it);
+        --s_shaderModuleCache.stats.modules;
+    }
+
+    // Map a path to a module of the code, and get the module's content hash
+    uint64_t mapShaderModule(const std::string& key, const fs::path& path, const std::vector<uint32_t>& code)
+    {
+        const std::size_t codeSize = code.size() * sizeof(uint32_t);
+        uint64_t hash              = utils::fnv1a64(code.data(), codeSize);
+        utils::hashCombine(hash, codeSize);
+
+        auto& module = s_shaderModuleCache.modules[hash];
+        if (module.module == VK_NULL_HANDLE)
+        {
+            const VkShaderModuleCreateInfo createInfo {
+                .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+                .codeSize = codeSize,
+                .pCode    = code.data(),
+            };
+            if (vkCreateShaderModule(App::current()->getState().vk.device, &createInfo, nullptr, &module.module)
+                != VK_SUCCESS)
+            {
+                s_shaderModuleCache.modules.erase(hash);
+                std::string description = "Failed to create Vulkan shader module from shader: `";
+                description += path.string() + "`";
+                throw std::runtime_error(utils::makeErrorMessage("VK::CREATE", description));
+            }
+            ++s_shaderModuleCache.stats.modules;
+            if (App::current()->getPrintDbg())
+            {
+                std::string description = "Created Vulkan shader module from shader: `";
+                description += path.string() + "`";
+                std::cout << utils::makeSuccessMessage("VK::CREATE", description) << std::endl;
+            }
+        }
+        ++module.refs;
+
+        // Take the reference before releasing the old one, in case the contents didn't change
+        auto [it, bInserted] = s_shaderModuleCache.paths.try_emplace(key, hash);
+        if (bInserted)
+        {
+            ++s_shaderModuleCache.stats.paths;
+        }
+        else
+        {
+            const auto oldHash = it->second;
+            it->second         = hash;
+            releaseShaderModule(oldHash);
+        }
+        return hash;
+    }
+
+    // Get the content hash of the module mapped to a path, loading it if needed. Must be called with the
+    // cache locked.
+    uint64_t findShaderModule(const fs::path& path)
+    {
+        const auto key = shaderCacheKey(path);
+
+        ++s_shaderModuleCache.stats.requests;
+        if (auto it = s_shaderModuleCache.paths.find(key); it != s_shaderModuleCache.paths.end())
+        {
+            ++s_shaderModuleCache.stats.hits;
+            return it->second;
+        }
+        return mapShaderModule(key, path, readShaderFile(path));
+    }
+
+    ShaderModuleCache::Lease::Lease(uint64_t hash, VkShaderModule module)
+        : m_hash(hash)
+        , m_module(module)
+    { }
+
+    ShaderModuleCache::Lease::Lease(Lease&& other) noexcept
+        : m_hash(other.m_hash)
+        , m_module(std::exchange(other.m_module, VK_NULL_HANDLE))
+    { }
+
+    ShaderModuleCache::Lease& ShaderModuleCache::Lease::operator=(Lease&& other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            m_hash   = other.m_hash;
+            m_module = std::exchange(other.m_module, VK_NULL_HANDLE);
+        }
+        return *this;
+    }
+
+    ShaderModuleCache::Lease::~Lease() { release(); }
+
+    void ShaderModuleCache::Lease::release()
+    {
+        if (m_module == VK_NULL_HANDLE)
+            return;
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        releaseShaderModule(m_hash, true);
+        m_module = VK_NULL_HANDLE;
+    }
+
+    VkShaderModule ShaderModuleCache::get(const fs::path& path)
+    {
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        return s_shaderModuleCache.modules.at(findShaderModule(path)).module;
+    }
+
+    ShaderModuleCache::Lease ShaderModuleCache::acquire(const fs::path& path)
+    {
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        const auto hash = findShaderModule(path);
+        auto& module    = s_shaderModuleCache.modules.at(hash);
+        ++module.leases;
+        return Lease(hash, module.module);
+    }
+
+    VkShaderModule ShaderModuleCache::add(const fs::path& path, const std::vector<uint32_t>& code)
+    {
+        if (code.empty())
+        {
+            std::string description = "Empty SPIR-V code supplied for shader: `";
+            description += path.string() + "`";
+            throw std::runtime_error(utils::makeErrorMessage("VK::CREATE", description));
+        }
+        const auto key = shaderCacheKey(path);
+
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        return s_shaderModuleCache.modules.at(mapShaderModule(key, path, code)).module;
+    }
+
+    bool ShaderModuleCache::invalidate(const fs::path& path)
+    {
+        const auto key = shaderCacheKey(path);
+
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        auto it = s_shaderModuleCache.paths.find(key);
+        if (it == s_shaderModuleCache.paths.end())
+            return false;
+        const auto hash = it->second;
+        s_shaderModuleCache.paths.erase(it);
+        --s_shaderModuleCache.stats.paths;
+        releaseShaderModule(hash);
+        return true;
+    }
+
+    ShaderModuleCacheStats ShaderModuleCache::getStats()
+    {
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        return s_shaderModuleCache.stats;
+    }
+
+    void ShaderModuleCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(s_shaderModuleCache.mutex);
+        VkDevice device = App::current()->getState().vk.device;
+        for (const auto& [hash, module] : s_shaderModuleCache.modules)
+            vkDestroyShaderModule(device, module.module, nullptr);
+        s_shaderModuleCache.modules.clear();
+        s_shaderModuleCache.paths.clear();
+        s_shaderModuleCache.stats = {};
+    }
+} // namespace ivulk
@@ -0,0 +1,469 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/shader_variant_compiler.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/shader_module_cache.hpp>
+#include <ivulk/utils/hash.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <boost/process.hpp>
+
+#if defined(IVULK_RUNTIME_SHADERS)
+#    include <shaderc/shaderc.hpp>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace ivulk {
+
+    namespace fs = boost::filesystem;
+    namespace bp = boost::process;
+
+    // Bump when the way variants are built changes, to invalidate existing disk caches
+    constexpr char ShaderVariantFormat[] = "ivulk-variant-1";
+
+    // Options every variant is compiled with, hashed into the cache key. Keep in sync with
+    // `compileVariantGlsl`.
+    constexpr char ShaderVariantCompileOptions[] = "env=vulkan1.1;opt=performance";
+
+    struct ShaderVariantCompilerInstance
+    {
+        std::vector<fs::path> sourceDirs;
+        std::optional<fs::path> cacheDir;
+        std::unordered_map<uint64_t, fs::path> loaded;              // Request hash to module path
+        std::unordered_map<std::string, ShaderVariantInfo> modules; // Module path to the variant it holds
+        ShaderVariantCompilerStats stats;
+        std::mutex mutex;
+    };
+
+    ShaderVariantCompilerInstance s_variantCompiler;
+
+    std::string readVariantFile(const fs::path& p)
+    {
+        std::ifstream f(p.string(), std::ios::binary);
+        if (!f.is_open())
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("FILE", "Failed to open file for reading: `" + p.string() + "`"));
+        }
+        std::stringstream ss;
+        ss << f.rdbuf();
+        return ss.str();
+    }
+
+    std::optional<fs::path> findVariantSource(const fs::path& name, const std::vector<fs::path>& dirs)
+    {
+        for (const auto& dir : dirs)
+        {
+            auto p = (dir / name).lexically_normal();
+            if (fs::is_regular_file(p))
+                return p;
+        }
+        return {};
+    }
+
+    // Collect every template pulled in by `file`, resolved the same way as the template tool's loader
+    void collectVariantDependencies(const fs::path& file,
+                                    const std::vector<fs::path>& dirs,
+                                    std::set<fs::path>& deps)
+    {
+        static const std::regex refPattern(R"(\{%-?\s*(?:include|import|extends|from)\s+["']([^"']+)["'])");
+
+        const auto text = readVariantFile(file);
+        const std::sregex_iterator end;
+        for (auto it = std::sregex_iterator(text.begin(), text.end(), refPattern); it != end; ++it)
+        {
+            auto dep = findVariantSource((*it)[1].str(), dirs);
+            if (dep.has_value() && deps.insert(*dep).second)
+                collectVariantDependencies(*dep, dirs, deps);
+        }
+    }
+
+    std::string makeVariantContextJson(const std::map<std::string, std::string>& context)
+    {
+        static const std::regex literalPattern(R"(^(-?\d+(\.\d+)?([eE][-+]?\d+)?|true|false)$)");
+
+        auto quote = [](const std::string& str) {
+            std::string res = "\"";
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\')
+                    res += '\\';
+                res += c;
+            }
+            return res + "\"";
+        };
+
+        std::string json = "{";
+        for (const auto& [key, value] : context)
+        {
+            if (json.size() > 1u)
+                json += ",";
+            json += quote(key) + ":" + (std::regex_match(value, literalPattern) ? value : quote(value));
+        }
+        return json + "}";
+    }
+
+    std::string getVariantStage(const fs::path& source)
+    {
+        auto name = source.filename();
+        if (name.extension() == ".jinja")
+            name = name.stem();
+        return name.extension().string();
+    }
+
+    // Make a path for a temporary file in `dir` no other build writes to, even in another process
+    fs::path makeVariantTempPath(const fs::path& dir, const std::string& hex, const std::string& extension)
+    {
+        return dir / fs::unique_path(hex + "-%%%%-%%%%-%%%%" + extension);
+    }
+
+    std::string renderVariantTemplate(const fs::path& source,
+                                      const std::vector<fs::path>& dirs,
+                                      const std::string& contextJson,
+                                      const fs::path& outPath)
+    {
+        const auto logPath = fs::path(outPath).replace_extension(".log");
+
+        std::vector<std::string> args = {
+            IVULK_TEMPLATE_TOOL_SCRIPT, "-o", outPath.string(), "-c", contextJson};
+        for (const auto& dir : dirs)
+        {
+            args.push_back("-I");
+            args.push_back(dir.string());
+        }
+        args.push_back(source.filename().string());
+
+        int exitCode = -1;
+        try
+        {
+            exitCode = bp::system(bp::exe       = IVULK_PYTHON_EXECUTABLE,
+                                  bp::args      = args,
+                                  bp::start_dir = source.parent_path(),
+                                  bp::std_out > bp::null,
+                                  bp::std_err > logPath);
+        }
+        catch (const bp::process_error& e)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "SHADER", std::string("Failed to run the shader template tool: ") + e.what()));
+        }
+        if (exitCode != 0)
+        {
+            std::string description = "Failed to render shader template `";
+            description += source.string() + "`:\n" + readVariantFile(logPath);
+            boost::system::error_code ec;
+            fs::remove(outPath, ec);
+            fs::remove(logPath, ec);
+            throw std::runtime_error(utils::makeErrorMessage("SHADER", description));
+        }
+
+        auto glsl = readVariantFile(outPath);
+        fs::remove(outPath);
+        fs::remove(logPath);
+        return glsl;
+    }
+
+    std::vector<uint32_t> compileVariantGlsl(const std::string& glsl,
+                                             const std::string& stage,
+                                             const fs::path& source,
+                                             const std::map<std::string, std::string>& defines)
+    {
+#if defined(IVULK_RUNTIME_SHADERS)
+        static const std::map<std::string, shaderc_shader_kind> stageKinds = {
+            {".vert", shaderc_vertex_shader},
+            {".frag", shaderc_fragment_shader},
+            {".tesc", shaderc_tess_control_shader},
+            {".tese", shaderc_tess_evaluation_shader},
+            {".geom", shaderc_geometry_shader},
+            {".comp", shaderc_compute_shader},
+        };
+        auto kind = stageKinds.find(stage);
+        if (kind == stageKinds.end())
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "SHADER", "Unknown shader stage for variant source: `" + source.string() + "`"));
+        }
+
+        // Changing these needs `ShaderVariantCompileOptions` updated too
+        shaderc::CompileOptions options;
+        options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_1);
+        options.SetOptimizationLevel(shaderc_optimization_level_performance);
+        for (const auto& [name, value] : defines)
+            options.AddMacroDefinition(name, value);
+
+        shaderc::Compiler compiler;
+        auto result = compiler.CompileGlslToSpv(glsl, kind->second, source.string().c_str(), options);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success)
+        {
+            std::string description = "Failed to compile shader variant of `";
+            description += source.string() + "`:\n" + result.GetErrorMessage();
+            throw std::runtime_error(utils::makeErrorMessage("SHADER", description));
+        }
+        return std::vector<uint32_t>(result.cbegin(), result.cend());
+#else
+        throw std::runtime_error(utils::makeErrorMessage(
+            "SHADER",
+            "Shader variant of `" + source.string() + "` isn't cached, and runtime compilation is disabled"));
+#endif
+    }
+
+    struct ShaderVariantBuild
+    {
+        fs::path modulePath;        // Path of the variant in the module cache
+        std::vector<uint32_t> code; // The SPIR-V code
+        std::string hex;            // Hex string of the variant hash
+        bool bCompiled = false;     // Whether the code was compiled, rather than read from the disk cache
+    };
+
+    // Get the source directories in search order, with the shader library last
+    std::vector<fs::path> getVariantSourceDirs()
+    {
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        auto dirs = s_variantCompiler.sourceDirs;
+        dirs.push_back(IVULK_SHADERLIB_DIR);
+        return dirs;
+    }
+
+    // Find the source of a variant and every template it pulls in. The first entry is the source itself.
+    std::vector<fs::path> findVariantFiles(const ShaderVariantInfo& info, const std::vector<fs::path>& dirs)
+    {
+        const auto source = findVariantSource(info.source, dirs);
+        if (!source.has_value())
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "FILE", "Shader variant source not found: `" + info.source.string() + "`"));
+        }
+
+        std::set<fs::path> deps;
+        if (source->extension() == ".jinja")
+        {
+            // Templates resolve names against the source's own directory first
+            std::vector<fs::path> templateDirs = {source->parent_path()};
+            templateDirs.insert(templateDirs.end(), dirs.begin(), dirs.end());
+            collectVariantDependencies(*source, templateDirs, deps);
+        }
+        deps.erase(*source);
+
+        std::vector<fs::path> files = {*source};
+        files.insert(files.end(), deps.begin(), deps.end());
+        return files;
+    }
+
+    ShaderVariantBuild buildShaderVariant(const ShaderVariantInfo& info, const std::string& contextJson)
+    {
+        const auto dirs = getVariantSourceDirs();
+        fs::path cacheDir;
+        {
+            std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+            cacheDir = s_variantCompiler.cacheDir.value_or(App::current()->getAssetsDir() / "shadercache");
+        }
+
+        // ============ Hash source and dependencies ============= //
+
+        const auto files     = findVariantFiles(info, dirs);
+        const auto& source   = files.front();
+        const bool bTemplate = source.extension() == ".jinja";
+        const auto stage     = getVariantStage(source);
+
+        // Hash in path order, so the key doesn't depend on how the files were found
+        const std::set<fs::path> deps(files.begin(), files.end());
+        uint64_t key = utils::fnv1a64(ShaderVariantFormat);
+        for (const auto& dep : deps)
+        {
+            key = utils::fnv1a64(dep.generic_string(), key);
+            utils::hashCombine(key, utils::hashFile(dep));
+        }
+        key = utils::fnv1a64(contextJson, key);
+        key = utils::fnv1a64(stage, key);
+        key = utils::fnv1a64(IVULK_SHADER_COMPILER_VERSION, key);
+        key = utils::fnv1a64(ShaderVariantCompileOptions, key);
+
+        // =============== Load or compile SPIR-V ================ //
+
+        ShaderVariantBuild build;
+        build.hex            = utils::toHexString(key);
+        const auto cacheFile = cacheDir / (build.hex + stage + ".spv");
+
+        if (fs::is_regular_file(cacheFile))
+        {
+            const auto bytes = readVariantFile(cacheFile);
+            build.code.resize(bytes.size() / sizeof(uint32_t));
+            std::memcpy(build.code.data(), bytes.data(), build.code.size() * sizeof(uint32_t));
+        }
+        if (build.code.empty())
+        {
+            std::vector<fs::path> templateDirs = {source.parent_path()};
+            templateDirs.insert(templateDirs.end(), dirs.begin(), dirs.end());
+
+            fs::create_directories(cacheDir);
+            const auto glsl =
+                bTemplate ? renderVariantTemplate(
+                    source, templateDirs, contextJson, makeVariantTempPath(cacheDir, build.hex, ".glsl"))
+                          : readVariantFile(source);
+            build.code = compileVariantGlsl(glsl, stage, source, info.context);
+
+            // Write to a temporary file of this build's own first, then rename it into place, so other
+            // builds of the same variant never see a partial file. Builds racing to the rename write the
+            // same code, so whichever lands last wins.
+            const auto tmpFile = makeVariantTempPath(cacheDir, build.hex, ".tmp");
+            {
+                std::ofstream f(tmpFile.string(), std::ios::binary | std::ios::trunc);
+                f.write(reinterpret_cast<const char*>(build.code.data()),
+                        static_cast<std::streamsize>(build.code.size() * sizeof(uint32_t)));
+            }
+            boost::system::error_code ec;
+            fs::rename(tmpFile, cacheFile, ec);
+            if (ec)
+            {
+                boost::system::error_code removeEc;
+                fs::remove(tmpFile, removeEc);
+                if (App::current()->getPrintDbg())
+                {
+                    std::string description = "Failed to cache shader variant: `";
+                    description += cacheFile.string() + "`";
+                    std::cout << utils::makeWarningMessage("FILE", description) << std::endl;
+                }
+            }
+            build.bCompiled = true;
+        }
+
+        // Register the code under the cache file's path, so the module cache can reload it from disk
+        build.modulePath = cacheFile.lexically_relative(App::current()->getAssetsDir());
+        ShaderModuleCache::add(build.modulePath, build.code);
+        return build;
+    }
+
+    // Find the variant a module was built from: either a variant loaded in this run, or a content shader
+    // built from a source with the same relative path
+    std::optional<ShaderVariantInfo> findModuleVariant(const fs::path& modulePath,
+                                                       const std::vector<fs::path>& dirs)
+    {
+        {
+            std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+            if (auto it = s_variantCompiler.modules.find(modulePath.generic_string());
+                it != s_variantCompiler.modules.end())
+            {
+                return it->second;
+            }
+        }
+
+        auto name = modulePath;
+        if (name.extension() == ".spv")
+            name.replace_extension();
+        for (auto candidate : {fs::path(name.string() + ".jinja"), name})
+        {
+            if (findVariantSource(candidate, dirs).has_value())
+                return ShaderVariantInfo {.source = candidate};
+        }
+        return {};
+    }
+
+    fs::path ShaderVariantCompiler::get(const ShaderVariantInfo& info)
+    {
+        const auto contextJson = makeVariantContextJson(info.context);
+        const auto requestKey  = utils::fnv1a64(contextJson, utils::fnv1a64(info.source.generic_string()));
+        {
+            std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+            ++s_variantCompiler.stats.requests;
+            if (auto it = s_variantCompiler.loaded.find(requestKey); it != s_variantCompiler.loaded.end())
+            {
+                ++s_variantCompiler.stats.memoryHits;
+                return it->second;
+            }
+        }
+
+        const auto build = buildShaderVariant(info, contextJson);
+
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        ++(build.bCompiled ? s_variantCompiler.stats.compiled : s_variantCompiler.stats.diskHits);
+        s_variantCompiler.loaded[requestKey]                         = build.modulePath;
+        s_variantCompiler.modules[build.modulePath.generic_string()] = info;
+        if (App::current()->getPrintDbg())
+        {
+            std::string description = build.bCompiled ? "Compiled" : "Loaded cached";
+            description += " shader variant `";
+            description += info.source.string() + "` (" + build.hex + ")";
+            std::cout << utils::makeInfoMessage("SHADER", description) << std::endl;
+        }
+        return build.modulePath;
+    }
+
+    std::vector<fs::path> ShaderVariantCompiler::getDependencies(const fs::path& modulePath)
+    {
+        const auto dirs = getVariantSourceDirs();
+        const auto info = findModuleVariant(modulePath, dirs);
+        if (!info.has_value())
+            return {};
+
+        auto files = findVariantFiles(*info, dirs);
+        for (auto& file : files)
+            file = fs::absolute(file).lexically_normal();
+        return files;
+    }
+
+    void ShaderVariantCompiler::reload(const fs::path& modulePath)
+    {
+        const auto info = findModuleVariant(modulePath, getVariantSourceDirs());
+        if (!info.has_value())
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "SHADER", "No shader source found for module `" + modulePath.string() + "`"));
+        }
+
+        const auto contextJson = makeVariantContextJson(info->context);
+        const auto requestKey  = utils::fnv1a64(contextJson, utils::fnv1a64(info->source.generic_string()));
+        const auto build       = buildShaderVariant(*info, contextJson);
+
+        // Pipelines created from now on pick up the new code under the old path too
+        if (build.modulePath != modulePath)
+            ShaderModuleCache::add(modulePath, build.code);
+
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        ++(build.bCompiled ? s_variantCompiler.stats.compiled : s_variantCompiler.stats.diskHits);
+        s_variantCompiler.loaded[requestKey]                         = build.modulePath;
+        s_variantCompiler.modules[build.modulePath.generic_string()] = *info;
+        if (App::current()->getPrintDbg())
+        {
+            std::string description = "Reloaded shader `";
+            description += modulePath.string() + "` from `" + info->source.string() + "` (" + build.hex + ")";
+            std::cout << utils::makeInfoMessage("SHADER", description) << std::endl;
+        }
+    }
+
+    std::vector<fs::path> ShaderVariantCompiler::getSourceDirs() { return getVariantSourceDirs(); }
+
+    void ShaderVariantCompiler::invalidate()
+    {
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        s_variantCompiler.loaded.clear();
+    }
+
+    void ShaderVariantCompiler::addSourceDir(const fs::path& dir)
+    {
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        s_variantCompiler.sourceDirs.push_back(dir.lexically_normal());
+    }
+
+    void ShaderVariantCompiler::setCacheDir(const fs::path& dir)
+    {
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        s_variantCompiler.cacheDir = dir.lexically_normal();
+    }
+
+    ShaderVariantCompilerStats ShaderVariantCompiler::getStats()
+    {
+        std::lock_guard<std::mutex> lock(s_variantCompiler.mutex);
+        return s_variantCompiler.stats;
+    }
+} // namespace ivulk
@@ -0,0 +1,45 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/core/specialization.hpp>
+
+#include <ivulk/utils/messages.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+namespace ivulk {
+
+    SpecializationData::SpecializationData(const std::vector<SpecializationConstant>& constants)
+    {
+        std::unordered_set<uint32_t> ids;
+        entries.reserve(constants.size());
+        for (std::size_t i = 0; i < constants.size(); ++i)
+        {
+            if (!ids.insert(constants[i].id).second)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::PIPELINE",
+                                            "Specialization constant " + std::to_string(constants[i].id)
+                                                + " is given more than once"));
+            }
+
+            // Values are read straight out of the constant list
+            entries.push_back({
+                .constantID = constants[i].id,
+                .offset     = static_cast<uint32_t>(i * sizeof(SpecializationConstant)
+                                                + offsetof(SpecializationConstant, value)),
+                .size       = sizeof(uint32_t),
+            });
+        }
+
+        info = {
+            .mapEntryCount = static_cast<uint32_t>(entries.size()),
+            .pMapEntries   = entries.data(),
+            .dataSize      = constants.size() * sizeof(SpecializationConstant),
+            .pData         = constants.data(),
+        };
+    }
+} // namespace ivulk
@@ -0,0 +1,134 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/bounds.hpp>
+
+#include <algorithm>
+
+namespace ivulk {
+
+    BoundingSphere BoundingSphere::transformed(const glm::mat4& transform) const
+    {
+        if (!isValid())
+            return *this;
+
+        const float scale = std::max({glm::length(glm::vec3(transform[0])),
+                                      glm::length(glm::vec3(transform[1])),
+                                      glm::length(glm::vec3(transform[2]))});
+        return {
+            .center = glm::vec3(transform * glm::vec4(center, 1.0f)),
+            .radius = radius * scale,
+        };
+    }
+
+    float BoundingBox::getSurfaceArea() const
+    {
+        if (!isValid())
+            return 0.0f;
+        const glm::vec3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool BoundingBox::intersects(const BoundingBox& box) const
+    {
+        return isValid() && box.isValid() && glm::all(glm::lessThanEqual(min, box.max))
+               && glm::all(glm::lessThanEqual(box.min, max));
+    }
+
+    bool BoundingBox::intersects(const BoundingSphere& sphere) const
+    {
+        if (!isValid())
+            return false;
+        if (!sphere.isValid())
+            return true;
+
+        const glm::vec3 closest = glm::clamp(sphere.center, min, max);
+        const glm::vec3 offset  = sphere.center - closest;
+        return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+    }
+
+    bool BoundingBox::intersectRay(glm::vec3 origin,
+                                   glm::vec3 invDirection,
+                                   float maxDistance,
+                                   float& distance) const
+    {
+        if (!isValid())
+            return false;
+
+        // Slab test: the ray is inside the box between the last entry and the first exit of the slabs
+        const glm::vec3 t0   = (min - origin) * invDirection;
+        const glm::vec3 t1   = (max - origin) * invDirection;
+        const glm::vec3 tMin = glm::min(t0, t1);
+        const glm::vec3 tMax = glm::max(t0, t1);
+        const float enter    = std::max({tMin.x, tMin.y, tMin.z, 0.0f});
+        const float exit     = std::min({tMax.x, tMax.y, tMax.z, maxDistance});
+        if (enter > exit)
+            return false;
+        distance = enter;
+        return true;
+    }
+
+    BoundingBox BoundingBox::transformed(const glm::mat4& transform) const
+    {
+        if (!isValid())
+            return *this;
+
+        // Each axis of the transformed box reaches as far as the transformed extents combined
+        const glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+        const glm::vec3 e      = getExtent();
+        const glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * e.x
+                                 + glm::abs(glm::vec3(transform[1])) * e.y
+                                 + glm::abs(glm::vec3(transform[2])) * e.z;
+        return {
+            .min = center - extent,
+            .max = center + extent,
+        };
+    }
+
+    Frustum Frustum::fromMatrix(const glm::mat4& viewProjection)
+    {
+        // Rows of the matrix; GLM matrices are column-major
+        const glm::mat4 m = glm::transpose(viewProjection);
+
+        Frustum frustum {.planes = {
+                             m[3] + m[0], // Left
+                             m[3] - m[0], // Right
+                             m[3] + m[1], // Bottom
+                             m[3] - m[1], // Top
+                             m[2],        // Near, at depth 0
+                             m[3] - m[2], // Far
+                         }};
+        for (auto& plane : frustum.planes)
+            plane /= glm::length(glm::vec3(plane));
+        return frustum;
+    }
+
+    bool Frustum::intersects(const BoundingSphere& sphere) const
+    {
+        if (!sphere.isValid())
+            return true;
+
+        for (const auto& plane : planes)
+        {
+            if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius)
+                return false;
+        }
+        return true;
+    }
+
+    bool Frustum::intersects(const BoundingBox& box) const
+    {
+        if (!box.isValid())
+            return true;
+
+        const glm::vec3 center = box.getCenter();
+        const glm::vec3 extent = box.getExtent();
+        for (const auto& plane : planes)
+        {
+            const glm::vec3 normal = glm::vec3(plane);
+            if (glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), extent))
+                return false;
+        }
+        return true;
+    }
+} // namespace ivulk
@@ -0,0 +1,332 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/bvh.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace ivulk {
+
+    namespace {
+        constexpr uint32_t BinCount = 12u; ///< Candidate splits per axis in `build`
+
+        BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+        {
+            BoundingBox box = a;
+            box.expand(b);
+            return box;
+        }
+    } // namespace
+
+    uint32_t Bvh::insert(const BoundingBox& box, uint32_t value)
+    {
+        uint32_t proxy;
+        if (!m_freeProxies.empty())
+        {
+            proxy = m_freeProxies.back();
+            m_freeProxies.pop_back();
+        }
+        else
+        {
+            proxy = static_cast<uint32_t>(m_proxies.size());
+            m_proxies.emplace_back();
+        }
+
+        const uint32_t leaf = allocateNode();
+        m_nodes[leaf].box   = box;
+        m_nodes[leaf].right = proxy;
+        m_proxies[proxy]    = {.box = box, .value = value, .node = leaf};
+        insertLeaf(leaf);
+        ++m_changes;
+        return proxy;
+    }
+
+    void Bvh::remove(uint32_t proxy)
+    {
+        const uint32_t leaf = m_proxies[proxy].node;
+        removeLeaf(leaf);
+        freeNode(leaf);
+        m_proxies[proxy] = {};
+        m_freeProxies.push_back(proxy);
+        ++m_changes;
+    }
+
+    void Bvh::update(uint32_t proxy, const BoundingBox& box)
+    {
+        auto& p = m_proxies[proxy];
+        if (p.box == box)
+            return;
+
+        p.box               = box;
+        m_nodes[p.node].box = box;
+        refit(m_nodes[p.node].parent);
+        ++m_changes;
+    }
+
+    void Bvh::clear()
+    {
+        m_nodes.clear();
+        m_proxies.clear();
+        m_freeNodes.clear();
+        m_freeProxies.clear();
+        m_root    = Null;
+        m_changes = 0u;
+    }
+
+    void Bvh::optimize()
+    {
+        if (m_changes > 0u && 2u * m_changes >= size())
+            rebuild();
+    }
+
+    void Bvh::rebuild()
+    {
+        m_buildProxies.clear();
+        for (uint32_t i = 0; i < m_proxies.size(); ++i)
+        {
+            if (m_proxies[i].node != Null)
+                m_buildProxies.push_back(i);
+        }
+
+        m_nodes.clear();
+        m_freeNodes.clear();
+        m_changes = 0u;
+        if (m_buildProxies.empty())
+        {
+            m_root = Null;
+            return;
+        }
+
+        m_nodes.reserve(2u * m_buildProxies.size() - 1u);
+        m_root = build(0u, static_cast<uint32_t>(m_buildProxies.size()), Null);
+    }
+
+    uint32_t Bvh::build(uint32_t begin, uint32_t end, uint32_t parent)
+    {
+        const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.push_back({.parent = parent});
+
+        if (end - begin == 1u)
+        {
+            const uint32_t proxy  = m_buildProxies[begin];
+            m_nodes[index].box    = m_proxies[proxy].box;
+            m_nodes[index].right  = proxy;
+            m_proxies[proxy].node = index;
+            return index;
+        }
+
+        BoundingBox bounds, centroids;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            const auto& box = m_proxies[m_buildProxies[i]].box;
+            bounds.expand(box);
+            centroids.expand(box.getCenter());
+        }
+        m_nodes[index].box = bounds;
+
+        // Bin the centroids along the longest axis, and split where the surface area heuristic is lowest
+        const glm::vec3 size = centroids.max - centroids.min;
+        const int axis       = (size.x >= size.y && size.x >= size.z) ? 0 : (size.y >= size.z ? 1 : 2);
+        const float lo       = centroids.min[axis];
+        const float extent   = size[axis];
+
+        uint32_t mid = begin + (end - begin) / 2u;
+        if (extent > 0.0f)
+        {
+            struct Bin
+            {
+                BoundingBox box = {};
+                uint32_t count  = 0u;
+            };
+            std::array<Bin, BinCount> bins;
+
+            auto binOf = [&](uint32_t proxy) {
+                const float c = m_proxies[proxy].box.getCenter()[axis];
+                return std::min(static_cast<uint32_t>((c - lo) / extent * BinCount), BinCount - 1u);
+            };
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                auto& bin = bins[binOf(m_buildProxies[i])];
+                bin.box.expand(m_proxies[m_buildProxies[i]].box);
+                ++bin.count;
+            }
+
+            // Area times count of everything right of each split, swept from the right
+            std::array<float, BinCount> rightCost = {};
+            BoundingBox rightBox;
+            uint32_t rightCount = 0u;
+            for (uint32_t i = BinCount - 1u; i > 0u; --i)
+            {
+                rightBox.expand(bins[i].box);
+                rightCount += bins[i].count;
+                rightCost[i] = rightBox.getSurfaceArea() * static_cast<float>(rightCount);
+            }
+
+            float bestCost   = std::numeric_limits<float>::max();
+            uint32_t bestBin = 0u;
+            BoundingBox leftBox;
+            uint32_t leftCount = 0u;
+            for (uint32_t i = 1u; i < BinCount; ++i)
+            {
+                leftBox.expand(bins[i - 1u].box);
+                leftCount += bins[i - 1u].count;
+                const float cost = leftBox.getSurfaceArea() * static_cast<float>(leftCount) + rightCost[i];
+                if (leftCount > 0u && leftCount < end - begin && cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestBin  = i;
+                }
+            }
+
+            if (bestBin > 0u)
+            {
+                auto first = m_buildProxies.begin() + begin;
+                auto split = std::partition(first, m_buildProxies.begin() + end, [&](uint32_t proxy) {
+                    return binOf(proxy) < bestBin;
+                });
+                mid = static_cast<uint32_t>(split - m_buildProxies.begin());
+            }
+        }
+
+        // The left child directly follows its parent
+        const uint32_t left  = build(begin, mid, index);
+        const uint32_t right = build(mid, end, index);
+        m_nodes[index].left  = left;
+        m_nodes[index].right = right;
+        return index;
+    }
+
+    uint32_t Bvh::allocateNode()
+    {
+        if (!m_freeNodes.empty())
+        {
+            const uint32_t node = m_freeNodes.back();
+            m_freeNodes.pop_back();
+            m_nodes[node] = {};
+            return node;
+        }
+        m_nodes.emplace_back();
+        return static_cast<uint32_t>(m_nodes.size() - 1u);
+    }
+
+    void Bvh::freeNode(uint32_t node)
+    {
+        m_nodes[node] = {};
+        m_freeNodes.push_back(node);
+    }
+
+    void Bvh::insertLeaf(uint32_t leaf)
+    {
+        if (m_root == Null)
+        {
+            m_root               = leaf;
+            m_nodes[leaf].parent = Null;
+            return;
+        }
+
+        // Walk down towards the sibling that adds the least surface area to the tree. Every node above the
+        // new leaf grows to contain it, which is charged to the children as inherited cost.
+        const BoundingBox box = m_nodes[leaf].box;
+        uint32_t sibling      = m_root;
+        while (!isLeaf(m_nodes[sibling]))
+        {
+            const Node& node          = m_nodes[sibling];
+            const float area          = node.box.getSurfaceArea();
+            const float combinedArea  = merge(node.box, box).getSurfaceArea();
+            const float cost          = 2.0f * combinedArea;          // New parent of the leaf and this node
+            const float inheritedCost = 2.0f * (combinedArea - area); // Growing this node
+
+            auto childCost = [&](uint32_t child) {
+                const BoundingBox& childBox = m_nodes[child].box;
+                const float grown           = merge(childBox, box).getSurfaceArea();
+                return (isLeaf(m_nodes[child]) ? grown : grown - childBox.getSurfaceArea()) + inheritedCost;
+            };
+            const float leftCost  = childCost(node.left);
+            const float rightCost = childCost(node.right);
+
+            if (cost < leftCost && cost < rightCost)
+                break;
+            sibling = (leftCost < rightCost) ? node.left : node.right;
+        }
+
+        const uint32_t oldParent = m_nodes[sibling].parent;
+        const uint32_t parent    = allocateNode();
+        m_nodes[parent].parent   = oldParent;
+        m_nodes[parent].box      = merge(m_nodes[sibling].box, box);
+        m_nodes[parent].left     = sibling;
+        m_nodes[parent].right    = leaf;
+        m_nodes[sibling].parent  = parent;
+        m_nodes[leaf].parent     = parent;
+
+        if (oldParent == Null)
+        {
+            m_root = parent;
+            return;
+        }
+        auto& p = m_nodes[oldParent];
+        (p.left == sibling ? p.left : p.right) = parent;
+        refit(oldParent);
+    }
+
+    void Bvh::removeLeaf(uint32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = Null;
+            return;
+        }
+
+        // The sibling takes the parent's place
+        const uint32_t parent      = m_nodes[leaf].parent;
+        const uint32_t grandparent = m_nodes[parent].parent;
+        const uint32_t sibling =
+            m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+        m_nodes[sibling].parent = grandparent;
+        freeNode(parent);
+
+        if (grandparent == Null)
+        {
+            m_root = sibling;
+            return;
+        }
+        auto& g = m_nodes[grandparent];
+        (g.left == parent ? g.left : g.right) = sibling;
+        refit(grandparent);
+    }
+
+    void Bvh::refit(uint32_t node)
+    {
+        while (node != Null)
+        {
+            auto& n               = m_nodes[node];
+            const BoundingBox box = merge(m_nodes[n.left].box, m_nodes[n.right].box);
+            if (box == n.box)
+                return;
+            n.box = box;
+            node  = n.parent;
+        }
+    }
+
+    bool Bvh::testPlanes(const Frustum& frustum, const BoundingBox& box, uint32_t& mask)
+    {
+        const glm::vec3 center = box.getCenter();
+        const glm::vec3 extent = box.getExtent();
+        for (uint32_t i = 0; i < frustum.planes.size(); ++i)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+
+            const glm::vec4& plane = frustum.planes[i];
+            const glm::vec3 normal = glm::vec3(plane);
+            const float distance   = glm::dot(normal, center) + plane.w;
+            const float reach      = glm::dot(glm::abs(normal), extent);
+            if (distance + reach < 0.0f)
+                return false;
+            if (distance - reach >= 0.0f)
+                mask &= ~(1u << i);
+        }
+        return true;
+    }
+} // namespace ivulk
@@ -0,0 +1,239 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/frustum_culler.hpp>
+
+#include <array>
+#include <limits>
+
+#if defined(__AVX__)
+#    include <immintrin.h>
+#    define IVULK_CULL_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define IVULK_CULL_SSE
+#endif
+
+namespace ivulk {
+
+    namespace {
+        constexpr std::size_t BatchSize = 8u; ///< Objects are padded to a multiple of this
+
+        /**
+         * @brief A frustum plane, with the absolute normal used to project box extents onto it
+         */
+        struct CullPlane
+        {
+            float nx, ny, nz, w;
+            float ax, ay, az;
+        };
+
+        using CullPlanes = std::array<CullPlane, 6>;
+
+        /**
+         * @brief Pointers to the arrays of a `FrustumCuller`
+         */
+        struct CullArrays
+        {
+            const float *cx, *cy, *cz;
+            const float *ex, *ey, *ez;
+            const float *sx, *sy, *sz;
+            const float* r;
+            uint8_t* visible;
+        };
+
+        // An object is outside a plane if its box center is further behind it than the box reaches
+        // along its normal, or if its sphere center is further behind it than the radius.
+
+#if defined(IVULK_CULL_AVX)
+        void cullBatches(const CullPlanes& planes, const CullArrays& a, std::size_t count)
+        {
+            const __m256 zero = _mm256_setzero_ps();
+            for (std::size_t i = 0; i < count; i += 8u)
+            {
+                const __m256 cx = _mm256_loadu_ps(a.cx + i);
+                const __m256 cy = _mm256_loadu_ps(a.cy + i);
+                const __m256 cz = _mm256_loadu_ps(a.cz + i);
+                const __m256 ex = _mm256_loadu_ps(a.ex + i);
+                const __m256 ey = _mm256_loadu_ps(a.ey + i);
+                const __m256 ez = _mm256_loadu_ps(a.ez + i);
+                const __m256 sx = _mm256_loadu_ps(a.sx + i);
+                const __m256 sy = _mm256_loadu_ps(a.sy + i);
+                const __m256 sz = _mm256_loadu_ps(a.sz + i);
+                const __m256 r  = _mm256_loadu_ps(a.r + i);
+
+                __m256 outside = zero;
+                for (const auto& p : planes)
+                {
+                    const __m256 nx = _mm256_set1_ps(p.nx);
+                    const __m256 ny = _mm256_set1_ps(p.ny);
+                    const __m256 nz = _mm256_set1_ps(p.nz);
+                    const __m256 w  = _mm256_set1_ps(p.w);
+
+                    const __m256 boxDist = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(nx, cx), _mm256_mul_ps(ny, cy)),
+                        _mm256_add_ps(_mm256_mul_ps(nz, cz), w));
+                    const __m256 reach = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.ax), ex),
+                                      _mm256_mul_ps(_mm256_set1_ps(p.ay), ey)),
+                        _mm256_mul_ps(_mm256_set1_ps(p.az), ez));
+                    const __m256 sphereDist = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(nx, sx), _mm256_mul_ps(ny, sy)),
+                        _mm256_add_ps(_mm256_mul_ps(nz, sz), w));
+
+                    outside = _mm256_or_ps(
+                        outside, _mm256_cmp_ps(_mm256_add_ps(boxDist, reach), zero, _CMP_LT_OQ));
+                    outside = _mm256_or_ps(
+                        outside, _mm256_cmp_ps(_mm256_add_ps(sphereDist, r), zero, _CMP_LT_OQ));
+                }
+
+                const int mask = _mm256_movemask_ps(outside);
+                for (std::size_t j = 0; j < 8u; ++j)
+                    a.visible[i + j] = ((mask >> j) & 1) ? 0u : 1u;
+            }
+        }
+#elif defined(IVULK_CULL_SSE)
+        void cullBatches(const CullPlanes& planes, const CullArrays& a, std::size_t count)
+        {
+            const __m128 zero = _mm_setzero_ps();
+            for (std::size_t i = 0; i < count; i += 4u)
+            {
+                const __m128 cx = _mm_loadu_ps(a.cx + i);
+                const __m128 cy = _mm_loadu_ps(a.cy + i);
+                const __m128 cz = _mm_loadu_ps(a.cz + i);
+                const __m128 ex = _mm_loadu_ps(a.ex + i);
+                const __m128 ey = _mm_loadu_ps(a.ey + i);
+                const __m128 ez = _mm_loadu_ps(a.ez + i);
+                const __m128 sx = _mm_loadu_ps(a.sx + i);
+                const __m128 sy = _mm_loadu_ps(a.sy + i);
+                const __m128 sz = _mm_loadu_ps(a.sz + i);
+                const __m128 r  = _mm_loadu_ps(a.r + i);
+
+                __m128 outside = zero;
+                for (const auto& p : planes)
+                {
+                    const __m128 nx = _mm_set1_ps(p.nx);
+                    const __m128 ny = _mm_set1_ps(p.ny);
+                    const __m128 nz = _mm_set1_ps(p.nz);
+                    const __m128 w  = _mm_set1_ps(p.w);
+
+                    const __m128 boxDist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+                                                      _mm_add_ps(_mm_mul_ps(nz, cz), w));
+                    const __m128 reach   = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.ax), ex), _mm_mul_ps(_mm_set1_ps(p.ay), ey)),
+                        _mm_mul_ps(_mm_set1_ps(p.az), ez));
+                    const __m128 sphereDist = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(nx, sx), _mm_mul_ps(ny, sy)), _mm_add_ps(_mm_mul_ps(nz, sz), w));
+
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(boxDist, reach), zero));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(sphereDist, r), zero));
+                }
+
+                const int mask = _mm_movemask_ps(outside);
+                for (std::size_t j = 0; j < 4u; ++j)
+                    a.visible[i + j] = ((mask >> j) & 1) ? 0u : 1u;
+            }
+        }
+#else
+        void cullBatches(const CullPlanes& planes, const CullArrays& a, std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                bool bOutside = false;
+                for (const auto& p : planes)
+                {
+                    const float boxDist    = p.nx * a.cx[i] + p.ny * a.cy[i] + p.nz * a.cz[i] + p.w;
+                    const float reach      = p.ax * a.ex[i] + p.ay * a.ey[i] + p.az * a.ez[i];
+                    const float sphereDist = p.nx * a.sx[i] + p.ny * a.sy[i] + p.nz * a.sz[i] + p.w;
+                    bOutside |= boxDist + reach < 0.0f || sphereDist + a.r[i] < 0.0f;
+                }
+                a.visible[i] = bOutside ? 0u : 1u;
+            }
+        }
+#endif
+    } // namespace
+
+    void FrustumCuller::clear()
+    {
+        m_count        = 0u;
+        m_visibleCount = 0u;
+    }
+
+    std::size_t FrustumCuller::add(const BoundingBox& box, const BoundingSphere& sphere)
+    {
+        if (m_count == m_centerX.size())
+        {
+            const std::size_t size = m_count + BatchSize;
+            for (auto* v : {&m_centerX,
+                            &m_centerY,
+                            &m_centerZ,
+                            &m_extentX,
+                            &m_extentY,
+                            &m_extentZ,
+                            &m_sphereX,
+                            &m_sphereY,
+                            &m_sphereZ,
+                            &m_radius})
+                v->resize(size, 0.0f);
+            m_visible.resize(size, 1u);
+        }
+
+        // Unbounded volumes reach through every plane
+        constexpr float unbounded = std::numeric_limits<float>::max();
+
+        const std::size_t index = m_count++;
+        const glm::vec3 center  = box.isValid() ? box.getCenter() : glm::vec3(0);
+        const glm::vec3 extent  = box.isValid() ? box.getExtent() : glm::vec3(unbounded);
+        m_centerX[index]        = center.x;
+        m_centerY[index]        = center.y;
+        m_centerZ[index]        = center.z;
+        m_extentX[index]        = extent.x;
+        m_extentY[index]        = extent.y;
+        m_extentZ[index]        = extent.z;
+        m_sphereX[index]        = sphere.isValid() ? sphere.center.x : 0.0f;
+        m_sphereY[index]        = sphere.isValid() ? sphere.center.y : 0.0f;
+        m_sphereZ[index]        = sphere.isValid() ? sphere.center.z : 0.0f;
+        m_radius[index]         = sphere.isValid() ? sphere.radius : unbounded;
+        return index;
+    }
+
+    void FrustumCuller::cull(const Frustum& frustum)
+    {
+        CullPlanes planes;
+        for (std::size_t i = 0; i < planes.size(); ++i)
+        {
+            const glm::vec4& p = frustum.planes[i];
+            planes[i]          = {
+                .nx = p.x,
+                .ny = p.y,
+                .nz = p.z,
+                .w  = p.w,
+                .ax = glm::abs(p.x),
+                .ay = glm::abs(p.y),
+                .az = glm::abs(p.z),
+            };
+        }
+
+        // Padding past `m_count` is tested too, and ignored
+        const std::size_t padded = (m_count + BatchSize - 1u) / BatchSize * BatchSize;
+        cullBatches(planes,
+                    {
+                        .cx      = m_centerX.data(),
+                        .cy      = m_centerY.data(),
+                        .cz      = m_centerZ.data(),
+                        .ex      = m_extentX.data(),
+                        .ey      = m_extentY.data(),
+                        .ez      = m_extentZ.data(),
+                        .sx      = m_sphereX.data(),
+                        .sy      = m_sphereY.data(),
+                        .sz      = m_sphereZ.data(),
+                        .r       = m_radius.data(),
+                        .visible = m_visible.data(),
+                    },
+                    padded);
+
+        m_visibleCount = 0u;
+        for (std::size_t i = 0; i < m_count; ++i)
+            m_visibleCount += m_visible[i];
+    }
+} // namespace ivulk
@@ -0,0 +1,226 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/geometry_pool.hpp>
+
+#include <ivulk/core/app.hpp>
+
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+
+namespace ivulk {
+
+    namespace {
+        /**
+         * @brief Take `count` elements from the first gap of a free list they fit in.
+         *
+         * @return The offset of the elements, or nothing if no gap is large enough
+         */
+        std::optional<uint32_t> takeGap(std::map<uint32_t, uint32_t>& gaps, uint32_t count)
+        {
+            for (auto it = gaps.begin(); it != gaps.end(); ++it)
+            {
+                const auto [offset, size] = *it;
+                if (size < count)
+                    continue;
+                gaps.erase(it);
+                if (size > count)
+                    gaps.emplace(offset + count, size - count);
+                return offset;
+            }
+            return {};
+        }
+
+        /**
+         * @brief Return elements to a free list, merging them with the gaps around them. Gaps reaching
+         *        `used` are dropped and `used` lowered, so they're appended to again.
+         */
+        void addGap(std::map<uint32_t, uint32_t>& gaps, uint32_t& used, uint32_t offset, uint32_t count)
+        {
+            if (count == 0u)
+                return;
+
+            auto next = gaps.lower_bound(offset);
+            if (next != gaps.begin())
+            {
+                auto prev = std::prev(next);
+                if (prev->first + prev->second == offset)
+                {
+                    offset = prev->first;
+                    count += prev->second;
+                    gaps.erase(prev);
+                }
+            }
+            if (next != gaps.end() && offset + count == next->first)
+            {
+                count += next->second;
+                gaps.erase(next);
+            }
+
+            if (offset + count == used)
+                used = offset;
+            else
+                gaps.emplace(offset, count);
+        }
+    } // namespace
+
+    struct SharedGeometryPools
+    {
+        std::unordered_map<uint32_t, GeometryPool::Ptr> pools; ///< Pools by vertex stride
+        std::mutex mutex;
+    };
+
+    SharedGeometryPools s_geometryPools;
+
+    GeometryPool::Ptr GeometryPool::create(uint32_t vertexStride)
+    {
+        return Ptr(new GeometryPool(vertexStride));
+    }
+
+    GeometryPool::Ptr GeometryPool::get(uint32_t vertexStride)
+    {
+        std::lock_guard<std::mutex> lock(s_geometryPools.mutex);
+        auto& pool = s_geometryPools.pools[vertexStride];
+        if (!pool)
+            pool = create(vertexStride);
+        return pool;
+    }
+
+    void GeometryPool::release()
+    {
+        std::lock_guard<std::mutex> lock(s_geometryPools.mutex);
+        s_geometryPools.pools.clear();
+    }
+
+    void GeometryPool::reserve(Buffer::Ptr& buffer,
+                               VkDeviceSize used,
+                               VkDeviceSize size,
+                               vk::BufferUsageFlags usage)
+    {
+        if (buffer && buffer->getSize() >= size)
+            return;
+
+        VkDeviceSize capacity = buffer ? buffer->getSize() : 64u * 1024u;
+        while (capacity < size)
+            capacity *= 2u;
+
+        // Growing copies the old contents, so the buffers are transfer sources too
+        usage |= E_BufferUsage::TransferSrc | E_BufferUsage::TransferDst;
+        auto grown = Buffer::create(App::current()->getState().vk.device,
+                                    {
+                                        .size       = capacity,
+                                        .usage      = usage,
+                                        .memoryMode = E_MemoryMode::GpuOnly,
+                                    });
+        if (buffer && used > 0u)
+            grown->copyRegionFromBuffer(buffer, 0, 0, used);
+        buffer = grown;
+    }
+
+    void
+    GeometryPool::upload(const Buffer::Ptr& buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+    {
+        if (size == 0u)
+            return;
+
+        auto stageBuf = Buffer::create(App::current()->getState().vk.device,
+                                       {
+                                           .size       = size,
+                                           .usage      = E_BufferUsage::TransferSrc,
+                                           .memoryMode = E_MemoryMode::CpuToGpu,
+                                       });
+        stageBuf->fillBuffer(data, size);
+        buffer->copyRegionFromBuffer(stageBuf, 0, offset, size);
+    }
+
+    GeometryRange
+    GeometryPool::add(const void* vertices, uint32_t vertexCount, const std::vector<uint32_t>& indices)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const VkDeviceSize vertexBytes = VkDeviceSize(vertexCount) * m_vertexStride;
+        uint32_t firstVertex           = 0u;
+        if (auto gap = takeGap(m_freeVertices, vertexCount); gap.has_value())
+        {
+            firstVertex = *gap;
+        }
+        else
+        {
+            const VkDeviceSize usedVertexBytes = VkDeviceSize(m_vertexCount) * m_vertexStride;
+            reserve(m_vertexBuffer, usedVertexBytes, usedVertexBytes + vertexBytes, E_BufferUsage::Vertex);
+            firstVertex = m_vertexCount;
+            m_vertexCount += vertexCount;
+        }
+        upload(m_vertexBuffer, VkDeviceSize(firstVertex) * m_vertexStride, vertices, vertexBytes);
+
+        const GeometryRange range {
+            .indexCount   = static_cast<uint32_t>(indices.size()),
+            .firstIndex   = appendIndices(indices),
+            .vertexOffset = static_cast<int32_t>(firstVertex),
+        };
+        if (vertexCount > 0u)
+            m_vertexBlockSizes[range.vertexOffset] = vertexCount;
+        return range;
+    }
+
+    GeometryRange GeometryPool::addIndices(int32_t vertexOffset, const std::vector<uint32_t>& indices)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return {
+            .indexCount   = static_cast<uint32_t>(indices.size()),
+            .firstIndex   = appendIndices(indices),
+            .vertexOffset = vertexOffset,
+        };
+    }
+
+    void GeometryPool::remove(const GeometryRange& range)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        addGap(m_freeIndices, m_indexCount, range.firstIndex, range.indexCount);
+
+        if (auto it = m_vertexBlockSizes.find(range.vertexOffset); it != m_vertexBlockSizes.end())
+        {
+            addGap(m_freeVertices, m_vertexCount, static_cast<uint32_t>(range.vertexOffset), it->second);
+            m_vertexBlockSizes.erase(it);
+        }
+    }
+
+    void GeometryPool::removeIndices(const GeometryRange& range)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        addGap(m_freeIndices, m_indexCount, range.firstIndex, range.indexCount);
+    }
+
+    uint32_t GeometryPool::appendIndices(const std::vector<uint32_t>& indices)
+    {
+        const auto count              = static_cast<uint32_t>(indices.size());
+        const VkDeviceSize indexBytes = sizeof(uint32_t) * VkDeviceSize(count);
+        uint32_t firstIndex           = 0u;
+        if (auto gap = takeGap(m_freeIndices, count); gap.has_value())
+        {
+            firstIndex = *gap;
+        }
+        else
+        {
+            const VkDeviceSize usedIndexBytes = sizeof(uint32_t) * VkDeviceSize(m_indexCount);
+            reserve(m_indexBuffer, usedIndexBytes, usedIndexBytes + indexBytes, E_BufferUsage::Index);
+            firstIndex = m_indexCount;
+            m_indexCount += count;
+        }
+        upload(m_indexBuffer, sizeof(uint32_t) * VkDeviceSize(firstIndex), indices.data(), indexBytes);
+        return firstIndex;
+    }
+
+    Buffer::Ptr GeometryPool::getVertexBuffer()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_vertexBuffer;
+    }
+
+    Buffer::Ptr GeometryPool::getIndexBuffer()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_indexBuffer;
+    }
+} // namespace ivulk
@@ -0,0 +1,464 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/gpu_culler.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/render/bounds.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <array>
+
+namespace ivulk {
+
+    // Uniform block, matching the `shaders/cull/cull.comp` shader
+    struct GpuCullParams
+    {
+        glm::mat4 occlusionViewProjection;
+        std::array<glm::vec4, 6> planes;
+        glm::vec2 pyramidSize;
+        uint32_t instanceCount;
+        uint32_t pyramidLevels; ///< Zero to skip occlusion tests
+    };
+
+    // Push constant block, matching the `shaders/cull/depth_pyramid.comp` shader
+    struct DepthPyramidParams
+    {
+        int32_t srcWidth;
+        int32_t srcHeight;
+        int32_t dstWidth;
+        int32_t dstHeight;
+    };
+
+    VkExtent2D halvePyramidExtent(VkExtent2D extent)
+    {
+        return {
+            .width  = std::max((extent.width + 1u) / 2u, 1u),
+            .height = std::max((extent.height + 1u) / 2u, 1u),
+        };
+    }
+
+    uint32_t calcPyramidLevels(VkExtent2D extent)
+    {
+        uint32_t levels = 1u;
+        while (extent.width > 1u || extent.height > 1u)
+        {
+            extent = halvePyramidExtent(extent);
+            ++levels;
+        }
+        return std::min(levels, GpuCuller::MaxPyramidLevels);
+    }
+
+    VkImageView makePyramidView(VkDevice device, VkImage image, uint32_t level)
+    {
+        const VkImageViewCreateInfo viewInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = image,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = VK_FORMAT_R32_SFLOAT,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = level,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to make Vulkan image view for depth pyramid"));
+        }
+        return view;
+    }
+
+    void recordComputeBarrier(VkCommandBuffer cb, VkPipelineStageFlags dstStages, VkAccessFlags dstAccess)
+    {
+        const VkMemoryBarrier barrier {
+            .sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+            .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+            .dstAccessMask = dstAccess,
+        };
+        vkCmdPipelineBarrier(
+            cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStages, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    GpuCuller::GpuCuller(VkDevice device,
+                         ComputePipeline::Ptr cull,
+                         ComputePipeline::Ptr pyramid,
+                         Sampler::Ptr sampler)
+        : base_t(device, handles_t {cull, pyramid, sampler})
+    { }
+
+    void GpuCuller::destroyImpl()
+    {
+        // Pipelines and sampler are released with the handles tuple
+        destroyPyramidViews();
+        for (auto& frame : m_frames)
+        {
+            if (frame.pool != VK_NULL_HANDLE)
+                vkDestroyDescriptorPool(getDevice(), frame.pool, nullptr);
+        }
+        m_frames.clear();
+        m_pyramid.reset();
+    }
+
+    GpuCuller* GpuCuller::createImpl(VkDevice device, NullResourceInfo)
+    {
+        const std::vector<ComputeDescriptorBinding> cullBindings = {
+            {.binding = 0u, .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER},
+            {.binding = 1u, .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+            {.binding = 2u, .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+            {.binding = 3u, .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER},
+            {.binding = 4u, .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+        };
+        const std::vector<ComputeDescriptorBinding> pyramidBindings = {
+            {.binding = 0u, .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+            {.binding = 1u, .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+        };
+        auto cull    = ComputePipeline::create(device,
+                                            {
+                                                .shaderPath = "shaders/cull/cull.comp.spv",
+                                                .descriptor = {.bindings = cullBindings},
+                                            });
+        auto pyramid = ComputePipeline::create(device,
+                                               {
+                                                   .shaderPath       = "shaders/cull/depth_pyramid.comp.spv",
+                                                   .descriptor       = {.bindings = pyramidBindings},
+                                                   .pushConstantSize = sizeof(DepthPyramidParams),
+                                               });
+        // Depth is only ever fetched texel by texel
+        auto sampler = Sampler::create(device,
+                                       {
+                                           .filter      = {.min = E_SamplerFilter::Nearest,
+                                                      .mag = E_SamplerFilter::Nearest},
+                                           .addressMode = {
+                                               .u = E_SamplerAddressMode::ClampEdge,
+                                               .v = E_SamplerAddressMode::ClampEdge,
+                                               .w = E_SamplerAddressMode::ClampEdge,
+                                           },
+                                           .anisotropy = {.bEnable = VK_FALSE},
+                                           .mips       = {.mode = VK_SAMPLER_MIPMAP_MODE_NEAREST},
+                                       });
+        return new GpuCuller(device, cull, pyramid, sampler);
+    }
+
+    void GpuCuller::setDepth(Image::Ref depth, const glm::mat4& viewProjection)
+    {
+        m_depth               = depth;
+        m_depthViewProjection = viewProjection;
+        m_bDepthPending       = true;
+    }
+
+    void GpuCuller::resetDepth()
+    {
+        m_depth         = {};
+        m_bDepthPending = false;
+        m_bPyramidValid = false;
+    }
+
+    VkDescriptorSet GpuCuller::allocateSet(VkDescriptorPool pool, const ComputePipeline::Ptr& pipeline)
+    {
+        VkDescriptorSetLayout layout = pipeline->getDescriptorSetLayout();
+        const VkDescriptorSetAllocateInfo allocInfo {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout,
+        };
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(getDevice(), &allocInfo, &set) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::PIPELINE", "Failed to allocate descriptor set for culling"));
+        }
+        return set;
+    }
+
+    void GpuCuller::destroyPyramidViews()
+    {
+        for (auto view : m_levelViews)
+            vkDestroyImageView(getDevice(), view, nullptr);
+        m_levelViews.clear();
+    }
+
+    void GpuCuller::reservePyramid(VkCommandBuffer cb, VkExtent2D depthExtent)
+    {
+        if (m_pyramid && m_depthExtent.width == depthExtent.width
+            && m_depthExtent.height == depthExtent.height)
+            return;
+
+        destroyPyramidViews();
+        m_depthExtent   = depthExtent;
+        m_pyramidExtent = halvePyramidExtent(depthExtent);
+
+        const uint32_t levels = calcPyramidLevels(m_pyramidExtent);
+        m_pyramid = Image::create(getDevice(), {
+            .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            .format = VK_FORMAT_R32_SFLOAT,
+            .extent = {
+                .width = m_pyramidExtent.width,
+                .height = m_pyramidExtent.height,
+                .depth = 1,
+            },
+            .mipLevels = levels,
+        });
+        for (uint32_t level = 0u; level < levels; ++level)
+            m_levelViews.push_back(makePyramidView(getDevice(), m_pyramid->getImage(), level));
+
+        // Levels stay in the general layout, as each one is written and then sampled
+        const VkImageMemoryBarrier barrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = 0,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+			.newLayout = VK_IMAGE_LAYOUT_GENERAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = m_pyramid->getImage(),
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = levels,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &barrier);
+    }
+
+    void GpuCuller::recordPyramid(VkCommandBuffer cb, VkDescriptorPool pool, const Image::Ptr& depth)
+    {
+        VkDevice device        = getDevice();
+        const auto depthExtent = depth->getExtent();
+        reservePyramid(cb, {.width = depthExtent.width, .height = depthExtent.height});
+
+        // The depth attachment is sampled in place
+        const VkImageMemoryBarrier depthBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+			.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			.newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = depth->getImage(),
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             1,
+                             &depthBarrier);
+
+        auto pipeline             = getHandleAt<1>();
+        VkPipelineLayout plLayout = pipeline->getPipelineLayout();
+        VkSampler sampler         = getHandleAt<2>()->getSampler();
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->getPipeline());
+
+        VkExtent2D srcExtent = m_depthExtent;
+        VkExtent2D dstExtent = m_pyramidExtent;
+        for (uint32_t level = 0u; level < m_levelViews.size(); ++level)
+        {
+            // Each level is reduced from the one above it
+            if (level > 0u)
+                recordComputeBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+            VkDescriptorSet set = allocateSet(pool, pipeline);
+            const VkDescriptorImageInfo srcInfo {
+                .sampler     = sampler,
+                .imageView   = level == 0u ? depth->getImageView() : m_levelViews[level - 1u],
+                .imageLayout = level == 0u ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL
+                                           : VK_IMAGE_LAYOUT_GENERAL,
+            };
+            const VkDescriptorImageInfo dstInfo {
+                .sampler     = VK_NULL_HANDLE,
+                .imageView   = m_levelViews[level],
+                .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+            };
+            const std::array<VkWriteDescriptorSet, 2> writes = {{
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = set,
+                    .dstBinding      = 0u,
+                    .descriptorCount = 1u,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                    .pImageInfo      = &srcInfo,
+                },
+                {
+                    .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .dstSet          = set,
+                    .dstBinding      = 1u,
+                    .descriptorCount = 1u,
+                    .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                    .pImageInfo      = &dstInfo,
+                },
+            }};
+            vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+            const DepthPyramidParams params {
+                .srcWidth  = static_cast<int32_t>(srcExtent.width),
+                .srcHeight = static_cast<int32_t>(srcExtent.height),
+                .dstWidth  = static_cast<int32_t>(dstExtent.width),
+                .dstHeight = static_cast<int32_t>(dstExtent.height),
+            };
+            vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, plLayout, 0, 1, &set, 0, nullptr);
+            vkCmdPushConstants(
+                cb, plLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DepthPyramidParams), &params);
+            vkCmdDispatch(cb,
+                          ComputePipeline::groupCount(dstExtent.width, PyramidGroupSize),
+                          ComputePipeline::groupCount(dstExtent.height, PyramidGroupSize),
+                          1);
+
+            srcExtent = dstExtent;
+            dstExtent = halvePyramidExtent(dstExtent);
+        }
+
+        recordComputeBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        m_bPyramidValid = true;
+    }
+
+    void GpuCuller::record(VkCommandBuffer cb, const GpuCullPass& pass)
+    {
+        VkDevice device = getDevice();
+
+        // One descriptor pool and parameter buffer per frame in flight, as the GPU may still be reading the
+        // previous frames'
+        const auto frameCount =
+            std::max<std::size_t>(App::current()->getState().vk.swapChain.maxFramesInFlight, 1u);
+        if (m_frames.size() < frameCount)
+            m_frames.resize(frameCount);
+        m_frame     = (m_frame + 1u) % frameCount;
+        auto& frame = m_frames[m_frame];
+
+        if (frame.pool == VK_NULL_HANDLE)
+        {
+            // Enough for the cull set, and a set for every pyramid level
+            const std::array<VkDescriptorPoolSize, 4> poolSizes = {{
+                {.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = 1u},
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 3u},
+                {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 1u + MaxPyramidLevels},
+                {.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = MaxPyramidLevels},
+            }};
+            const VkDescriptorPoolCreateInfo poolInfo {
+                .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+                .maxSets       = 1u + MaxPyramidLevels,
+                .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+                .pPoolSizes    = poolSizes.data(),
+            };
+            if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &frame.pool) != VK_SUCCESS)
+            {
+                throw std::runtime_error(
+                    utils::makeErrorMessage("VK::CREATE", "Failed to create descriptor pool for culling"));
+            }
+        }
+        else
+        {
+            vkResetDescriptorPool(device, frame.pool, 0);
+        }
+
+        // =============== Depth pyramid =============== //
+
+        if (m_bDepthPending)
+        {
+            m_bDepthPending = false;
+            m_bPyramidValid = false;
+            if (auto depth = m_depth.lock())
+                recordPyramid(cb, frame.pool, depth);
+        }
+        // The cull shader always samples a pyramid, even when it skips occlusion tests
+        if (!m_pyramid)
+            reservePyramid(cb, {.width = 1u, .height = 1u});
+
+        if (pass.instanceCount == 0u)
+            return;
+
+        // ==================== Cull ==================== //
+
+        const GpuCullParams params {
+            .occlusionViewProjection = m_depthViewProjection,
+            .planes                  = Frustum::fromMatrix(pass.viewProjection).planes,
+            .pyramidSize             = glm::vec2(m_pyramidExtent.width, m_pyramidExtent.height),
+            .instanceCount           = pass.instanceCount,
+            .pyramidLevels           = m_bPyramidValid ? static_cast<uint32_t>(m_levelViews.size()) : 0u,
+        };
+        if (!frame.params)
+        {
+            frame.params = Buffer::create(device,
+                                          {
+                                              .size       = sizeof(GpuCullParams),
+                                              .usage      = E_BufferUsage::Uniform,
+                                              .memoryMode = E_MemoryMode::CpuToGpu,
+                                          });
+        }
+        frame.params->fillBuffer(&params, sizeof(GpuCullParams));
+
+        auto pipeline       = getHandleAt<0>();
+        VkDescriptorSet set = allocateSet(frame.pool, pipeline);
+        const std::array<VkDescriptorBufferInfo, 4> bufferInfos = {{
+            {.buffer = frame.params->getBuffer(), .offset = 0, .range = sizeof(GpuCullParams)},
+            {.buffer = pass.instances->getBuffer(), .offset = 0, .range = VK_WHOLE_SIZE},
+            {.buffer = pass.commands->getBuffer(), .offset = 0, .range = VK_WHOLE_SIZE},
+            {.buffer = pass.output->getBuffer(), .offset = 0, .range = VK_WHOLE_SIZE},
+        }};
+        const VkDescriptorImageInfo pyramidInfo {
+            .sampler     = getHandleAt<2>()->getSampler(),
+            .imageView   = m_pyramid->getImageView(),
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+        std::array<VkWriteDescriptorSet, 5> writes;
+        for (uint32_t i = 0; i < bufferInfos.size(); ++i)
+        {
+            writes[i] = {
+                .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet          = set,
+                .dstBinding      = i,
+                .descriptorCount = 1u,
+                .descriptorType =
+                    i == 0u ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                .pBufferInfo     = &bufferInfos[i],
+            };
+        }
+        writes[4] = {
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = set,
+            .dstBinding      = 4u,
+            .descriptorCount = 1u,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo      = &pyramidInfo,
+        };
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+        VkPipelineLayout plLayout = pipeline->getPipelineLayout();
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline->getPipeline());
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, plLayout, 0, 1, &set, 0, nullptr);
+        vkCmdDispatch(cb, ComputePipeline::groupCount(pass.instanceCount, GroupSize), 1, 1);
+
+        // Visible instance counts feed the indirect draws, and their matrices the instance attributes
+        recordComputeBarrier(cb,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+                             VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+    }
+} // namespace ivulk
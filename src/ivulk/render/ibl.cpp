@@ -0,0 +1,733 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/ibl.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/core/buffer.hpp>
+#include <ivulk/core/compute_pipeline.hpp>
+#include <ivulk/core/mip_generator.hpp>
+#include <ivulk/core/sampler.hpp>
+#include <ivulk/utils/commands.hpp>
+#include <ivulk/utils/hash.hpp>
+#include <ivulk/utils/messages.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace ivulk {
+    namespace fs = boost::filesystem;
+
+    constexpr uint32_t IBLCacheMagic    = 0x42495649u; ///< "IVIB"
+    constexpr uint32_t IBLCacheVersion  = 1u;
+    constexpr VkFormat IBLFormat        = VK_FORMAT_R16G16B16A16_SFLOAT;
+    constexpr VkDeviceSize IBLTexelSize = 8u;
+    constexpr uint32_t IBLGroupSize     = 8u;
+
+    // Bake shaders, relative to the assets directory
+    constexpr char IBLEquirectShader[]   = "shaders/ibl/equirectToCube.comp.spv";
+    constexpr char IBLIrradianceShader[] = "shaders/ibl/irradiance.comp.spv";
+    constexpr char IBLPrefilterShader[]  = "shaders/ibl/prefilter.comp.spv";
+    constexpr char IBLBrdfShader[]       = "shaders/ibl/brdfLut.comp.spv";
+
+    /**
+     * @brief Header for baked IBL data stored in the cache directory.
+     */
+    struct IBLCacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint64_t dataSize;
+    };
+
+    // Push constant blocks, matching the `shaders/ibl/*.comp` shaders
+    struct IBLEquirectParams
+    {
+        uint32_t faceSize;
+    };
+    struct IBLIrradianceParams
+    {
+        uint32_t faceSize;
+        float sampleDelta;
+        float sourceLod;
+    };
+    struct IBLPrefilterParams
+    {
+        uint32_t faceSize;
+        uint32_t sampleCount;
+        float roughness;
+        float environmentSize;
+    };
+    struct IBLBrdfParams
+    {
+        uint32_t size;
+        uint32_t sampleCount;
+    };
+
+    /**
+     * @brief Transient resources used by a bake, released even if a bake step throws.
+     *
+     * The command buffer is only freed here if it was never submitted; `endOneTimeCommands` frees it
+     * otherwise, and `commandBuffer` must be reset once it has been called.
+     */
+    struct IBLBakeResources
+    {
+        explicit IBLBakeResources(VkDevice device)
+            : device(device)
+        { }
+
+        ~IBLBakeResources()
+        {
+            if (commandBuffer != VK_NULL_HANDLE)
+            {
+                vkEndCommandBuffer(commandBuffer);
+                vkFreeCommandBuffers(device, App::current()->getState().vk.cmd.gfxPool, 1, &commandBuffer);
+            }
+            for (auto view : views)
+            {
+                vkDestroyImageView(device, view, nullptr);
+            }
+            if (pool != VK_NULL_HANDLE)
+            {
+                vkDestroyDescriptorPool(device, pool, nullptr);
+            }
+        }
+
+        IBLBakeResources(const IBLBakeResources&) = delete;
+        IBLBakeResources& operator=(const IBLBakeResources&) = delete;
+
+        VkDevice device;
+        VkDescriptorPool pool         = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        std::vector<VkImageView> views;
+    };
+
+    Image::Ptr makeIBLImage(VkDevice device, uint32_t size, uint32_t mipLevels, bool bCube)
+    {
+        return Image::create(device,
+                             {
+                                 .usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT
+                                          | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+                                 .format      = IBLFormat,
+                                 .extent      = {size, size, 1u},
+                                 .mipLevels   = mipLevels,
+                                 .arrayLayers = bCube ? 6u : 1u,
+                                 .bCube       = bCube,
+                             });
+    }
+
+    VkImageView makeIBLStorageView(VkDevice device, Image& img, uint32_t mipLevel)
+    {
+        VkImageViewCreateInfo viewInfo {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.image = img.getImage(),
+			.viewType = img.getArrayLayers() > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
+			.format = img.getFormat(),
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = mipLevel,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = img.getArrayLayers(),
+			},
+		};
+        VkImageView view = VK_NULL_HANDLE;
+        if (vkCreateImageView(device, &viewInfo, nullptr, &view) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to make Vulkan image view for IBL bake"));
+        }
+        return view;
+    }
+
+    VkImageMemoryBarrier makeIBLBarrier(Image& img,
+                                        VkImageLayout oldLayout,
+                                        VkImageLayout newLayout,
+                                        VkAccessFlags srcAccess,
+                                        VkAccessFlags dstAccess,
+                                        uint32_t baseMipLevel = 0u,
+                                        uint32_t mipLevels    = VK_REMAINING_MIP_LEVELS)
+    {
+        return VkImageMemoryBarrier {
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = srcAccess,
+			.dstAccessMask = dstAccess,
+			.oldLayout = oldLayout,
+			.newLayout = newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = img.getImage(),
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = baseMipLevel,
+				.levelCount = mipLevels,
+				.baseArrayLayer = 0,
+				.layerCount = img.getArrayLayers(),
+			},
+		};
+    }
+
+    /**
+     * @brief Build buffer/image copy regions for every mip level of `img`, packed tightly starting at `offset`.
+     *
+     * `offset` is advanced past the data for the image.
+     */
+    std::vector<VkBufferImageCopy> makeIBLCopyRegions(Image& img, VkDeviceSize& offset)
+    {
+        std::vector<VkBufferImageCopy> regions;
+        const auto extent = img.getExtent();
+        for (uint32_t mip = 0; mip < img.getMipLevels(); ++mip)
+        {
+            const uint32_t w = std::max(extent.width >> mip, 1u);
+            const uint32_t h = std::max(extent.height >> mip, 1u);
+            regions.push_back(VkBufferImageCopy {
+				.bufferOffset = offset,
+				.bufferRowLength = 0,
+				.bufferImageHeight = 0,
+				.imageSubresource = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = mip,
+					.baseArrayLayer = 0,
+					.layerCount = img.getArrayLayers(),
+				},
+				.imageOffset = {0, 0, 0},
+				.imageExtent = {w, h, 1},
+			});
+            offset += static_cast<VkDeviceSize>(w) * h * img.getArrayLayers() * IBLTexelSize;
+        }
+        return regions;
+    }
+
+    VkDescriptorSet allocIBLDescriptorSet(VkDevice device,
+                                          VkDescriptorPool pool,
+                                          ComputePipeline& pipeline,
+                                          VkSampler sampler,
+                                          VkImageView sampledView,
+                                          VkImageView storageView)
+    {
+        VkDescriptorSetLayout layout = pipeline.getDescriptorSetLayout();
+        VkDescriptorSetAllocateInfo allocInfo {
+            .sType              = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .descriptorPool     = pool,
+            .descriptorSetCount = 1,
+            .pSetLayouts        = &layout,
+        };
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        if (vkAllocateDescriptorSets(device, &allocInfo, &set) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::PIPELINE", "Failed to allocate descriptor set for IBL bake"));
+        }
+
+        const VkDescriptorImageInfo sampledInfo {
+            .sampler     = sampler,
+            .imageView   = sampledView,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+        };
+        const VkDescriptorImageInfo storageInfo {
+            .sampler     = VK_NULL_HANDLE,
+            .imageView   = storageView,
+            .imageLayout = VK_IMAGE_LAYOUT_GENERAL,
+        };
+
+        // The output image is always the last binding; the sampled input (if any) is binding 0
+        std::vector<VkWriteDescriptorSet> writes;
+        if (sampledView != VK_NULL_HANDLE)
+        {
+            writes.push_back({
+                .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet          = set,
+                .dstBinding      = 0u,
+                .descriptorCount = 1u,
+                .descriptorType  = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                .pImageInfo      = &sampledInfo,
+            });
+        }
+        writes.push_back({
+            .sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet          = set,
+            .dstBinding      = sampledView != VK_NULL_HANDLE ? 1u : 0u,
+            .descriptorCount = 1u,
+            .descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo      = &storageInfo,
+        });
+        vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+        return set;
+    }
+
+    template <typename Params>
+    void dispatchIBL(VkCommandBuffer cb,
+                     ComputePipeline& pipeline,
+                     VkDescriptorSet set,
+                     const Params& params,
+                     uint32_t size,
+                     uint32_t layers)
+    {
+        VkPipelineLayout layout = pipeline.getPipelineLayout();
+        vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.getPipeline());
+        vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &set, 0, nullptr);
+        vkCmdPushConstants(cb, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(Params), &params);
+        const auto groups = ComputePipeline::groupCount(size, IBLGroupSize);
+        vkCmdDispatch(cb, groups, groups, layers);
+    }
+
+    IBLEnvironment::IBLEnvironment(VkDevice device,
+                                   Image::Ptr environment,
+                                   Image::Ptr irradiance,
+                                   Image::Ptr prefiltered,
+                                   Image::Ptr brdfLut)
+        : base_t(device, handles_t {environment, irradiance, prefiltered, brdfLut})
+    { }
+
+    void IBLEnvironment::destroyImpl()
+    {
+        // Images are released with the handles tuple
+    }
+
+    IBLEnvironment* IBLEnvironment::createImpl(VkDevice device, IBLInfo info)
+    {
+        auto* app = App::current();
+        if (info.hdriPath.is_relative())
+        {
+            info.hdriPath = app->getAssetsDir() / info.hdriPath;
+        }
+
+        const VkExtent3D envExtent {info.environmentSize, info.environmentSize, 1u};
+        const VkExtent3D prefilterExtent {info.prefilterSize, info.prefilterSize, 1u};
+        info.prefilterMips = std::clamp(info.prefilterMips, 1u, Image::calcMipLevels(prefilterExtent));
+
+        // The cache key covers the source image, the SPIR-V of the bake and mip generation shaders, and
+        // every setting that affects the baked data. Everything is hashed with FNV-1a, so keys are stable
+        // across platforms.
+        uint64_t key = utils::hashFile(info.hdriPath);
+        for (const char* shader : {IBLEquirectShader, IBLIrradianceShader, IBLPrefilterShader, IBLBrdfShader})
+            key = utils::hashFile(app->getAssetsDir() / shader, key);
+        for (const char* shader : MipGenerator::ShaderPaths)
+            key = utils::hashFile(app->getAssetsDir() / shader, key);
+        const uint32_t settings[] = {
+            IBLCacheVersion,
+            info.environmentSize,
+            info.irradianceSize,
+            info.prefilterSize,
+            info.prefilterMips,
+            info.brdfLutSize,
+            info.sampleCount,
+        };
+        key = utils::fnv1a64(settings, sizeof(settings), key);
+        const auto cachePath = app->getCacheDir() / "ibl" / (utils::toHexString(key) + ".ivibl");
+
+        std::unique_ptr<IBLEnvironment> ret(
+            new IBLEnvironment(device,
+                               makeIBLImage(device, info.environmentSize, Image::calcMipLevels(envExtent), true),
+                               makeIBLImage(device, info.irradianceSize, 1u, true),
+                               makeIBLImage(device, info.prefilterSize, info.prefilterMips, true),
+                               makeIBLImage(device, info.brdfLutSize, 1u, false)));
+
+        if (info.bUseCache && ret->loadCache(device, cachePath, key))
+        {
+            ret->m_bFromCache = true;
+            if (app->getPrintDbg())
+            {
+                std::cout << utils::makeSuccessMessage("VK::TEX",
+                                                       "Loaded baked IBL data from cache: `" + cachePath.string() + "`")
+                          << std::endl;
+            }
+            return ret.release();
+        }
+
+        ret->bake(device, info);
+        if (app->getPrintDbg())
+        {
+            std::cout << utils::makeSuccessMessage("VK::TEX", "Baked IBL data for `" + info.hdriPath.string() + "`")
+                      << std::endl;
+        }
+        if (info.bUseCache)
+        {
+            ret->saveCache(device, cachePath, key);
+        }
+        return ret.release();
+    }
+
+    void IBLEnvironment::bake(VkDevice device, const IBLInfo& info)
+    {
+        auto env         = getEnvironment();
+        auto irradiance  = getIrradiance();
+        auto prefiltered = getPrefiltered();
+        auto brdfLut     = getBrdfLut();
+
+        // ============ Sources and pipelines ============ //
+
+        auto hdri = Image::create(device,
+                                  {
+                                      .load = {
+                                          .bEnable  = true,
+                                          .path     = info.hdriPath,
+                                          .bGenMips = false,
+                                          .bHDR     = true,
+                                      },
+                                  });
+        auto sampler = Sampler::create(device,
+                                       {
+                                           .addressMode = {
+                                               .u = E_SamplerAddressMode::Repeat,
+                                               .v = E_SamplerAddressMode::ClampEdge,
+                                               .w = E_SamplerAddressMode::ClampEdge,
+                                           },
+                                           .anisotropy = {.bEnable = VK_FALSE},
+                                           .mips       = {.maxLod = VK_LOD_CLAMP_NONE},
+                                       });
+
+        const std::vector<ComputeDescriptorBinding> cubeBindings = {
+            {.binding = 0u, .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER},
+            {.binding = 1u, .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+        };
+        auto equirectPipeline   = ComputePipeline::create(device,
+                                                        {
+                                                            .shaderPath = IBLEquirectShader,
+                                                            .descriptor = {.bindings = cubeBindings},
+                                                            .pushConstantSize = sizeof(IBLEquirectParams),
+                                                        });
+        auto irradiancePipeline = ComputePipeline::create(device,
+                                                          {
+                                                              .shaderPath = IBLIrradianceShader,
+                                                              .descriptor = {.bindings = cubeBindings},
+                                                              .pushConstantSize = sizeof(IBLIrradianceParams),
+                                                          });
+        auto prefilterPipeline  = ComputePipeline::create(device,
+                                                         {
+                                                             .shaderPath = IBLPrefilterShader,
+                                                             .descriptor = {.bindings = cubeBindings},
+                                                             .pushConstantSize = sizeof(IBLPrefilterParams),
+                                                         });
+        auto brdfPipeline       = ComputePipeline::create(device,
+                                                    {
+                                                        .shaderPath = IBLBrdfShader,
+                                                        .descriptor = {.bindings = {
+                                                                           {.binding = 0u,
+                                                                            .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE},
+                                                                       }},
+                                                        .pushConstantSize = sizeof(IBLBrdfParams),
+                                                    });
+
+        // ========== Transient descriptors/views ========== //
+
+        const uint32_t maxSets = 3u + info.prefilterMips;
+        const std::array<VkDescriptorPoolSize, 2> poolSizes = {{
+            {.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = maxSets},
+            {.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = maxSets},
+        }};
+        const VkDescriptorPoolCreateInfo poolInfo {
+            .sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets       = maxSets,
+            .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+            .pPoolSizes    = poolSizes.data(),
+        };
+        IBLBakeResources transient(device);
+        if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &transient.pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error(
+                utils::makeErrorMessage("VK::CREATE", "Failed to create descriptor pool for IBL bake"));
+        }
+        VkDescriptorPool pool = transient.pool;
+
+        auto& views = transient.views;
+        views.push_back(makeIBLStorageView(device, *env, 0u));
+        views.push_back(makeIBLStorageView(device, *irradiance, 0u));
+        views.push_back(makeIBLStorageView(device, *brdfLut, 0u));
+        for (uint32_t mip = 0; mip < info.prefilterMips; ++mip)
+        {
+            views.push_back(makeIBLStorageView(device, *prefiltered, mip));
+        }
+
+        VkSampler vkSampler = sampler->getSampler();
+        auto equirectSet    = allocIBLDescriptorSet(
+            device, pool, *equirectPipeline, vkSampler, hdri->getImageView(), views[0]);
+        auto irradianceSet = allocIBLDescriptorSet(
+            device, pool, *irradiancePipeline, vkSampler, env->getImageView(), views[1]);
+        auto brdfSet = allocIBLDescriptorSet(device, pool, *brdfPipeline, VK_NULL_HANDLE, VK_NULL_HANDLE, views[2]);
+        std::vector<VkDescriptorSet> prefilterSets;
+        for (uint32_t mip = 0; mip < info.prefilterMips; ++mip)
+        {
+            prefilterSets.push_back(allocIBLDescriptorSet(
+                device, pool, *prefilterPipeline, vkSampler, env->getImageView(), views[3 + mip]));
+        }
+
+        // ================== Record bake ================== //
+
+        VkCommandBuffer cb = transient.commandBuffer = utils::beginOneTimeCommands();
+        {
+            std::vector<VkImageMemoryBarrier> barriers = {
+                makeIBLBarrier(
+                    *env, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT),
+                makeIBLBarrier(
+                    *irradiance, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT),
+                makeIBLBarrier(
+                    *prefiltered, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT),
+                makeIBLBarrier(
+                    *brdfLut, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT),
+            };
+            vkCmdPipelineBarrier(cb,
+                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(barriers.size()),
+                                 barriers.data());
+        }
+
+        // Equirectangular -> cube, and the BRDF lookup table (independent of the environment)
+        dispatchIBL(cb, *equirectPipeline, equirectSet, IBLEquirectParams {info.environmentSize}, info.environmentSize, 6u);
+        dispatchIBL(cb, *brdfPipeline, brdfSet, IBLBrdfParams {info.brdfLutSize, info.sampleCount}, info.brdfLutSize, 1u);
+
+        // Environment mip chain, used to filter samples in the convolution passes
+        auto envMips = MipGenerator::get()->record(cb,
+                                                   {{
+                                                       .image       = env->getImage(),
+                                                       .format      = env->getFormat(),
+                                                       .extent      = env->getExtent(),
+                                                       .mipLevels   = env->getMipLevels(),
+                                                       .arrayLayers = env->getArrayLayers(),
+                                                       .oldLayout   = VK_IMAGE_LAYOUT_GENERAL,
+                                                       .newLayout   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                                   }});
+
+        // Diffuse irradiance, sampled from a mip around 64x64 to keep the convolution cheap
+        const float sourceLod = std::max(0.0f, std::log2(static_cast<float>(info.environmentSize) / 64.0f));
+        dispatchIBL(cb,
+                    *irradiancePipeline,
+                    irradianceSet,
+                    IBLIrradianceParams {info.irradianceSize, 0.025f, sourceLod},
+                    info.irradianceSize,
+                    6u);
+
+        // Prefiltered specular, one roughness level per mip
+        for (uint32_t mip = 0; mip < info.prefilterMips; ++mip)
+        {
+            const uint32_t faceSize = std::max(info.prefilterSize >> mip, 1u);
+            const float roughness
+                = info.prefilterMips > 1 ? static_cast<float>(mip) / static_cast<float>(info.prefilterMips - 1) : 0.0f;
+            dispatchIBL(cb,
+                        *prefilterPipeline,
+                        prefilterSets[mip],
+                        IBLPrefilterParams {
+                            faceSize, info.sampleCount, roughness, static_cast<float>(info.environmentSize)},
+                        faceSize,
+                        6u);
+        }
+
+        {
+            const std::array<VkImageMemoryBarrier, 3> barriers = {
+                makeIBLBarrier(*irradiance,
+                               VK_IMAGE_LAYOUT_GENERAL,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT),
+                makeIBLBarrier(*prefiltered,
+                               VK_IMAGE_LAYOUT_GENERAL,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT),
+                makeIBLBarrier(*brdfLut,
+                               VK_IMAGE_LAYOUT_GENERAL,
+                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                               VK_ACCESS_SHADER_WRITE_BIT,
+                               VK_ACCESS_SHADER_READ_BIT),
+            };
+            vkCmdPipelineBarrier(cb,
+                                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr,
+                                 static_cast<uint32_t>(barriers.size()),
+                                 barriers.data());
+        }
+        utils::endOneTimeCommands(cb);
+        transient.commandBuffer = VK_NULL_HANDLE;
+
+        // The transient views and descriptor pool are released with `transient`
+    }
+
+    bool IBLEnvironment::loadCache(VkDevice device, const fs::path& p, uint64_t key)
+    {
+        if (!fs::exists(p))
+            return false;
+
+        std::ifstream f(p.string(), std::ios::binary);
+        IBLCacheHeader header {};
+        if (!f.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        if (header.magic != IBLCacheMagic || header.version != IBLCacheVersion || header.key != key)
+            return false;
+
+        std::array<Image::Ptr, 4> images = {getEnvironment(), getIrradiance(), getPrefiltered(), getBrdfLut()};
+        VkDeviceSize totalSize = 0;
+        std::array<std::vector<VkBufferImageCopy>, 4> regions;
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            regions[i] = makeIBLCopyRegions(*images[i], totalSize);
+        }
+        if (header.dataSize != totalSize)
+            return false;
+
+        std::vector<char> data(totalSize);
+        if (!f.read(data.data(), static_cast<std::streamsize>(totalSize)))
+        {
+            std::cout << utils::makeWarningMessage("FILE", "Ignoring truncated IBL cache file: `" + p.string() + "`")
+                      << std::endl;
+            return false;
+        }
+
+        auto stagingBuffer = Buffer::create(device,
+                                            {
+                                                .size       = totalSize,
+                                                .usage      = E_BufferUsage::TransferSrc,
+                                                .memoryMode = E_MemoryMode::CpuToGpu,
+                                            });
+        stagingBuffer->fillBuffer(data.data(), totalSize);
+
+        VkCommandBuffer cb = utils::beginOneTimeCommands();
+        std::array<VkImageMemoryBarrier, 4> barriers;
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            barriers[i] = makeIBLBarrier(*images[i],
+                                         VK_IMAGE_LAYOUT_UNDEFINED,
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         0,
+                                         VK_ACCESS_TRANSFER_WRITE_BIT);
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            vkCmdCopyBufferToImage(cb,
+                                   stagingBuffer->getBuffer(),
+                                   images[i]->getImage(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   static_cast<uint32_t>(regions[i].size()),
+                                   regions[i].data());
+            barriers[i] = makeIBLBarrier(*images[i],
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                         VK_ACCESS_TRANSFER_WRITE_BIT,
+                                         VK_ACCESS_SHADER_READ_BIT);
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+        utils::endOneTimeCommands(cb);
+        return true;
+    }
+
+    void IBLEnvironment::saveCache(VkDevice device, const fs::path& p, uint64_t key)
+    {
+        std::array<Image::Ptr, 4> images = {getEnvironment(), getIrradiance(), getPrefiltered(), getBrdfLut()};
+        VkDeviceSize totalSize = 0;
+        std::array<std::vector<VkBufferImageCopy>, 4> regions;
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            regions[i] = makeIBLCopyRegions(*images[i], totalSize);
+        }
+
+        auto readbackBuffer = Buffer::create(device,
+                                             {
+                                                 .size       = totalSize,
+                                                 .usage      = E_BufferUsage::TransferDst,
+                                                 .memoryMode = E_MemoryMode::GpuToCpu,
+                                             });
+
+        VkCommandBuffer cb = utils::beginOneTimeCommands();
+        std::array<VkImageMemoryBarrier, 4> barriers;
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            barriers[i] = makeIBLBarrier(*images[i],
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         VK_ACCESS_SHADER_READ_BIT,
+                                         VK_ACCESS_TRANSFER_READ_BIT);
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            vkCmdCopyImageToBuffer(cb,
+                                   images[i]->getImage(),
+                                   VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                   readbackBuffer->getBuffer(),
+                                   static_cast<uint32_t>(regions[i].size()),
+                                   regions[i].data());
+            barriers[i] = makeIBLBarrier(*images[i],
+                                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                         VK_ACCESS_TRANSFER_READ_BIT,
+                                         VK_ACCESS_SHADER_READ_BIT);
+        }
+        vkCmdPipelineBarrier(cb,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                             0,
+                             0,
+                             nullptr,
+                             0,
+                             nullptr,
+                             static_cast<uint32_t>(barriers.size()),
+                             barriers.data());
+        utils::endOneTimeCommands(cb);
+
+        std::vector<char> data(totalSize);
+        readbackBuffer->readBuffer(data.data(), totalSize);
+
+        boost::system::error_code ec;
+        fs::create_directories(p.parent_path(), ec);
+
+        const IBLCacheHeader header {
+            .magic    = IBLCacheMagic,
+            .version  = IBLCacheVersion,
+            .key      = key,
+            .dataSize = totalSize,
+        };
+        std::ofstream f(p.string(), std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        f.write(data.data(), static_cast<std::streamsize>(totalSize));
+        if (!f)
+        {
+            f.close();
+            fs::remove(p, ec);
+            std::cout << utils::makeWarningMessage("FILE", "Failed to write IBL cache file: `" + p.string() + "`")
+                      << std::endl;
+        }
+    }
+} // namespace ivulk
@@ -0,0 +1,301 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/model/simplify.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace ivulk {
+
+    namespace {
+        /**
+         * @brief A symmetric 4x4 matrix summing squared distances to planes, and the planes' total weight
+         */
+        struct Quadric
+        {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+            double a11 = 0.0, a12 = 0.0, a13 = 0.0;
+            double a22 = 0.0, a23 = 0.0;
+            double a33    = 0.0;
+            double weight = 0.0;
+
+            static Quadric fromPlane(glm::vec3 normal, float distance, float weight)
+            {
+                const double a = normal.x, b = normal.y, c = normal.z, d = distance;
+                return {
+                    a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+                    b * b * weight, b * c * weight, b * d * weight,
+                    c * c * weight, c * d * weight,
+                    d * d * weight,
+                    weight,
+                };
+            }
+
+            Quadric& operator+=(const Quadric& q)
+            {
+                a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+                a11 += q.a11, a12 += q.a12, a13 += q.a13;
+                a22 += q.a22, a23 += q.a23;
+                a33 += q.a33;
+                weight += q.weight;
+                return *this;
+            }
+
+            /**
+             * @brief Get the mean squared distance of a point to the planes
+             */
+            double error(glm::vec3 p) const
+            {
+                if (weight <= 0.0)
+                    return 0.0;
+                const double x = p.x, y = p.y, z = p.z;
+                const double e = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z + 2.0 * a03 * x
+                                 + a11 * y * y + 2.0 * a12 * y * z + 2.0 * a13 * y
+                                 + a22 * z * z + 2.0 * a23 * z
+                                 + a33;
+                return std::max(e, 0.0) / weight;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            double cost;
+        };
+
+        uint64_t edgeKey(uint32_t a, uint32_t b)
+        {
+            return (uint64_t(std::min(a, b)) << 32) | std::max(a, b);
+        }
+
+        /**
+         * @brief Find the vertices that must stay in place: open borders, non-manifold edges and attribute
+         *        seams
+         */
+        std::vector<uint8_t> findLockedVertices(const std::vector<glm::vec3>& positions,
+                                                const std::vector<uint32_t>& indices)
+        {
+            // Vertices sharing a position are welded for the border search
+            std::unordered_map<uint64_t, uint32_t> firstAtPosition;
+            std::vector<uint32_t> weld(positions.size());
+            std::vector<uint8_t> locked(positions.size(), 0u);
+            for (uint32_t i = 0; i < positions.size(); ++i)
+            {
+                uint32_t bits[3];
+                std::memcpy(bits, &positions[i], sizeof(bits));
+                uint64_t key = bits[0];
+                key          = key * 0x9E3779B97F4A7C15ull ^ bits[1];
+                key          = key * 0x9E3779B97F4A7C15ull ^ bits[2];
+
+                auto [it, bInserted] = firstAtPosition.try_emplace(key, i);
+                weld[i]              = it->second;
+                if (!bInserted && positions[it->second] == positions[i])
+                {
+                    locked[i]          = 1u;
+                    locked[it->second] = 1u;
+                }
+                else if (!bInserted)
+                {
+                    weld[i] = i; // Hash collision, keep the vertex apart
+                }
+            }
+
+            // Edges used by a single triangle are on a border, and edges used by more than two are
+            // non-manifold, where collapsing could fold the surfaces meeting there into each other
+            std::unordered_map<uint64_t, uint32_t> edgeUses;
+            for (std::size_t t = 0; t + 2u < indices.size(); t += 3u)
+            {
+                for (uint32_t e = 0; e < 3u; ++e)
+                {
+                    const uint32_t a = weld[indices[t + e]];
+                    const uint32_t b = weld[indices[t + (e + 1u) % 3u]];
+                    ++edgeUses[edgeKey(a, b)];
+                }
+            }
+            for (std::size_t t = 0; t + 2u < indices.size(); t += 3u)
+            {
+                for (uint32_t e = 0; e < 3u; ++e)
+                {
+                    const uint32_t a = indices[t + e];
+                    const uint32_t b = indices[t + (e + 1u) % 3u];
+                    if (edgeUses[edgeKey(weld[a], weld[b])] != 2u)
+                        locked[a] = locked[b] = 1u;
+                }
+            }
+            return locked;
+        }
+
+        /**
+         * @brief Check whether moving `from` onto `to` keeps every other triangle around `from` facing the
+         *        same way
+         */
+        bool keepsOrientation(const std::vector<glm::vec3>& positions,
+                              const std::vector<uint32_t>& indices,
+                              const uint32_t* trianglesBegin,
+                              const uint32_t* trianglesEnd,
+                              uint32_t from,
+                              uint32_t to)
+        {
+            for (const uint32_t* it = trianglesBegin; it != trianglesEnd; ++it)
+            {
+                const uint32_t t    = *it;
+                const uint32_t* tri = &indices[3u * t];
+
+                if (tri[0] == to || tri[1] == to || tri[2] == to)
+                    continue; // Removed by the collapse
+
+                const uint32_t k       = tri[0] == from ? 0u : (tri[1] == from ? 1u : 2u);
+                const glm::vec3 b      = positions[tri[(k + 1u) % 3u]];
+                const glm::vec3 c      = positions[tri[(k + 2u) % 3u]];
+                const glm::vec3 before = glm::cross(b - positions[from], c - positions[from]);
+                const glm::vec3 after  = glm::cross(b - positions[to], c - positions[to]);
+                if (glm::dot(before, after) <= 0.0f)
+                    return false;
+            }
+            return true;
+        }
+    } // namespace
+
+    SimplifiedMesh simplifyMesh(const std::vector<glm::vec3>& positions,
+                                const std::vector<uint32_t>& indices,
+                                std::size_t targetIndexCount)
+    {
+        SimplifiedMesh result {.indices = indices};
+        auto& current = result.indices;
+        current.resize(current.size() - current.size() % 3u);
+
+        const auto locked = findLockedVertices(positions, current);
+
+        // Every vertex starts with the planes of the triangles around it, weighted by their area
+        std::vector<Quadric> quadrics(positions.size());
+        for (std::size_t t = 0; t < current.size(); t += 3u)
+        {
+            const glm::vec3 p0 = positions[current[t]];
+            const glm::vec3 p1 = positions[current[t + 1u]];
+            const glm::vec3 p2 = positions[current[t + 2u]];
+            const glm::vec3 n  = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(n);
+            if (length <= 0.0f)
+                continue;
+            const glm::vec3 unit = n / length;
+            const auto q         = Quadric::fromPlane(unit, -glm::dot(unit, p0), 0.5f * length);
+            for (uint32_t k = 0; k < 3u; ++k)
+                quadrics[current[t + k]] += q;
+        }
+
+        std::vector<uint32_t> triangleStart(positions.size() + 1u);
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<Collapse> collapses;
+        std::vector<uint8_t> touched(positions.size());
+        std::vector<uint32_t> remap(positions.size());
+        double maxError = 0.0;
+
+        // Each pass collapses the cheapest edges whose triangles no other collapse in the pass changed,
+        // then rewrites the triangles; passes repeat until the target is met or nothing can collapse
+        while (current.size() > targetIndexCount)
+        {
+            const uint32_t triangleCount = static_cast<uint32_t>(current.size() / 3u);
+
+            // Triangles around each vertex
+            std::fill(triangleStart.begin(), triangleStart.end(), 0u);
+            for (const auto v : current)
+                ++triangleStart[v + 1u];
+            for (std::size_t v = 1; v < triangleStart.size(); ++v)
+                triangleStart[v] += triangleStart[v - 1u];
+            vertexTriangles.resize(current.size());
+            {
+                auto fill = triangleStart;
+                for (uint32_t t = 0; t < triangleCount; ++t)
+                {
+                    for (uint32_t k = 0; k < 3u; ++k)
+                        vertexTriangles[fill[current[3u * t + k]]++] = t;
+                }
+            }
+
+            // Every edge can collapse either way, as long as the vertex that goes away isn't locked
+            collapses.clear();
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                for (uint32_t k = 0; k < 3u; ++k)
+                {
+                    const uint32_t a = current[3u * t + k];
+                    const uint32_t b = current[3u * t + (k + 1u) % 3u];
+                    for (const auto& [from, to] : {std::pair {a, b}, std::pair {b, a}})
+                    {
+                        if (locked[from])
+                            continue;
+                        Quadric q = quadrics[from];
+                        q += quadrics[to];
+                        collapses.push_back({from, to, q.error(positions[to])});
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                return a.cost < b.cost;
+            });
+
+            // Each collapse removes about two triangles
+            const std::size_t wanted = (current.size() - targetIndexCount + 5u) / 6u;
+            std::size_t applied      = 0u;
+            std::fill(touched.begin(), touched.end(), 0u);
+            for (uint32_t v = 0; v < remap.size(); ++v)
+                remap[v] = v;
+            for (const auto& c : collapses)
+            {
+                if (applied >= wanted)
+                    break;
+                if (touched[c.from] || touched[c.to])
+                    continue;
+
+                const uint32_t* around = vertexTriangles.data();
+                if (!keepsOrientation(positions,
+                                      current,
+                                      around + triangleStart[c.from],
+                                      around + triangleStart[c.from + 1u],
+                                      c.from,
+                                      c.to))
+                    continue;
+
+                quadrics[c.to] += quadrics[c.from];
+
+                // Orientation is checked against the triangles as they were before the pass, so no
+                // later collapse may move a vertex of a triangle this one changed
+                for (const uint32_t* it = around + triangleStart[c.from];
+                     it != around + triangleStart[c.from + 1u];
+                     ++it)
+                {
+                    for (uint32_t k = 0; k < 3u; ++k)
+                        touched[current[3u * *it + k]] = 1u;
+                }
+
+                remap[c.from] = c.to;
+                maxError      = std::max(maxError, c.cost);
+                ++applied;
+            }
+            if (applied == 0u)
+                break;
+
+            // Drop the triangles that collapsed to a line
+            std::size_t kept = 0u;
+            for (std::size_t t = 0; t < current.size(); t += 3u)
+            {
+                const uint32_t a = remap[current[t]];
+                const uint32_t b = remap[current[t + 1u]];
+                const uint32_t c = remap[current[t + 2u]];
+                if (a == b || b == c || c == a)
+                    continue;
+                current[kept++] = a;
+                current[kept++] = b;
+                current[kept++] = c;
+            }
+            current.resize(kept);
+        }
+
+        result.error = static_cast<float>(std::sqrt(maxError));
+        return result;
+    }
+} // namespace ivulk
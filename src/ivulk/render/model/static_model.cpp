@@ -3,75 +3,72 @@
 
 #include <ivulk/render/model/static_model.hpp>
 
-#include <ivulk/core/app.hpp>
 #include <ivulk/utils/messages.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
+
 namespace ivulk {
     namespace fs = utils::fs;
 
+    namespace {
+        constexpr uint32_t MaxLodCount      = 4u;  ///< Levels of detail per mesh, the full mesh included
+        constexpr std::size_t MinLodIndices = 96u; ///< Smallest level of detail worth simplifying further
+        constexpr std::size_t MaxLodPercent = 80u; ///< Share of the previous level's indices a level may keep
+    } // namespace
+
     ///////////////////////////////////////////////////////////////////////
     //                               Mesh                                //
     ///////////////////////////////////////////////////////////////////////
 
-    StaticMesh::StaticMesh(Buffer::Ptr vBuf, Buffer::Ptr iBuf, uint32_t pipelineIndex)
-        : m_vertexBuffer(vBuf)
-        , m_indexBuffer(iBuf)
+    StaticMesh::StaticMesh(GeometryPool::Ptr pool,
+                           std::vector<Lod> lods,
+                           BoundingBox box,
+                           BoundingSphere sphere,
+                           uint32_t pipelineIndex)
+        : m_pool(pool)
+        , m_lods(std::move(lods))
+        , m_box(box)
+        , m_sphere(sphere)
         , m_pipelineIndex(pipelineIndex)
     { }
 
-    StaticMesh::Ptr StaticMesh::create(const std::vector<vertex_t>& vertices, const std::vector<uint32_t>& indices, uint32_t pipelineIndex)
+    StaticMesh::~StaticMesh()
     {
-        auto state = App::current()->getState().vk;
-        Buffer::Ptr vBuf, iBuf;
-
-        // ################# Vertex Buffer ################## //
-
-        {
-            VkDeviceSize sz = sizeof(vertices[0]) * vertices.size();
-            auto stageBuf   = Buffer::create(state.device,
-                                           {
-                                               .size       = sz,
-                                               .usage      = E_BufferUsage::TransferSrc,
-                                               .memoryMode = E_MemoryMode::CpuToGpu,
-                                           });
-            stageBuf->fillBuffer(vertices.data(), sz, vertices.size());
-
-            vBuf = Buffer::create(state.device,
-                                  {
-                                      .size       = sz,
-                                      .usage      = E_BufferUsage::TransferDst | E_BufferUsage::Vertex,
-                                      .memoryMode = E_MemoryMode::GpuOnly,
-                                  });
-            vBuf->copyFromBuffer(stageBuf, sz);
-        }
-
-        // ################## Index Buffer ################## //
+        // Levels of detail draw the full mesh's vertices, so they go first
+        for (std::size_t lod = m_lods.size(); lod-- > 1u;)
+            m_pool->removeIndices(m_lods[lod].range);
+        if (!m_lods.empty())
+            m_pool->remove(m_lods.front().range);
+    }
 
+    StaticMesh::Ptr StaticMesh::create(const std::vector<vertex_t>& vertices,
+                                       const std::vector<uint32_t>& indices,
+                                       uint32_t pipelineIndex,
+                                       BoundingBox box,
+                                       BoundingSphere sphere,
+                                       const std::vector<SimplifiedMesh>& lods)
+    {
+        // Every static mesh shares the same vertex and index buffers, and every level of detail of a mesh
+        // shares its vertices
+        auto pool = GeometryPool::get(sizeof(vertex_t));
+
+        std::vector<Lod> ranges;
+        ranges.reserve(lods.size() + 1u);
+        ranges.push_back({
+            .range = pool->add(vertices.data(), static_cast<uint32_t>(vertices.size()), indices),
+            .error = 0.0f,
+        });
+        for (const auto& lod : lods)
         {
-            VkDeviceSize sz = sizeof(indices[0]) * indices.size();
-            auto stageBuf   = Buffer::create(state.device,
-                                           {
-                                               .size       = sz,
-                                               .usage      = E_BufferUsage::TransferSrc,
-                                               .memoryMode = E_MemoryMode::CpuToGpu,
-                                           });
-            stageBuf->fillBuffer(indices.data(), sz, indices.size());
-
-            iBuf = Buffer::create(state.device,
-                                  {
-                                      .size       = sz,
-                                      .usage      = E_BufferUsage::TransferDst | E_BufferUsage::Index,
-                                      .memoryMode = E_MemoryMode::GpuOnly,
-                                  });
-            iBuf->copyFromBuffer(stageBuf, sz);
+            ranges.push_back({
+                .range = pool->addIndices(ranges.front().range.vertexOffset, lod.indices),
+                .error = lod.error,
+            });
         }
-
-        // ############### Create/Return Ptr ################ //
-
-        return Ptr(new StaticMesh(vBuf, iBuf, pipelineIndex));
+        return Ptr(new StaticMesh(pool, std::move(ranges), box, sphere, pipelineIndex));
     }
 
     uint32_t StaticMesh::getPipelineIndex() const
@@ -87,7 +84,9 @@ namespace ivulk {
     {
         Assimp::Importer importer;
         const aiScene* scene = importer.ReadFile(
-            p.string(), aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_CalcTangentSpace);
+            p.string(),
+            aiProcess_Triangulate | aiProcess_GenNormals | aiProcess_CalcTangentSpace
+                | aiProcess_JoinIdenticalVertices);
 
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
         {
@@ -117,6 +116,8 @@ namespace ivulk {
     {
         std::vector<vertex_t> vertices;
         std::vector<uint32_t> indices;
+        std::vector<glm::vec3> positions;
+        BoundingBox box;
 
         for (unsigned int i = 0; i < mesh->mNumVertices; i++)
         {
@@ -124,6 +125,8 @@ namespace ivulk {
             vertex.position.x = mesh->mVertices[i].x;
             vertex.position.y = mesh->mVertices[i].y;
             vertex.position.z = mesh->mVertices[i].z;
+            box.expand(vertex.position);
+            positions.push_back(vertex.position);
 
             vertex.normal.x = mesh->mNormals[i].x;
             vertex.normal.y = mesh->mNormals[i].y;
@@ -152,8 +155,29 @@ namespace ivulk {
                 indices.push_back(face.mIndices[j]);
         }
 
+        // Centered on the bounding box, which is close enough to the smallest sphere for culling
+        BoundingSphere sphere = {};
+        if (box.isValid())
+        {
+            sphere = {.center = box.getCenter(), .radius = 0.0f};
+            for (const auto& v : vertices)
+                sphere.radius = std::max(sphere.radius, glm::distance(sphere.center, v.position));
+        }
+
+        // Each level of detail aims for half the triangles of the one before, until simplification stalls
+        std::vector<SimplifiedMesh> lods;
+        std::size_t previous = indices.size();
+        while (lods.size() + 1u < MaxLodCount && previous / 2u >= MinLodIndices)
+        {
+            auto lod = simplifyMesh(positions, indices, previous / 6u * 3u);
+            if (lod.indices.size() * 100u > previous * MaxLodPercent)
+                break;
+            previous = lod.indices.size();
+            lods.push_back(std::move(lod));
+        }
+
         uint32_t pipelineIndex = mesh->mMaterialIndex;
 
-        return StaticMesh::create(vertices, indices, pipelineIndex);
+        return StaticMesh::create(vertices, indices, pipelineIndex, box, sphere, lods);
     }
 } // namespace ivulk
@@ -0,0 +1,370 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/occlusion_culler.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define IVULK_RASTER_SSE
+#endif
+
+namespace ivulk {
+
+    namespace {
+        constexpr float MinW = 1e-5f; ///< Vertices with a smaller clip w are behind the viewer
+
+        /**
+         * @brief A value linear in screen space, `a * x + b * y + c`
+         */
+        struct ScreenPlane
+        {
+            float a, b, c;
+
+            float at(float x, float y) const { return a * x + b * y + c; }
+        };
+
+        /**
+         * @brief The edge function of `v0` to `v1`, positive on the left of the edge
+         */
+        ScreenPlane edge(glm::vec3 v0, glm::vec3 v1)
+        {
+            const float a = v0.y - v1.y;
+            const float b = v1.x - v0.x;
+            return {a, b, -(a * v0.x + b * v0.y)};
+        }
+
+        constexpr uint32_t NoVertex = std::numeric_limits<uint32_t>::max();
+
+        /**
+         * @brief For every triangle edge, find the vertex of the one other triangle sharing it, that isn't
+         *        on the edge. Edges on a border or shared by more triangles get `NoVertex`.
+         */
+        std::vector<uint32_t> findAcross(const OccluderMesh& mesh)
+        {
+            const std::size_t triangleCount = mesh.indices.size() / 3u;
+            std::unordered_map<uint64_t, std::vector<uint32_t>> edgeTriangles;
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                for (uint32_t k = 0; k < 3u; ++k)
+                {
+                    const uint32_t a = mesh.indices[3u * t + k];
+                    const uint32_t b = mesh.indices[3u * t + (k + 1u) % 3u];
+                    edgeTriangles[(uint64_t(std::min(a, b)) << 32) | std::max(a, b)].push_back(3u * t + k);
+                }
+            }
+
+            std::vector<uint32_t> across(3u * triangleCount, NoVertex);
+            for (const auto& [key, edges] : edgeTriangles)
+            {
+                if (edges.size() != 2u)
+                    continue;
+                // The vertex after an edge's two is the one off it
+                const auto far = [&](uint32_t e) { return mesh.indices[e - e % 3u + (e % 3u + 2u) % 3u]; };
+                across[edges[0]] = far(edges[1]);
+                across[edges[1]] = far(edges[0]);
+            }
+            return across;
+        }
+    } // namespace
+
+    OccluderMesh::Ptr OccluderMesh::fromBox(const BoundingBox& box)
+    {
+        auto mesh = std::make_shared<OccluderMesh>();
+        for (uint32_t i = 0; i < 8u; ++i)
+        {
+            mesh->positions.emplace_back((i & 1u) ? box.max.x : box.min.x,
+                                         (i & 2u) ? box.max.y : box.min.y,
+                                         (i & 4u) ? box.max.z : box.min.z);
+        }
+        // Two triangles per side, corners indexed by their axis bits
+        mesh->indices = {
+            0, 2, 6, 0, 6, 4, // -X
+            1, 5, 7, 1, 7, 3, // +X
+            0, 4, 5, 0, 5, 1, // -Y
+            2, 3, 7, 2, 7, 6, // +Y
+            0, 1, 3, 0, 3, 2, // -Z
+            4, 6, 7, 4, 7, 5, // +Z
+        };
+        return mesh;
+    }
+
+    OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+        : m_width((std::max(width, 1u) + 3u) & ~3u)
+        , m_height(std::max(height, 1u))
+    {
+        Level level      = {.width = m_width, .height = m_height};
+        std::size_t size = 0u;
+        while (true)
+        {
+            level.offset = size;
+            size += static_cast<std::size_t>(level.width) * level.height;
+            m_levels.push_back(level);
+            if (level.width == 1u && level.height == 1u)
+                break;
+            level.width  = (level.width + 1u) / 2u;
+            level.height = (level.height + 1u) / 2u;
+        }
+        m_depth.assign(size, 1.0f);
+    }
+
+    uint32_t OcclusionCuller::addOccluder(OccluderMesh::Ptr mesh, const glm::mat4& modelMatrix)
+    {
+        if (!m_freeOccluders.empty())
+        {
+            const uint32_t occluder = m_freeOccluders.back();
+            m_freeOccluders.pop_back();
+            m_occluders[occluder] = {.mesh = mesh, .modelMatrix = modelMatrix, .across = findAcross(*mesh)};
+            return occluder;
+        }
+        m_occluders.push_back({.mesh = mesh, .modelMatrix = modelMatrix, .across = findAcross(*mesh)});
+        return static_cast<uint32_t>(m_occluders.size() - 1u);
+    }
+
+    void OcclusionCuller::setOccluderTransform(uint32_t occluder, const glm::mat4& modelMatrix)
+    {
+        m_occluders[occluder].modelMatrix = modelMatrix;
+    }
+
+    void OcclusionCuller::removeOccluder(uint32_t occluder)
+    {
+        m_occluders[occluder] = {};
+        m_freeOccluders.push_back(occluder);
+    }
+
+    void OcclusionCuller::render(const glm::mat4& viewProjection)
+    {
+        m_viewProjection = viewProjection;
+        std::fill(m_depth.begin(), m_depth.begin() + m_width * m_height, 1.0f);
+
+        const glm::vec2 size = glm::vec2(m_width, m_height);
+        for (const auto& occluder : m_occluders)
+        {
+            if (!occluder.mesh)
+                continue;
+
+            // Project every vertex once; triangles are shared between vertices
+            const glm::mat4 mvp = viewProjection * occluder.modelMatrix;
+            const auto& mesh    = *occluder.mesh;
+            m_screen.resize(mesh.positions.size());
+            m_clipped.resize(mesh.positions.size());
+            for (std::size_t i = 0; i < mesh.positions.size(); ++i)
+            {
+                const glm::vec4 clip = mvp * glm::vec4(mesh.positions[i], 1.0f);
+                m_clipped[i]         = (clip.w < MinW || clip.z < 0.0f) ? 1u : 0u;
+                if (m_clipped[i])
+                    continue;
+                const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+                m_screen[i]         = glm::vec3((glm::vec2(ndc) * 0.5f + 0.5f) * size, ndc.z);
+            }
+
+            // Triangles crossing the near plane are skipped rather than clipped; they only hide less
+            for (std::size_t i = 0; i + 2u < mesh.indices.size(); i += 3u)
+            {
+                const uint32_t i0 = mesh.indices[i];
+                const uint32_t i1 = mesh.indices[i + 1u];
+                const uint32_t i2 = mesh.indices[i + 2u];
+                if (m_clipped[i0] || m_clipped[i1] || m_clipped[i2])
+                    continue;
+
+                // Pixels on an edge between two triangles lying on either side of it on screen are
+                // covered by the pair, so only the other edges need pixels covered fully
+                uint32_t outerEdges = 0u;
+                for (uint32_t k = 0; k < 3u; ++k)
+                {
+                    const uint32_t d = occluder.across[i + k];
+                    if (d != NoVertex && !m_clipped[d])
+                    {
+                        const glm::vec3 c    = m_screen[mesh.indices[i + (k + 2u) % 3u]];
+                        const ScreenPlane ab = edge(m_screen[mesh.indices[i + k]],
+                                                    m_screen[mesh.indices[i + (k + 1u) % 3u]]);
+                        if (ab.at(c.x, c.y) * ab.at(m_screen[d].x, m_screen[d].y) < 0.0f)
+                            continue;
+                    }
+                    outerEdges |= 1u << k;
+                }
+                rasterizeTriangle(m_screen[i0], m_screen[i1], m_screen[i2], outerEdges);
+            }
+        }
+
+        buildHierarchy();
+    }
+
+    void OcclusionCuller::rasterizeTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2, uint32_t outerEdges)
+    {
+        float area = edge(v0, v1).at(v2.x, v2.y);
+        if (std::abs(area) < std::numeric_limits<float>::epsilon())
+            return;
+        if (area < 0.0f)
+        {
+            // Occluders hide from both sides, so flip back faces rather than skip them. The edges from
+            // v0 to v1 and from v2 to v0 trade places.
+            std::swap(v1, v2);
+            area       = -area;
+            outerEdges = (outerEdges & 2u) | ((outerEdges & 1u) << 2) | ((outerEdges >> 2) & 1u);
+        }
+
+        const float lastX = static_cast<float>(m_width - 1u);
+        const float lastY = static_cast<float>(m_height - 1u);
+        const float minX  = std::max(std::floor(std::min({v0.x, v1.x, v2.x})), 0.0f);
+        const float minY  = std::max(std::floor(std::min({v0.y, v1.y, v2.y})), 0.0f);
+        const float maxX  = std::min(std::ceil(std::max({v0.x, v1.x, v2.x})), lastX);
+        const float maxY  = std::min(std::ceil(std::max({v0.y, v1.y, v2.y})), lastY);
+        if (minX > maxX || minY > maxY)
+            return;
+
+        // Depth is interpolated linearly in screen space, and pushed back to the farthest depth over the
+        // pixel, so occluders never hide more than they cover
+        ScreenPlane e0 = edge(v1, v2);
+        ScreenPlane e1 = edge(v2, v0);
+        ScreenPlane e2 = edge(v0, v1);
+        ScreenPlane z  = {
+            (e0.a * v0.z + e1.a * v1.z + e2.a * v2.z) / area,
+            (e0.b * v0.z + e1.b * v1.z + e2.b * v2.z) / area,
+            (e0.c * v0.z + e1.c * v1.z + e2.c * v2.z) / area,
+        };
+        z.c += 0.5f * (std::abs(z.a) + std::abs(z.b));
+
+        // Only pixels the triangle covers fully are written, so each outer edge is then pulled in to where
+        // its value at the pixel center is that of the pixel corner least inside it. Bit `k` of
+        // `outerEdges` is the edge from vertex `k`, which `e2`, `e0` and `e1` are in turn.
+        const uint32_t edgeBits[3] = {2u, 4u, 1u};
+        ScreenPlane* edges[3]      = {&e0, &e1, &e2};
+        for (uint32_t k = 0; k < 3u; ++k)
+        {
+            if (outerEdges & edgeBits[k])
+                edges[k]->c -= 0.5f * (std::abs(edges[k]->a) + std::abs(edges[k]->b));
+        }
+
+        // Rows are walked 4 pixels at a time from a multiple of 4; the width is padded to one
+        const uint32_t x0 = static_cast<uint32_t>(minX) & ~3u;
+        const uint32_t x1 = static_cast<uint32_t>(maxX);
+        const uint32_t y0 = static_cast<uint32_t>(minY);
+        const uint32_t y1 = static_cast<uint32_t>(maxY);
+
+#if defined(IVULK_RASTER_SSE)
+        const __m128 zero    = _mm_setzero_ps();
+        const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        for (uint32_t y = y0; y <= y1; ++y)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+
+            // Terms constant along the row
+            const __m128 r0 = _mm_set1_ps(e0.b * py + e0.c);
+            const __m128 r1 = _mm_set1_ps(e1.b * py + e1.c);
+            const __m128 r2 = _mm_set1_ps(e2.b * py + e2.c);
+            const __m128 rz = _mm_set1_ps(z.b * py + z.c);
+
+            float* row = m_depth.data() + static_cast<std::size_t>(y) * m_width;
+            for (uint32_t x = x0; x <= x1; x += 4u)
+            {
+                const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                const __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.a), px), r0);
+                const __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.a), px), r1);
+                const __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.a), px), r2);
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                                                 _mm_cmpge_ps(w2, zero));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                const __m128 depth   = _mm_loadu_ps(row + x);
+                const __m128 nearest = _mm_min_ps(depth, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(z.a), px), rz));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+            }
+        }
+#else
+        for (uint32_t y = y0; y <= y1; ++y)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* row     = m_depth.data() + static_cast<std::size_t>(y) * m_width;
+            for (uint32_t x = x0; x <= x1; ++x)
+            {
+                const float px = static_cast<float>(x) + 0.5f;
+                if (e0.at(px, py) >= 0.0f && e1.at(px, py) >= 0.0f && e2.at(px, py) >= 0.0f)
+                    row[x] = std::min(row[x], z.at(px, py));
+            }
+        }
+#endif
+    }
+
+    void OcclusionCuller::buildHierarchy()
+    {
+        for (std::size_t l = 1; l < m_levels.size(); ++l)
+        {
+            const Level& src = m_levels[l - 1u];
+            const Level& dst = m_levels[l];
+            const float* in  = m_depth.data() + src.offset;
+            float* out       = m_depth.data() + dst.offset;
+            for (uint32_t y = 0; y < dst.height; ++y)
+            {
+                // Odd sizes repeat the last row or column
+                const uint32_t sy0 = 2u * y;
+                const uint32_t sy1 = std::min(sy0 + 1u, src.height - 1u);
+                for (uint32_t x = 0; x < dst.width; ++x)
+                {
+                    const uint32_t sx0 = 2u * x;
+                    const uint32_t sx1 = std::min(sx0 + 1u, src.width - 1u);
+                    out[y * dst.width + x] = std::max({in[sy0 * src.width + sx0],
+                                                       in[sy0 * src.width + sx1],
+                                                       in[sy1 * src.width + sx0],
+                                                       in[sy1 * src.width + sx1]});
+                }
+            }
+        }
+    }
+
+    bool OcclusionCuller::isOccluded(const BoundingBox& box) const
+    {
+        if (!box.isValid())
+            return false;
+
+        const glm::vec2 size = glm::vec2(m_width, m_height);
+        glm::vec2 lo         = glm::vec2(std::numeric_limits<float>::max());
+        glm::vec2 hi         = glm::vec2(std::numeric_limits<float>::lowest());
+        float nearest        = std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < 8u; ++i)
+        {
+            const glm::vec3 corner = glm::vec3((i & 1u) ? box.max.x : box.min.x,
+                                               (i & 2u) ? box.max.y : box.min.y,
+                                               (i & 4u) ? box.max.z : box.min.z);
+            const glm::vec4 clip   = m_viewProjection * glm::vec4(corner, 1.0f);
+            if (clip.w < MinW || clip.z < 0.0f)
+                return false;
+
+            const glm::vec3 ndc    = glm::vec3(clip) / clip.w;
+            const glm::vec2 screen = (glm::vec2(ndc) * 0.5f + 0.5f) * size;
+            lo                     = glm::min(lo, screen);
+            hi                     = glm::max(hi, screen);
+            nearest                = std::min(nearest, ndc.z);
+        }
+        if (hi.x < 0.0f || hi.y < 0.0f || lo.x >= size.x || lo.y >= size.y)
+            return false;
+
+        // Pixels the box touches
+        const uint32_t x0 = static_cast<uint32_t>(std::max(lo.x, 0.0f));
+        const uint32_t y0 = static_cast<uint32_t>(std::max(lo.y, 0.0f));
+        const uint32_t x1 = static_cast<uint32_t>(std::min(hi.x, size.x - 1.0f));
+        const uint32_t y1 = static_cast<uint32_t>(std::min(hi.y, size.y - 1.0f));
+
+        // The finest level where the box spans at most 2x2 texels
+        std::size_t l = 0u;
+        while (l + 1u < m_levels.size() && ((x1 >> l) - (x0 >> l) > 1u || (y1 >> l) - (y0 >> l) > 1u))
+            ++l;
+
+        const Level& level = m_levels[l];
+        const float* depth = m_depth.data() + level.offset;
+        for (uint32_t y = y0 >> l; y <= (y1 >> l); ++y)
+        {
+            for (uint32_t x = x0 >> l; x <= (x1 >> l); ++x)
+            {
+                if (depth[y * level.width + x] >= nearest)
+                    return false;
+            }
+        }
+        return true;
+    }
+} // namespace ivulk
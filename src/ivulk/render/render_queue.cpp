@@ -0,0 +1,553 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/render/render_queue.hpp>
+
+#include <ivulk/core/app.hpp>
+#include <ivulk/render/renderable.hpp>
+#include <ivulk/utils/hash.hpp>
+#include <ivulk/utils/messages.hpp>
+#include <ivulk/utils/radix_sort.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+
+namespace ivulk {
+
+    constexpr uint64_t SortIdMask              = 0xfffu; ///< 12-bit ID fields
+    constexpr VkDeviceSize IndirectCommandSize = sizeof(VkDrawIndexedIndirectCommand);
+    constexpr std::size_t MinBatchesPerRun     = 64u; ///< Fewest batches worth recording on another thread
+
+    uint32_t quantizeSortDepth(float depth, uint32_t bits)
+    {
+        // The bits of a non-negative float increase with its value
+        depth = std::max(depth, 0.0f);
+        uint32_t depthBits;
+        std::memcpy(&depthBits, &depth, sizeof(float));
+        return depthBits >> (31u - bits);
+    }
+
+    bool bindlessMaterialEquals(const std::optional<BindlessMaterial>& a,
+                                const std::optional<BindlessMaterial>& b)
+    {
+        if (!a.has_value() || !b.has_value())
+            return a.has_value() == b.has_value();
+        return a->albedo == b->albedo && a->normal == b->normal && a->packed == b->packed
+               && a->sampler == b->sampler;
+    }
+
+    bool isSameBuffer(const Buffer::Ref& a, const Buffer::Ref& b)
+    {
+        return !a.owner_before(b) && !b.owner_before(a);
+    }
+
+    // Packets drawn with the same pipeline, buffers and material can share an indirect draw
+    bool canDrawIndirect(const DrawPacket& a, const DrawPacket& b)
+    {
+        return !b.renderable && a.pipeline == b.pipeline && a.materialSet == b.materialSet
+               && isSameBuffer(a.vertexBuffer, b.vertexBuffer) && isSameBuffer(a.indexBuffer, b.indexBuffer)
+               && bindlessMaterialEquals(a.material, b.material);
+    }
+
+    bool isSameGeometry(const GeometryRange& a, const GeometryRange& b)
+    {
+        return a.indexCount == b.indexCount && a.firstIndex == b.firstIndex
+               && a.vertexOffset == b.vertexOffset;
+    }
+
+    // Packets of the same mesh that can share a draw only differ in their model matrix
+    bool canDrawInstanced(const DrawPacket& a, const DrawPacket& b)
+    {
+        return canDrawIndirect(a, b) && isSameGeometry(a.geometry, b.geometry);
+    }
+
+    uint64_t RenderQueue::makeSortKey(int16_t priority,
+                                      uint32_t pipeline,
+                                      uint32_t material,
+                                      uint32_t mesh,
+                                      float depth)
+    {
+        // Flip the sign bit so negative priorities sort below positive ones
+        uint64_t key = static_cast<uint64_t>(static_cast<uint16_t>(priority) ^ 0x8000u) << 48u;
+        if (priority >= E_RenderPriority::Transparent && priority < E_RenderPriority::Normal)
+        {
+            constexpr uint32_t depthBits = 24u;
+            const uint64_t farFirst      = ((1u << depthBits) - 1u) - quantizeSortDepth(depth, depthBits);
+            key |= farFirst << 24u;
+            key |= (pipeline & SortIdMask) << 12u;
+            key |= (material & SortIdMask);
+        }
+        else
+        {
+            key |= (pipeline & SortIdMask) << 36u;
+            key |= (material & SortIdMask) << 24u;
+            key |= (mesh & SortIdMask) << 12u;
+            key |= quantizeSortDepth(depth, 12u);
+        }
+        return key;
+    }
+
+    void I_Renderable::enqueue(RenderQueue& queue, const DrawContext& context)
+    {
+        queue.addRenderable(shared_from_this(), context);
+    }
+
+    void RenderQueue::clear()
+    {
+        m_packets.clear();
+        m_order.clear();
+        m_pipelineIds.clear();
+        m_materialIds.clear();
+        m_meshIds.clear();
+        m_bPrepared = false;
+    }
+
+    uint32_t RenderQueue::getSortId(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t key)
+    {
+        return ids.try_emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+    }
+
+    float RenderQueue::getDepth(const glm::mat4& modelMatrix) const
+    {
+        return glm::distance(glm::vec3(modelMatrix[3]), m_viewPosition);
+    }
+
+    float RenderQueue::getScreenSize(const BoundingSphere& sphere) const
+    {
+        if (!m_bViewProjection || !sphere.isValid())
+            return std::numeric_limits<float>::max();
+
+        // The projected radius is the radius scaled by the projection's vertical scale, over the distance
+        // in front of the viewer; it spans half the viewport at 1
+        const glm::mat4& vp = m_viewProjection;
+        const float w       = (vp * glm::vec4(sphere.center, 1.0f)).w;
+        if (w <= sphere.radius)
+            return std::numeric_limits<float>::max();
+        return sphere.radius * glm::length(glm::vec3(vp[0][1], vp[1][1], vp[2][1])) / w;
+    }
+
+    void RenderQueue::addMesh(const DrawContext& context,
+                              uint32_t pipelineIndex,
+                              Buffer::Ref vertexBuffer,
+                              Buffer::Ref indexBuffer,
+                              GeometryRange geometry,
+                              BoundingSphere bounds)
+    {
+        DrawPacket packet {
+            .pipeline     = pipelineIndex < context.pipelines.size() ? context.pipelines[pipelineIndex].lock()
+                                                                     : GraphicsPipeline::Ptr {},
+            .materialSet  = context.materialSet,
+            .material     = context.material,
+            .modelMatrix  = context.modelMatrix,
+            .vertexBuffer = vertexBuffer,
+            .indexBuffer  = indexBuffer,
+            .geometry     = geometry,
+            .bounds       = bounds,
+        };
+
+        uint64_t materialKey = reinterpret_cast<uintptr_t>(context.materialSet.get());
+        if (context.material.has_value())
+        {
+            utils::hashCombine(materialKey, context.material->albedo);
+            utils::hashCombine(materialKey, context.material->normal);
+            utils::hashCombine(materialKey, context.material->packed);
+            utils::hashCombine(materialKey, context.material->sampler);
+        }
+
+        // Meshes sharing a `GeometryPool` are told apart by their range
+        uint64_t meshKey = reinterpret_cast<uintptr_t>(vertexBuffer.lock().get());
+        utils::hashCombine(meshKey, geometry.firstIndex);
+        utils::hashCombine(meshKey, geometry.vertexOffset);
+
+        const auto pipelineId = getSortId(m_pipelineIds, reinterpret_cast<uintptr_t>(packet.pipeline.get()));
+        const auto materialId = getSortId(m_materialIds, materialKey);
+        const auto meshId     = getSortId(m_meshIds, meshKey);
+        packet.sortKey =
+            makeSortKey(context.priority, pipelineId, materialId, meshId, getDepth(context.modelMatrix));
+
+        m_order.push_back({packet.sortKey, static_cast<uint32_t>(m_packets.size())});
+        m_packets.push_back(std::move(packet));
+    }
+
+    void RenderQueue::addRenderable(std::shared_ptr<I_Renderable> renderable, const DrawContext& context)
+    {
+        DrawPacket packet {
+            .sortKey     = makeSortKey(context.priority, 0u, 0u, 0u, getDepth(context.modelMatrix)),
+            .materialSet = context.materialSet,
+            .material    = context.material,
+            .modelMatrix = context.modelMatrix,
+            .renderable  = std::move(renderable),
+            .pipelines   = context.pipelines,
+        };
+        m_order.push_back({packet.sortKey, static_cast<uint32_t>(m_packets.size())});
+        m_packets.push_back(std::move(packet));
+    }
+
+    void RenderQueue::sort()
+    {
+        utils::radixSort(m_order, m_scratch, [](const SortEntry& e) { return e.key; });
+    }
+
+    void RenderQueue::addInstance(DrawBatch& batch, const DrawPacket& packet)
+    {
+        m_instances.push_back(packet.modelMatrix);
+        if (!batch.bIndirect)
+            return;
+
+        // Consecutive instances of the same mesh share a command
+        if (batch.count > 0u && isSameGeometry(m_lastGeometry, packet.geometry))
+        {
+            ++m_indirectCommands.back().instanceCount;
+        }
+        else
+        {
+            m_indirectCommands.push_back({
+                .indexCount    = packet.geometry.indexCount,
+                .instanceCount = 1u,
+                .firstIndex    = packet.geometry.firstIndex,
+                .vertexOffset  = packet.geometry.vertexOffset,
+                .firstInstance = static_cast<uint32_t>(m_instances.size() - 1u),
+            });
+            m_lastGeometry = packet.geometry;
+            ++batch.commandCount;
+        }
+
+        if (m_bCull)
+        {
+            m_cullInstances.push_back({
+                .modelMatrix = packet.modelMatrix,
+                .sphere      = glm::vec4(packet.bounds.center, packet.bounds.radius),
+                .command     = static_cast<uint32_t>(m_indirectCommands.size() - 1u),
+            });
+        }
+    }
+
+    void RenderQueue::buildBatches(bool bIndirect)
+    {
+        m_batches.clear();
+        m_instances.clear();
+        m_indirectCommands.clear();
+        m_cullInstances.clear();
+        for (uint32_t i = 0; i < m_order.size(); ++i)
+        {
+            const auto& packet = m_packets[m_order[i].index];
+            if (!m_batches.empty() && m_batches.back().bInstanced)
+            {
+                auto& batch       = m_batches.back();
+                const auto& first = m_packets[m_order[batch.begin].index];
+                if (batch.bIndirect ? canDrawIndirect(first, packet) : canDrawInstanced(first, packet))
+                {
+                    addInstance(batch, packet);
+                    ++batch.count;
+                    continue;
+                }
+            }
+
+            DrawBatch batch {.begin = i, .count = 0u};
+            if (!packet.renderable && packet.pipeline && packet.pipeline->isInstanced())
+            {
+                batch.firstInstance = static_cast<uint32_t>(m_instances.size());
+                batch.firstCommand  = static_cast<uint32_t>(m_indirectCommands.size());
+                batch.bInstanced    = true;
+                // Indirect commands always draw indexed geometry from a known range
+                batch.bIndirect =
+                    bIndirect && !packet.indexBuffer.expired() && packet.geometry.indexCount > 0u;
+                addInstance(batch, packet);
+            }
+            ++batch.count;
+            m_batches.push_back(batch);
+        }
+
+        // The culling pass counts each command's visible instances instead
+        if (m_bCull)
+        {
+            for (auto& command : m_indirectCommands)
+                command.instanceCount = 0u;
+        }
+    }
+
+    Buffer::Ptr RenderQueue::uploadFrameBuffer(std::vector<Buffer::Ptr>& buffers,
+                                               const void* data,
+                                               VkDeviceSize size,
+                                               vk::BufferUsageFlags usage)
+    {
+        if (size == 0u)
+            return {};
+
+        // One buffer per frame in flight, so the GPU can still read the previous frames' data
+        buffers.resize(std::max<std::size_t>(m_frameCount, 1u));
+        auto& buffer = buffers[m_frame % buffers.size()];
+        if (!buffer || buffer->getSize() < size)
+        {
+            VkDeviceSize capacity = 4096u;
+            while (capacity < size)
+                capacity *= 2u;
+            buffer = Buffer::create(App::current()->getState().vk.device,
+                                    {
+                                        .size       = capacity,
+                                        .usage      = usage,
+                                        .memoryMode = E_MemoryMode::CpuToGpu,
+                                    });
+        }
+        buffer->fillBuffer(data, size);
+        return buffer;
+    }
+
+    void RenderQueue::prepare(bool bCull)
+    {
+        static_assert(sizeof(InstanceVertex) == sizeof(glm::mat4),
+                      "Instances are uploaded as model matrices");
+
+        const auto state = App::current()->getState();
+        m_frameCount     = state.vk.swapChain.maxFramesInFlight;
+        m_frame          = (m_frame + 1u) % std::max<std::size_t>(m_frameCount, 1u);
+
+        // Only indirect draws take their instance counts from the GPU
+        m_bCull = bCull && state.vk.features.bDrawIndirectFirstInstance;
+        buildBatches(state.vk.features.bDrawIndirectFirstInstance);
+
+        // Both buffers are written by the culling pass
+        m_instanceBuffer = uploadFrameBuffer(m_instanceBuffers,
+                                             m_instances.data(),
+                                             sizeof(glm::mat4) * m_instances.size(),
+                                             E_BufferUsage::Vertex | E_BufferUsage::Storage);
+        m_indirectBuffer = uploadFrameBuffer(m_indirectBuffers,
+                                             m_indirectCommands.data(),
+                                             IndirectCommandSize * m_indirectCommands.size(),
+                                             E_BufferUsage::Indirect | E_BufferUsage::Storage);
+        m_bPrepared = true;
+    }
+
+    void RenderQueue::cull(VkCommandBuffer cb, GpuCuller& culler)
+    {
+        prepare(true);
+
+        const auto instanceCount = static_cast<uint32_t>(m_cullInstances.size());
+        culler.record(cb,
+                      {
+                          .viewProjection = m_viewProjection,
+                          .instances      = uploadFrameBuffer(m_cullBuffers,
+                                                         m_cullInstances.data(),
+                                                         sizeof(GpuCullInstance) * instanceCount,
+                                                         E_BufferUsage::Storage),
+                          .instanceCount  = instanceCount,
+                          .commands       = m_indirectBuffer,
+                          .output         = m_instanceBuffer,
+                      });
+    }
+
+    void RenderQueue::record(std::weak_ptr<CommandBuffers> cmdBufs)
+    {
+        auto cb = cmdBufs.lock();
+        if (!cb)
+            return;
+
+        if (!m_bPrepared)
+            prepare(false);
+        m_bPrepared = false;
+
+        if (m_parallel.threadCount > 0u)
+            recordParallel(*cb);
+        else
+            recordBatches(cb, 0u, m_batches.size());
+    }
+
+    void RenderQueue::setParallelRecording(const ParallelRecordInfo& info)
+    {
+        if (info.threadCount > 0u && !info.renderPass)
+        {
+            throw std::runtime_error(utils::makeErrorMessage(
+                "RENDER", "Parallel recording needs the render pass the draws are recorded in"));
+        }
+        m_parallel = info;
+
+        // The calling thread records a run too, so one fewer worker is needed
+        const std::size_t workerCount = info.threadCount > 1u ? info.threadCount - 1u : 0u;
+        if (workerCount == 0u)
+            m_workers.reset();
+        else if (!m_workers || m_workers->getThreadCount() != workerCount)
+            m_workers = std::make_unique<utils::ThreadPool>(workerCount);
+    }
+
+    void RenderQueue::recordParallel(CommandBuffers& cb)
+    {
+        const auto& state = App::current()->getState();
+
+        // Small queues aren't worth waking more threads for
+        const std::size_t wanted   = (m_batches.size() + MinBatchesPerRun - 1u) / MinBatchesPerRun;
+        const std::size_t runCount = std::clamp<std::size_t>(wanted, 1u, m_parallel.threadCount);
+
+        // Command pools can't be reset while their buffers may still be executing, so each frame in
+        // flight has its own
+        m_recorders.resize(std::max<std::size_t>(m_frameCount, 1u));
+        auto& recorders = m_recorders[m_frame];
+        while (recorders.size() < runCount)
+        {
+            auto pool = CommandPool::create(state.vk.device,
+                                            {
+                                                .queueFamily = state.vk.cmd.gfxFamily,
+                                                .flags       = vk::CommandPoolCreateFlagBits::eTransient,
+                                            });
+            auto cmdBufs = CommandBuffers::create(state.vk.device,
+                                                  {
+                                                      .level   = vk::CommandBufferLevel::eSecondary,
+                                                      .cmdPool = pool->getCmdPool(),
+                                                  });
+            recorders.push_back({.pool = pool, .cmdBufs = cmdBufs});
+        }
+
+        const auto recordRun = [this, &recorders, runCount](std::size_t run) {
+            auto& recorder = recorders[run];
+            recorder.pool->reset();
+            recorder.cmdBufs->start({
+                .index       = 0u,
+                .flags       = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+                .renderPass  = m_parallel.renderPass,
+                .subpass     = m_parallel.subpass,
+                .framebuffer = m_parallel.framebuffer,
+            });
+            recordBatches(recorder.cmdBufs,
+                          m_batches.size() * run / runCount,
+                          m_batches.size() * (run + 1u) / runCount);
+            recorder.cmdBufs->finish();
+        };
+
+        for (std::size_t run = 1u; run < runCount; ++run)
+            m_runs.push_back(m_workers->submit([&recordRun, run]() { recordRun(run); }));
+
+        // The workers use `recordRun`, so wait for every one of them before letting an error through
+        std::exception_ptr error = {};
+        try
+        {
+            recordRun(0u);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        for (auto& run : m_runs)
+        {
+            try
+            {
+                run.get();
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+        m_runs.clear();
+        if (error)
+            std::rethrow_exception(error);
+
+        m_secondaries.clear();
+        for (std::size_t run = 0u; run < runCount; ++run)
+            m_secondaries.push_back(recorders[run].cmdBufs->getCmdBuffer(0u));
+        cb.executeCommands(m_secondaries);
+    }
+
+    void RenderQueue::recordBatches(const CommandBuffers::Ptr& cb, std::size_t begin, std::size_t end) const
+    {
+        const auto instanceBuffer = m_instanceBuffer;
+        const auto indirectBuffer = m_indirectBuffer;
+
+        // Binds and pushes that repeat the previous draw's state are skipped by the command buffers
+        DescriptorSet::Ptr materialSet = {};
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const auto& batch  = m_batches[i];
+            const auto& packet = m_packets[m_order[batch.begin].index];
+
+            if (packet.materialSet != materialSet)
+            {
+                if (materialSet)
+                    cb->clearDescriptorOverride(materialSet->getFrequency());
+                if (packet.materialSet)
+                    cb->overrideDescriptorSet(packet.materialSet);
+                materialSet = packet.materialSet;
+            }
+
+            if (packet.renderable)
+            {
+                // Bindless pipelines share a push constant layout, so one push covers every mesh
+                if (packet.material.has_value())
+                {
+                    for (const auto& p : packet.pipelines)
+                    {
+                        auto pl = p.lock();
+                        if (!pl || !pl->isBindless())
+                            continue;
+                        cb->pushConstants(&*packet.material,
+                                          pl->getPipelineLayout(),
+                                          sizeof(BindlessMaterial),
+                                          {.offset = BindlessMaterialOffset});
+                        break;
+                    }
+                }
+                packet.renderable->render(cb, packet.modelMatrix, packet.pipelines);
+                continue;
+            }
+
+            if (packet.pipeline)
+            {
+                const auto layout = packet.pipeline->getPipelineLayout();
+                cb->bindPipeline(packet.pipeline);
+                if (packet.material.has_value() && packet.pipeline->isBindless())
+                {
+                    cb->pushConstants(&*packet.material,
+                                      layout,
+                                      sizeof(BindlessMaterial),
+                                      {.offset = BindlessMaterialOffset});
+                }
+
+                if (batch.bIndirect)
+                {
+                    cb->drawIndexedIndirect({
+                        .vertexBuffer    = packet.vertexBuffer,
+                        .indexBuffer     = packet.indexBuffer,
+                        .indirectBuffer  = indirectBuffer,
+                        .offset          = IndirectCommandSize * batch.firstCommand,
+                        .drawCount       = batch.commandCount,
+                        .instanceBuffer  = instanceBuffer,
+                        .instanceBinding = InstanceBinding,
+                    });
+                    continue;
+                }
+                if (batch.bInstanced)
+                {
+                    cb->draw({
+                        .vertexBuffer    = packet.vertexBuffer,
+                        .indexBuffer     = packet.indexBuffer,
+                        .instances       = batch.count,
+                        .firstInstance   = batch.firstInstance,
+                        .indices         = packet.geometry.indexCount,
+                        .firstIndex      = packet.geometry.firstIndex,
+                        .vertexOffset    = packet.geometry.vertexOffset,
+                        .instanceBuffer  = instanceBuffer,
+                        .instanceBinding = InstanceBinding,
+                    });
+                    continue;
+                }
+
+                const MatricesPushConstants matrices {.model = packet.modelMatrix};
+                cb->pushConstants(&matrices, layout, sizeof(MatricesPushConstants), {});
+            }
+            cb->draw({
+                .vertexBuffer = packet.vertexBuffer,
+                .indexBuffer  = packet.indexBuffer,
+                .indices      = packet.geometry.indexCount,
+                .firstIndex   = packet.geometry.firstIndex,
+                .vertexOffset = packet.geometry.vertexOffset,
+            });
+        }
+
+        if (materialSet)
+            cb->clearDescriptorOverride(materialSet->getFrequency());
+    }
+} // namespace ivulk
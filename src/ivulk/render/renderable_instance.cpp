@@ -11,7 +11,69 @@ namespace ivulk {
         modelMatrix = modelMatrix * transform.modelMatrix();
         if (auto r = renderable.lock())
         {
+            if (material.has_value())
+                pushMaterial(cmdBufs);
+
+            auto cb = cmdBufs.lock();
+            if (materialSet && cb)
+                cb->overrideDescriptorSet(materialSet);
+
             r->render(cmdBufs, modelMatrix, this->pipelines);
+
+            if (materialSet && cb)
+                cb->clearDescriptorOverride(materialSet->getFrequency());
+        }
+    }
+
+    void RenderableInstance::enqueue(RenderQueue& queue, const DrawContext& context)
+    {
+        auto r = renderable.lock();
+        if (!r)
+            return;
+
+        DrawContext instanceContext = context;
+        instanceContext.modelMatrix = context.modelMatrix * transform.modelMatrix();
+        instanceContext.pipelines   = pipelines;
+        instanceContext.priority    = renderOrder();
+        if (material.has_value())
+            instanceContext.material = material;
+        if (materialSet)
+            instanceContext.materialSet = materialSet;
+
+        const auto sphere   = r->getBoundingSphere().transformed(instanceContext.modelMatrix);
+        lod                 = r->selectLod(queue.getScreenSize(sphere), lod);
+        instanceContext.lod = lod;
+        r->enqueue(queue, instanceContext);
+    }
+
+    BoundingBox RenderableInstance::getBoundingBox() const
+    {
+        auto r = renderable.lock();
+        return r ? r->getBoundingBox().transformed(transform.modelMatrix()) : BoundingBox{};
+    }
+
+    BoundingSphere RenderableInstance::getBoundingSphere() const
+    {
+        auto r = renderable.lock();
+        return r ? r->getBoundingSphere().transformed(transform.modelMatrix()) : BoundingSphere{};
+    }
+
+    void RenderableInstance::pushMaterial(std::weak_ptr<CommandBuffers> cmdBufs)
+    {
+        // Bindless pipelines share a push constant layout, so one push covers every mesh
+        for (const auto& p : pipelines)
+        {
+            auto pl = p.lock();
+            if (!pl || !pl->isBindless())
+                continue;
+            if (auto cb = cmdBufs.lock())
+            {
+                cb->pushConstants(&*material,
+                                  pl->getPipelineLayout(),
+                                  sizeof(BindlessMaterial),
+                                  {.offset = BindlessMaterialOffset});
+            }
+            return;
         }
     }
 } // namespace ivulk
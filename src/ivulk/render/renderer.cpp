@@ -174,7 +174,7 @@ namespace ivulk {
 
     void Renderer::render() { ownerApp->render(m_cmdBufs); }
 
-    void Renderer::beginOffscreenPass(FramebufferInfo fbInfo) 
+    void Renderer::beginOffscreenPass(FramebufferInfo fbInfo, vk::SubpassContents contents)
     {
         m_fb = Framebuffer::create(state.vk.device, fbInfo);
 
@@ -192,7 +192,7 @@ namespace ivulk {
         renderPassInfo.clearValueCount = clearValues.size();
         renderPassInfo.pClearValues = clearValues.data();
 
-        m_cb.beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
+        m_cb.beginRenderPass(renderPassInfo, contents);
     }
     void Renderer::endOffscreenPass() 
     {
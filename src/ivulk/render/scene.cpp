@@ -7,11 +7,159 @@
 
 namespace ivulk {
 
+    std::weak_ptr<RenderableInstance> Scene::addRenderable(const std::shared_ptr<RenderableInstance> rndbl)
+    {
+        if (m_indices.try_emplace(rndbl.get(), m_renderables.size()).second)
+        {
+            m_renderables.push_back(rndbl);
+            m_proxies.push_back(Bvh::Null);
+            m_unbounded.push_back(static_cast<uint32_t>(m_renderables.size() - 1u));
+            updateProxy(m_renderables.size() - 1u);
+        }
+        return rndbl;
+    }
+
+    void Scene::removeRenderable(const std::shared_ptr<RenderableInstance> rndbl)
+    {
+        auto it = m_indices.find(rndbl.get());
+        if (it == m_indices.end())
+            return;
+
+        const auto index = it->second;
+        if (m_proxies[index] != Bvh::Null)
+            m_bvh.remove(m_proxies[index]);
+        else
+            m_unbounded.erase(std::find(m_unbounded.begin(), m_unbounded.end(), index));
+
+        // Order doesn't matter, so fill the gap with the last instance
+        const auto last = m_renderables.size() - 1u;
+        if (index < last)
+        {
+            m_renderables[index]                  = std::move(m_renderables.back());
+            m_proxies[index]                      = m_proxies.back();
+            m_indices[m_renderables[index].get()] = index;
+            if (m_proxies[index] != Bvh::Null)
+                m_bvh.setValue(m_proxies[index], static_cast<uint32_t>(index));
+            else
+                *std::find(m_unbounded.begin(), m_unbounded.end(), last) = static_cast<uint32_t>(index);
+        }
+        m_renderables.pop_back();
+        m_proxies.pop_back();
+        m_indices.erase(it);
+    }
+
+    void Scene::updateRenderable(const std::shared_ptr<RenderableInstance> rndbl)
+    {
+        auto it = m_indices.find(rndbl.get());
+        if (it != m_indices.end())
+            updateProxy(it->second);
+    }
+
+    void Scene::updateProxy(std::size_t index)
+    {
+        const BoundingBox box = m_renderables[index]->getBoundingBox();
+        uint32_t& proxy       = m_proxies[index];
+        if (proxy != Bvh::Null && box.isValid())
+        {
+            m_bvh.update(proxy, box);
+        }
+        else if (proxy != Bvh::Null)
+        {
+            m_bvh.remove(proxy);
+            proxy = Bvh::Null;
+            m_unbounded.push_back(static_cast<uint32_t>(index));
+        }
+        else if (box.isValid())
+        {
+            proxy = m_bvh.insert(box, static_cast<uint32_t>(index));
+            m_unbounded.erase(std::find(m_unbounded.begin(), m_unbounded.end(), index));
+        }
+    }
+
+    std::optional<SceneRayHit> Scene::raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const
+    {
+        std::optional<SceneRayHit> hit;
+        m_bvh.raycast(origin, direction, maxDistance, [&](uint32_t index, float distance) {
+            if (!hit.has_value() || distance < hit->distance)
+                hit = SceneRayHit {.renderable = m_renderables[index], .distance = distance};
+        });
+        return hit;
+    }
+
     void Scene::render(std::weak_ptr<CommandBuffers> cmdBufs, glm::mat4 modelMatrix, const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines)
     {
-        for (const auto& rndbl : m_renderables)
+        // After `cull`, the queue already holds the draws collected with its arguments
+        if (!m_bCulled)
         {
-            rndbl->render(cmdBufs, modelMatrix, pipelines);
+            m_queue.clear();
+            enqueue(m_queue, {.modelMatrix = modelMatrix, .pipelines = pipelines});
+            m_queue.sort();
         }
+        m_bCulled = false;
+        m_queue.record(cmdBufs);
     }
+
+    void Scene::cull(VkCommandBuffer cb,
+                     GpuCuller& culler,
+                     glm::mat4 modelMatrix,
+                     const std::vector<std::weak_ptr<GraphicsPipeline>>& pipelines)
+    {
+        m_queue.clear();
+        enqueue(m_queue, {.modelMatrix = modelMatrix, .pipelines = pipelines});
+        m_queue.sort();
+        m_queue.cull(cb, culler);
+        m_bCulled = true;
+    }
+
+    void Scene::enqueue(RenderQueue& queue, const DrawContext& context)
+    {
+        if (!m_viewProjection.has_value())
+        {
+            for (const auto& rndbl : m_renderables)
+                rndbl->enqueue(queue, context);
+            m_visibleCount = m_renderables.size();
+            return;
+        }
+
+        // Instances are bounded in scene space, so bring the view there
+        const glm::mat4 viewProjection = *m_viewProjection * context.modelMatrix;
+        const Frustum frustum          = Frustum::fromMatrix(viewProjection);
+        if (m_occlusionCuller)
+            m_occlusionCuller->render(viewProjection);
+
+        auto isOccluded = [&](uint32_t index) {
+            return m_occlusionCuller && m_occlusionCuller->isOccluded(m_bvh.getBox(m_proxies[index]));
+        };
+
+        // Instances entirely inside are drawn right away; the ones straddling the frustum get a finer test
+        m_bvh.optimize();
+        m_candidates.clear();
+        m_frustumCuller.clear();
+        m_visibleCount = m_unbounded.size();
+        m_bvh.query(frustum, [&](uint32_t index, bool bInside) {
+            if (bInside)
+            {
+                if (isOccluded(index))
+                    return;
+                m_renderables[index]->enqueue(queue, context);
+                ++m_visibleCount;
+                return;
+            }
+            m_candidates.push_back(index);
+            m_frustumCuller.add(m_bvh.getBox(m_proxies[index]), m_renderables[index]->getBoundingSphere());
+        });
+        m_frustumCuller.cull(frustum);
+
+        for (std::size_t i = 0; i < m_candidates.size(); ++i)
+        {
+            if (!m_frustumCuller.isVisible(i) || isOccluded(m_candidates[i]))
+                continue;
+            m_renderables[m_candidates[i]]->enqueue(queue, context);
+            ++m_visibleCount;
+        }
+
+        for (const auto index : m_unbounded)
+            m_renderables[index]->enqueue(queue, context);
+    }
+
 } // namespace ivulk
@@ -0,0 +1,139 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/utils/file_watcher.hpp>
+
+#include <ivulk/utils/messages.hpp>
+
+#include <stdexcept>
+
+#if defined(__linux__)
+#    include <sys/inotify.h>
+#    include <unistd.h>
+
+#    include <array>
+#    include <cerrno>
+#endif
+
+namespace ivulk::utils {
+
+    namespace fs = boost::filesystem;
+
+#if defined(__linux__)
+
+    constexpr uint32_t FileWatcherEvents = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE;
+
+    FileWatcher::FileWatcher()
+        : m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    {
+        if (m_fd < 0)
+            throw std::runtime_error(makeErrorMessage("FILE", "Failed to initialize inotify"));
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        // Closing the descriptor removes every watch
+        close(m_fd);
+    }
+
+    void FileWatcher::watchTree(const fs::path& dir)
+    {
+        const int wd = inotify_add_watch(m_fd, dir.c_str(), FileWatcherEvents);
+        if (wd < 0)
+            return;
+        m_watches[wd] = dir;
+
+        boost::system::error_code ec;
+        for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (fs::is_directory(it->path()))
+                watchTree(it->path());
+        }
+    }
+
+    std::set<fs::path> FileWatcher::poll()
+    {
+        std::set<fs::path> changed;
+
+        // Events are aligned to their header, so read into a buffer with the same alignment
+        alignas(inotify_event) std::array<char, 4096> buffer;
+        while (true)
+        {
+            const auto len = read(m_fd, buffer.data(), buffer.size());
+            if (len <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < len;)
+            {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+                auto dir = m_watches.find(event->wd);
+                if (dir == m_watches.end() || event->len == 0u)
+                    continue;
+
+                const auto path = dir->second / event->name;
+                if (event->mask & IN_ISDIR)
+                {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                        watchTree(path);
+                }
+                else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+                {
+                    changed.insert(path);
+                }
+            }
+        }
+        return changed;
+    }
+
+#else
+
+    FileWatcher::FileWatcher() { }
+
+    FileWatcher::~FileWatcher() { }
+
+    void FileWatcher::watchTree(const fs::path& dir)
+    {
+        boost::system::error_code ec;
+        for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+        {
+            if (fs::is_regular_file(it->path()))
+                m_times.emplace(it->path(), fs::last_write_time(it->path(), ec));
+        }
+    }
+
+    std::set<fs::path> FileWatcher::poll()
+    {
+        std::set<fs::path> changed;
+        for (const auto& root : m_roots)
+        {
+            boost::system::error_code ec;
+            for (fs::recursive_directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec))
+            {
+                if (!fs::is_regular_file(it->path()))
+                    continue;
+                const auto time = fs::last_write_time(it->path(), ec);
+                auto [entry, bNew] = m_times.emplace(it->path(), time);
+                if (bNew || entry->second != time)
+                {
+                    entry->second = time;
+                    changed.insert(it->path());
+                }
+            }
+        }
+        return changed;
+    }
+
+#endif
+
+    bool FileWatcher::addDirectory(const fs::path& dir)
+    {
+        const auto root = fs::absolute(dir).lexically_normal();
+        if (!fs::is_directory(root))
+            return false;
+        if (m_roots.insert(root).second)
+            watchTree(root);
+        return true;
+    }
+} // namespace ivulk::utils
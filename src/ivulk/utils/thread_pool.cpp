@@ -0,0 +1,62 @@
+#define IVULK_SOURCE
+#include <ivulk/config.hpp>
+
+#include <ivulk/utils/thread_pool.hpp>
+
+#include <algorithm>
+
+namespace ivulk::utils {
+
+    ThreadPool::ThreadPool(std::size_t threadCount)
+    {
+        if (threadCount == 0u)
+        {
+            const std::size_t hwThreads = std::thread::hardware_concurrency();
+            threadCount                 = std::max<std::size_t>(hwThreads, 2u) - 1u;
+        }
+        m_workers.reserve(threadCount);
+        for (std::size_t i = 0; i < threadCount; ++i)
+            m_workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_bStopping = true;
+        }
+        m_wake.notify_all();
+        for (auto& worker : m_workers)
+            worker.join();
+    }
+
+    void ThreadPool::waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_tasks.empty() && m_activeTasks == 0u; });
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_bStopping || !m_tasks.empty(); });
+                if (m_tasks.empty())
+                    return;
+                task = std::move(m_tasks.front());
+                m_tasks.pop();
+                ++m_activeTasks;
+            }
+            task();
+            task = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_activeTasks;
+            }
+            m_idle.notify_all();
+        }
+    }
+} // namespace ivulk::utils
@@ -0,0 +1,134 @@
+#include <ivulk/render/occlusion_culler.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace ivulk;
+
+int failures = 0;
+
+void check(bool bPassed, const std::string& what)
+{
+    if (!bPassed)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+void checkNear(float value, float expected, const std::string& what)
+{
+    check(std::abs(value - expected) < 1e-4f,
+          what + " (got " + std::to_string(value) + ", expected " + std::to_string(expected) + ")");
+}
+
+// A quad spanning [lo, hi] on X and Y in clip space, at depth `z0 + slope * x`
+OccluderMesh::Ptr makeQuad(float lo, float hi, float z0, float slope = 0.0f)
+{
+    auto mesh       = std::make_shared<OccluderMesh>();
+    mesh->positions = {
+        {lo, lo, z0 + slope * lo},
+        {hi, lo, z0 + slope * hi},
+        {hi, hi, z0 + slope * hi},
+        {lo, hi, z0 + slope * lo},
+    };
+    mesh->indices = {0, 1, 2, 0, 2, 3};
+    return mesh;
+}
+
+float depthAt(const OcclusionCuller& culler, uint32_t x, uint32_t y)
+{
+    return culler.getDepth()[y * culler.getWidth() + x];
+}
+
+// With an identity view-projection, a 16x16 buffer maps clip space [-1, 1] to pixels [0, 16)
+void testFlatDepth()
+{
+    auto culler = OcclusionCuller::create(16u, 16u);
+    culler->addOccluder(makeQuad(-0.5f, 0.5f, 0.5f));
+    culler->render(glm::mat4(1));
+
+    checkNear(depthAt(*culler, 8u, 8u), 0.5f, "flat quad depth at center");
+    checkNear(depthAt(*culler, 4u, 4u), 0.5f, "flat quad depth at corner");
+    checkNear(depthAt(*culler, 11u, 11u), 0.5f, "flat quad depth at far corner");
+    checkNear(depthAt(*culler, 3u, 8u), 1.0f, "depth left of the quad");
+    checkNear(depthAt(*culler, 12u, 8u), 1.0f, "depth right of the quad");
+}
+
+void testSlopedDepth()
+{
+    // Depth is 0.25 + x / 32 in pixels, so each pixel holds the depth at its right edge
+    auto culler = OcclusionCuller::create(16u, 16u);
+    culler->addOccluder(makeQuad(-0.5f, 0.5f, 0.5f, 0.25f));
+    culler->render(glm::mat4(1));
+
+    for (uint32_t x = 4u; x < 12u; ++x)
+    {
+        checkNear(depthAt(*culler, x, 8u),
+                  0.25f + static_cast<float>(x + 1u) / 32.0f,
+                  "sloped quad depth at pixel " + std::to_string(x));
+    }
+}
+
+void testPartialCoverage()
+{
+    // Edges at pixels 4.4 and 11.6 cover pixels 4 and 11 partly, and 5 to 10 fully
+    auto culler = OcclusionCuller::create(16u, 16u);
+    culler->addOccluder(makeQuad(-0.45f, 0.45f, 0.5f));
+    culler->render(glm::mat4(1));
+
+    checkNear(depthAt(*culler, 4u, 8u), 1.0f, "partly covered pixel on the left");
+    checkNear(depthAt(*culler, 11u, 8u), 1.0f, "partly covered pixel on the right");
+    checkNear(depthAt(*culler, 5u, 8u), 0.5f, "fully covered pixel on the left");
+    checkNear(depthAt(*culler, 10u, 8u), 0.5f, "fully covered pixel on the right");
+}
+
+void testBoxOccluder()
+{
+    // Seen straight on, the box's sides are edge on and only its front and back cover pixels
+    auto culler = OcclusionCuller::create(16u, 16u);
+    culler->addOccluder(OccluderMesh::fromBox({.min = {-0.5f, -0.5f, 0.4f}, .max = {0.5f, 0.5f, 0.6f}}));
+    culler->render(glm::mat4(1));
+
+    checkNear(depthAt(*culler, 8u, 8u), 0.4f, "box depth at center");
+    checkNear(depthAt(*culler, 4u, 11u), 0.4f, "box depth at corner");
+    checkNear(depthAt(*culler, 3u, 8u), 1.0f, "depth beside the box");
+}
+
+void testIsOccluded()
+{
+    auto culler = OcclusionCuller::create(16u, 16u);
+    culler->addOccluder(makeQuad(-0.5f, 0.5f, 0.5f));
+    culler->render(glm::mat4(1));
+
+    check(culler->isOccluded({.min = {-0.3f, -0.3f, 0.7f}, .max = {0.3f, 0.3f, 0.8f}}),
+          "box behind the occluder is hidden");
+    check(!culler->isOccluded({.min = {-0.3f, -0.3f, 0.1f}, .max = {0.3f, 0.3f, 0.2f}}),
+          "box in front of the occluder is visible");
+    check(!culler->isOccluded({.min = {-0.3f, -0.3f, 0.4f}, .max = {0.3f, 0.3f, 0.8f}}),
+          "box crossing the occluder is visible");
+    check(!culler->isOccluded({.min = {-0.9f, -0.9f, 0.7f}, .max = {0.9f, 0.9f, 0.8f}}),
+          "box wider than the occluder is visible");
+    check(!culler->isOccluded({.min = {0.6f, 0.6f, 0.7f}, .max = {0.9f, 0.9f, 0.8f}}),
+          "box beside the occluder is visible");
+}
+
+int main()
+{
+    testFlatDepth();
+    testSlopedDepth();
+    testPartialCoverage();
+    testBoxOccluder();
+    testIsOccluded();
+
+    if (failures > 0)
+    {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All occlusion culler checks passed" << std::endl;
+    return EXIT_SUCCESS;
+}